@@ -0,0 +1,204 @@
+/*
+ * ActuatorLoop.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "ActuatorLoop.h"
+
+#include <algorithm>
+#include <cmath>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+#include <samples/slog.hpp>
+
+static uint64_t monotonicNowNs()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void JitterStats::add(double latenessUs)
+{
+	if (samples == 0)
+	{
+		minUs = latenessUs;
+		maxUs = latenessUs;
+	}
+	minUs = std::min(minUs, latenessUs);
+	maxUs = std::max(maxUs, latenessUs);
+
+	samples++;
+	double delta = latenessUs - meanUs;
+	meanUs += delta / samples;
+	m2 += delta * (latenessUs - meanUs);
+}
+
+double JitterStats::stdDevUs() const
+{
+	return samples > 1 ? std::sqrt(m2 / (samples - 1)) : 0;
+}
+
+ActuatorLoop::ActuatorLoop(uint32_t rateHz, uint32_t minGapUs, int priority):
+	periodNs(1000000000ULL / std::max<uint32_t>(rateHz, 1)),
+	minGapNs((uint64_t)minGapUs * 1000),
+	priority(priority),
+	timerFd(timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC)),
+	eventFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+	running(true)
+{
+	if (timerFd < 0 || eventFd < 0)
+	{
+		slog::err << "ActuatorLoop: cannot create timer/event fd: " << strerror(errno) << slog::endl;
+	}
+}
+
+ActuatorLoop::~ActuatorLoop()
+{
+	if (timerFd >= 0)
+		close(timerFd);
+	if (eventFd >= 0)
+		close(eventFd);
+}
+
+void ActuatorLoop::armTimer(uint64_t deadlineNs)
+{
+	itimerspec spec = {};
+	spec.it_value.tv_sec = deadlineNs / 1000000000ULL;
+	spec.it_value.tv_nsec = deadlineNs % 1000000000ULL;
+	timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+void ActuatorLoop::setRealtimePriority()
+{
+	if (priority <= 0)
+		return;
+
+	sched_param param = {};
+	param.sched_priority = std::min(priority, sched_get_priority_max(SCHED_FIFO));
+	int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+	if (result != 0)
+	{
+		slog::warn << "ActuatorLoop: SCHED_FIFO " << param.sched_priority
+		           << " not applied (" << strerror(result) << "), running with default policy" << slog::endl;
+	}
+}
+
+void ActuatorLoop::run(const std::function<bool()>& send)
+{
+	if (timerFd < 0 || eventFd < 0)
+		return;
+
+	setRealtimePriority();
+
+	uint64_t nextTick = monotonicNowNs() + periodNs;
+	uint64_t lastSend = 0;
+	bool pending = false;
+	// A tick that fell inside the minimum gap, it still goes out once the gap ends
+	bool tickDue = false;
+
+	pollfd fds[2];
+	fds[0].fd = timerFd;
+	fds[0].events = POLLIN;
+	fds[1].fd = eventFd;
+	fds[1].events = POLLIN;
+
+	while (running)
+	{
+		// A published command or a tick that arrived inside the minimum gap is sent as soon as the gap ends
+		uint64_t deadline = nextTick;
+		if (pending || tickDue)
+			deadline = std::min(deadline, lastSend + minGapNs);
+		armTimer(deadline);
+
+		if (poll(fds, 2, -1) < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			slog::err << "ActuatorLoop: poll failed: " << strerror(errno) << slog::endl;
+			break;
+		}
+
+		uint64_t now = monotonicNowNs();
+		uint64_t counter;
+		if (fds[0].revents & POLLIN)
+		{
+			ssize_t unusedRead = read(timerFd, &counter, sizeof(counter));
+			(void)unusedRead;
+		}
+		if (fds[1].revents & POLLIN)
+		{
+			ssize_t unusedRead = read(eventFd, &counter, sizeof(counter));
+			(void)unusedRead;
+			pending = true;
+		}
+
+		if (now >= nextTick)
+		{
+			tickDue = true;
+			std::lock_guard<std::mutex> lock(statsMtx);
+			stats.add((now - nextTick) / 1000.0);
+			nextTick += periodNs;
+			if (nextTick <= now)
+			{
+				// Missed whole periods, realign instead of sending a burst
+				uint64_t missed = (now - nextTick) / periodNs + 1;
+				stats.overruns += missed;
+				nextTick += missed * periodNs;
+			}
+		}
+
+		if ((tickDue || pending) && now - lastSend >= minGapNs)
+		{
+			bool sent = send();
+			lastSend = now;
+
+			std::lock_guard<std::mutex> lock(statsMtx);
+			if (!sent)
+				stats.sendErrors++;
+			if (tickDue)
+				stats.periodicSends++;
+			else
+				stats.publishSends++;
+			tickDue = false;
+			pending = false;
+		}
+	}
+}
+
+void ActuatorLoop::notify()
+{
+	uint64_t one = 1;
+	ssize_t unusedWrite = write(eventFd, &one, sizeof(one));
+	(void)unusedWrite;
+}
+
+void ActuatorLoop::stop()
+{
+	running = false;
+	notify();
+}
+
+JitterStats ActuatorLoop::getJitterStats()
+{
+	std::lock_guard<std::mutex> lock(statsMtx);
+	return stats;
+}
+
+void ActuatorLoop::logJitterStats()
+{
+	JitterStats snapshot = getJitterStats();
+	slog::info << "Actuator jitter: " << snapshot.samples << " ticks, min " << snapshot.minUs
+	           << " us, mean " << snapshot.meanUs << " us, max " << snapshot.maxUs
+	           << " us, stddev " << snapshot.stdDevUs() << " us, overruns " << snapshot.overruns
+	           << ", sends " << snapshot.periodicSends << " periodic / " << snapshot.publishSends
+	           << " on publish, errors " << snapshot.sendErrors << slog::endl;
+}
@@ -0,0 +1,67 @@
+/*
+ * ActuatorLoop.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+/*
+ * Lateness of the periodic wake ups against their absolute deadlines
+ */
+struct JitterStats
+{
+	uint64_t samples = 0;
+	uint64_t overruns = 0;       // whole periods missed
+	uint64_t periodicSends = 0;
+	uint64_t publishSends = 0;   // sent early because a new command was published
+	uint64_t sendErrors = 0;
+	double minUs = 0;
+	double maxUs = 0;
+	double meanUs = 0;
+	double m2 = 0;               // running sum of squared deviations (Welford)
+
+	void add(double latenessUs);
+	double stdDevUs() const;
+};
+
+/*
+ * Sends the actuator command at a fixed rate on absolute deadlines of CLOCK_MONOTONIC,
+ * sleeping in poll() on a timerfd between them. notify() wakes the loop through an eventfd
+ * so a freshly published command goes out immediately, but never closer than minGapUs to
+ * the previous message. A tick falling inside that gap is sent when the gap ends, not dropped.
+ */
+class ActuatorLoop
+{
+private:
+	uint64_t periodNs;
+	uint64_t minGapNs;
+	int priority;
+	int timerFd;
+	int eventFd;
+	std::atomic<bool> running;
+	std::mutex statsMtx;
+	JitterStats stats;
+
+	void armTimer(uint64_t deadlineNs);
+	void setRealtimePriority();
+public:
+	ActuatorLoop(uint32_t rateHz, uint32_t minGapUs, int priority);
+	virtual ~ActuatorLoop();
+
+	/*
+	 * Runs on the calling thread until stop(). send returns false when the write failed.
+	 */
+	void run(const std::function<bool()>& send);
+	void notify();
+	void stop();
+
+	JitterStats getJitterStats();
+	void logJitterStats();
+};
@@ -8,31 +8,34 @@
 
 #include <atomic>
 #include <stdint.h>
+#include <string>
+#include "ControlState.h"
+#include "StageScheduler.h"
+#include "WorldModel.h"
+#include "VehicleProtocol.h"
 
-#define setBit(a,b) ((a) |= (1ULL<<(b)))
-#define clearBit(a,b) ((a) &= ~(1ULL<<(b)))
-
-#define ADDRESS 			(uint8_t) 0x04
-#define SPEED_VALUE_FLAG 	(uint8_t) 0xA1
-#define DIR_VALUE_FLAG 		(uint8_t) 0xB2
-
-std::string deviceName = "MYRIAD";
-
-static const char *devName = "/dev/i2c-1";
-int16_t I2CFileStream;
-bool lightsOn = false;
-bool stopOn = false;
+// Commands older than this are not trusted, the actuator stops the car
+#define CONTROL_DEADLINE_MS	250
+// While replaying the capture thread waits this long for a stage to finish a frame
+#define REPLAY_STAGE_TIMEOUT_MS	30000
 
 void getFrame();
 void showFrame();
 void detectLanes();
 void detectTraffic();
 void detectCars();
+void planBehaviour();
 void arduinoI2C();
 void exitRoutine (void);
 
-std::atomic<int16_t> speed;
-std::atomic<int8_t> steer;
+// Published by the planner thread, read by the actuator thread
+ControlChannel controlChannel;
+
+// Published by the perception threads, read by the planner thread
+WorldModel worldModel;
+
+// Decides which perception stages run on a frame, used with -scheduler_enable
+StageScheduler stageScheduler;
 
 template <typename T>
 void unused(T &&)
@@ -0,0 +1,300 @@
+/*
+ * AutoPilotFlags.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <gflags/gflags.h>
+#include <iostream>
+#include <string>
+
+/// @brief message for help argument
+static const char help_message[] = "Print a usage message.";
+
+/// @brief message for config argument
+static const char config_message[] = "Optional. Path to an INI file with any of the options below. "
+"\"[section] key = value\" sets the option section_key, options given on the command line win.";
+
+/// @brief message for input argument
+static const char input_message[] = "Optional. Path to a video file (specify \"cam\" to work with camera).";
+
+/// @brief messages for image directory input
+static const char input_decode_threads_message[] = "Optional. Threads decoding the images of a directory ahead of the pipeline (0 - decode on the capture thread).";
+static const char input_prefetch_message[] = "Optional. Images of a directory decoded ahead of the pipeline.";
+static const char input_min_size_message[] = "Optional. Decode images at 1/2, 1/4 or 1/8 of their size while they stay at least this large (0 - full size).";
+
+/// @brief messages for replay
+static const char replay_message[] = "Optional. Replay the frames of this drive log instead of -i, the stages run in lock step on every frame.";
+static const char replay_realtime_message[] = "Optional. Replay with the recorded time between frames instead of as fast as possible.";
+
+/// @brief messages for the pipeline stages
+static const char show_enable_message[] = "Optional. Show the captured frames.";
+static const char lanes_enable_message[] = "Optional. Run the lane detection stage.";
+static const char cars_enable_message[] = "Optional. Run the pedestrian and vehicle detection stage.";
+static const char traffic_enable_message[] = "Optional. Run the traffic sign detection stage.";
+static const char planner_enable_message[] = "Optional. Run the behaviour planner stage.";
+
+/// @brief messages for the detection models
+static const char model_message[] = "Optional. Path to an .xml file with a trained model.";
+static const char device_message[] = "Optional. Target device to infer on (CPU, GPU, FPGA, HDDL or MYRIAD).";
+static const char threshold_message[] = "Optional. Probability threshold for detections.";
+static const char nthreads_message[] = "Optional. Number of threads the CPU plugin uses for this model (0 - plugin default).";
+static const char regions_message[] = "Optional. Frame regions inferred as one batch: \"x,y,width,height\" relative to the frame, "
+"\"full\" or \"grid:<columns>x<rows>[:<overlap>]\", separated by spaces (default - the whole frame).";
+static const char nms_iou_message[] = "Optional. Drop detections of the same class overlapping a more confident one by more than this IoU (0 - off).";
+
+/// @brief messages for the lane detector
+static const char lanes_resize_message[] = "Optional. Scale applied to the frame before lane detection.";
+static const char lanes_line_threshold_message[] = "Optional. RANSAC inlier distance in pixels.";
+static const char lanes_max_iterations_message[] = "Optional. RANSAC iterations per lane.";
+static const char lanes_hist_height_message[] = "Optional. Height of the histogram plot in pixels.";
+static const char lanes_slices_message[] = "Optional. Horizontal slices searched for lane points.";
+static const char lanes_quad_ratio_message[] = "Optional. The bird's eye view starts at height / ratio.";
+static const char lanes_seed_message[] = "Optional. RANSAC seed (0 - random, 1 while replaying).";
+
+/// @brief messages for the planner
+static const char planner_cruise_speed_message[] = "Optional. Speed when nothing is in the way.";
+static const char planner_slow_speed_message[] = "Optional. Speed behind vehicles, at give way signs or without lanes.";
+static const char planner_on_frames_message[] = "Optional. Frames a condition must hold to be acted upon.";
+static const char planner_off_frames_message[] = "Optional. Frames a condition must be absent to be cleared.";
+static const char planner_stop_hold_frames_message[] = "Optional. Frames to stand still at a stop sign.";
+
+/// @brief messages for the tracker
+static const char tracker_enable_message[] = "Optional. Track detected objects and run the detectors only as often as the motion in the scene needs.";
+static const char tracker_max_interval_message[] = "Optional. Most frames between two runs of a detector.";
+static const char tracker_min_iou_message[] = "Optional. Overlap a detection needs with a predicted track to continue it.";
+static const char tracker_min_hits_message[] = "Optional. Detections before a track is reported.";
+static const char tracker_max_missed_message[] = "Optional. Detector runs a track survives without a matching detection.";
+
+/// @brief messages for the motion gate
+static const char motion_gate_enable_message[] = "Optional. Skip inference while the scene does not change and reuse the last detections.";
+static const char motion_gate_threshold_message[] = "Optional. Mean gray level change of the frame thumbnail that counts as motion.";
+static const char motion_gate_refresh_frames_message[] = "Optional. Captured frames after which a static scene is inferred anyway.";
+
+/// @brief messages for the stage scheduler
+static const char scheduler_enable_message[] = "Optional. Decimate the traffic sign, then the pedestrian and vehicle stage while a more important stage runs late.";
+static const char scheduler_deadline_message[] = "Optional. Milliseconds one run of the stage may take before less important stages are decimated.";
+static const char scheduler_max_decimation_message[] = "Optional. A decimated detector still runs on at least 1 in this many frames.";
+
+/// @brief message for the thread attributes
+static const char threads_message[] = "Optional. Attributes of the stage thread: \"cpus:<n>[,<n>...]\", \"fifo:<priority>\", \"nice:<level>\" "
+"and \"stack:<bytes>[k|m]\", separated by spaces (default - inherited from the process).";
+
+/// @brief messages for the drive log
+static const char log_path_message[] = "Optional. Record frames, detections, lanes and commands to this drive log (default - no log).";
+static const char log_frames_message[] = "Optional. How frames are recorded: \"jpeg\", \"ref\" (index into -i, for video files) or \"none\".";
+static const char log_jpeg_quality_message[] = "Optional. JPEG quality of the recorded frames.";
+
+/// @brief messages for the annotated video
+static const char video_path_message[] = "Optional. Record the frames with lanes, detections and commands drawn over them, *.y4m for raw YUV (default - no video).";
+static const char video_fps_message[] = "Optional. Frame rate written to the video.";
+static const char video_codec_message[] = "Optional. Four character code of the cv::VideoWriter codec, ignored for *.y4m.";
+static const char video_queue_message[] = "Optional. Frames waiting for the encoder, more are dropped.";
+
+/// @brief messages for the per-layer performance counters
+static const char perf_counts_enable_message[] = "Optional. Collect per-layer performance counters of the detection models and write a report per model.";
+static const char perf_counts_inferences_message[] = "Optional. Inferences aggregated before the report is written.";
+static const char perf_counts_prefix_message[] = "Optional. Report path prefix, <prefix>_<stage>_<device>.csv or .json.";
+static const char perf_counts_format_message[] = "Optional. Report format: \"csv\" or \"json\".";
+
+/// @brief message for the metrics export
+static const char metrics_listen_message[] = "Optional. Serve Prometheus metrics over HTTP on \"tcp:<port>\" (127.0.0.1 only) or \"unix:<path>\" (default - not served).";
+
+/// @brief message for the vehicle link
+static const char vehicle_link_message[] = "Optional. Where commands go: \"i2c:<device>\", \"sim\" or \"record:<file>\". Exits if it cannot be opened.";
+
+/// @brief messages for the actuator loop
+static const char actuator_rate_hz_message[] = "Optional. Commands sent per second when nothing new is published.";
+static const char actuator_min_gap_us_message[] = "Optional. Shortest time between two commands, a publish inside it waits.";
+static const char actuator_priority_message[] = "Optional. SCHED_FIFO priority of the actuator thread, 0 keeps the default policy.";
+
+DEFINE_bool(h, false, help_message);
+DEFINE_string(config, "", config_message);
+DEFINE_string(i, "cam", input_message);
+DEFINE_uint32(input_decode_threads, 2, input_decode_threads_message);
+DEFINE_uint32(input_prefetch, 8, input_prefetch_message);
+DEFINE_uint32(input_min_width, 0, input_min_size_message);
+DEFINE_uint32(input_min_height, 0, input_min_size_message);
+DEFINE_string(replay, "", replay_message);
+DEFINE_bool(replay_realtime, false, replay_realtime_message);
+
+DEFINE_bool(show_enable, true, show_enable_message);
+DEFINE_bool(lanes_enable, false, lanes_enable_message);
+DEFINE_bool(cars_enable, true, cars_enable_message);
+DEFINE_bool(traffic_enable, true, traffic_enable_message);
+DEFINE_bool(planner_enable, true, planner_enable_message);
+
+DEFINE_string(cars_model, "../../../models/pedestrian_and_vehicles/origin/mobilenet_iter_73000.xml", model_message);
+DEFINE_string(cars_device, "MYRIAD", device_message);
+DEFINE_double(cars_threshold, 0.7, threshold_message);
+DEFINE_uint32(cars_nthreads, 0, nthreads_message);
+DEFINE_double(cars_nms_iou, 0, nms_iou_message);
+DEFINE_string(cars_regions, "", regions_message);
+
+DEFINE_string(traffic_model, "../../../models/traffic_signs/FP16/mobilenet_iter_17000.xml", model_message);
+DEFINE_string(traffic_device, "MYRIAD", device_message);
+DEFINE_double(traffic_threshold, 0.8, threshold_message);
+DEFINE_uint32(traffic_nthreads, 0, nthreads_message);
+DEFINE_double(traffic_nms_iou, 0, nms_iou_message);
+DEFINE_string(traffic_regions, "", regions_message);
+
+DEFINE_double(lanes_resize, 1.0, lanes_resize_message);
+DEFINE_uint32(lanes_line_threshold, 50, lanes_line_threshold_message);
+DEFINE_uint32(lanes_max_iterations, 10, lanes_max_iterations_message);
+DEFINE_uint32(lanes_hist_height, 100, lanes_hist_height_message);
+DEFINE_uint32(lanes_slices, 10, lanes_slices_message);
+DEFINE_double(lanes_quad_ratio, 1.4, lanes_quad_ratio_message);
+DEFINE_uint32(lanes_seed, 0, lanes_seed_message);
+
+DEFINE_int32(planner_cruise_speed, 60, planner_cruise_speed_message);
+DEFINE_int32(planner_slow_speed, 20, planner_slow_speed_message);
+DEFINE_int32(planner_on_frames, 3, planner_on_frames_message);
+DEFINE_int32(planner_off_frames, 5, planner_off_frames_message);
+DEFINE_int32(planner_stop_hold_frames, 30, planner_stop_hold_frames_message);
+
+DEFINE_bool(tracker_enable, false, tracker_enable_message);
+DEFINE_int32(tracker_max_interval, 4, tracker_max_interval_message);
+DEFINE_double(tracker_min_iou, 0.3, tracker_min_iou_message);
+DEFINE_int32(tracker_min_hits, 1, tracker_min_hits_message);
+DEFINE_int32(tracker_max_missed, 3, tracker_max_missed_message);
+
+DEFINE_bool(motion_gate_enable, false, motion_gate_enable_message);
+DEFINE_double(motion_gate_threshold, 2.0, motion_gate_threshold_message);
+DEFINE_int32(motion_gate_refresh_frames, 30, motion_gate_refresh_frames_message);
+
+DEFINE_bool(scheduler_enable, false, scheduler_enable_message);
+DEFINE_double(scheduler_lanes_deadline_ms, 33, scheduler_deadline_message);
+DEFINE_double(scheduler_cars_deadline_ms, 66, scheduler_deadline_message);
+DEFINE_double(scheduler_traffic_deadline_ms, 100, scheduler_deadline_message);
+DEFINE_int32(scheduler_max_decimation, 8, scheduler_max_decimation_message);
+
+DEFINE_string(threads_capture, "", threads_message);
+DEFINE_string(threads_show, "", threads_message);
+DEFINE_string(threads_lanes, "", threads_message);
+DEFINE_string(threads_cars, "", threads_message);
+DEFINE_string(threads_traffic, "", threads_message);
+DEFINE_string(threads_planner, "", threads_message);
+DEFINE_string(threads_actuator, "", threads_message);
+
+DEFINE_string(log_path, "", log_path_message);
+DEFINE_string(log_frames, "jpeg", log_frames_message);
+DEFINE_int32(log_jpeg_quality, 80, log_jpeg_quality_message);
+
+DEFINE_string(video_path, "", video_path_message);
+DEFINE_double(video_fps, 30, video_fps_message);
+DEFINE_string(video_codec, "MJPG", video_codec_message);
+DEFINE_uint32(video_queue, 8, video_queue_message);
+
+DEFINE_bool(perf_counts_enable, false, perf_counts_enable_message);
+DEFINE_uint32(perf_counts_inferences, 200, perf_counts_inferences_message);
+DEFINE_string(perf_counts_prefix, "perf_counts", perf_counts_prefix_message);
+DEFINE_string(perf_counts_format, "csv", perf_counts_format_message);
+
+DEFINE_string(metrics_listen, "", metrics_listen_message);
+
+DEFINE_string(vehicle_link, "i2c:/dev/i2c-1", vehicle_link_message);
+DEFINE_uint32(actuator_rate_hz, 20, actuator_rate_hz_message);
+DEFINE_uint32(actuator_min_gap_us, 5000, actuator_min_gap_us_message);
+DEFINE_int32(actuator_priority, 80, actuator_priority_message);
+
+/**
+* @brief This function show a help message
+*/
+static void showUsage() {
+    std::cout << std::endl;
+    std::cout << "autopilot [OPTION]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << std::endl;
+    std::cout << "    -h                             " << help_message << std::endl;
+    std::cout << "    -config \"<path>\"               " << config_message << std::endl;
+    std::cout << "    -i \"<path>\"                    " << input_message << std::endl;
+    std::cout << "    -input_decode_threads          " << input_decode_threads_message << std::endl;
+    std::cout << "    -input_prefetch                " << input_prefetch_message << std::endl;
+    std::cout << "    -input_min_width               " << input_min_size_message << std::endl;
+    std::cout << "    -input_min_height              " << input_min_size_message << std::endl;
+    std::cout << "    -replay \"<path>\"               " << replay_message << std::endl;
+    std::cout << "    -replay_realtime               " << replay_realtime_message << std::endl;
+    std::cout << std::endl;
+    std::cout << "  Stages:" << std::endl;
+    std::cout << "    -show_enable                   " << show_enable_message << std::endl;
+    std::cout << "    -lanes_enable                  " << lanes_enable_message << std::endl;
+    std::cout << "    -cars_enable                   " << cars_enable_message << std::endl;
+    std::cout << "    -traffic_enable                " << traffic_enable_message << std::endl;
+    std::cout << "    -planner_enable                " << planner_enable_message << std::endl;
+    std::cout << std::endl;
+    std::cout << "  Detection (cars_ and traffic_ prefixed):" << std::endl;
+    std::cout << "    -cars_model \"<path>\"           " << model_message << std::endl;
+    std::cout << "    -cars_device \"<device>\"        " << device_message << std::endl;
+    std::cout << "    -cars_threshold                " << threshold_message << std::endl;
+    std::cout << "    -cars_nthreads                 " << nthreads_message << std::endl;
+    std::cout << "    -cars_nms_iou                  " << nms_iou_message << std::endl;
+    std::cout << "    -cars_regions \"<regions>\"      " << regions_message << std::endl;
+    std::cout << std::endl;
+    std::cout << "  Lanes:" << std::endl;
+    std::cout << "    -lanes_resize                  " << lanes_resize_message << std::endl;
+    std::cout << "    -lanes_line_threshold          " << lanes_line_threshold_message << std::endl;
+    std::cout << "    -lanes_max_iterations          " << lanes_max_iterations_message << std::endl;
+    std::cout << "    -lanes_hist_height             " << lanes_hist_height_message << std::endl;
+    std::cout << "    -lanes_slices                  " << lanes_slices_message << std::endl;
+    std::cout << "    -lanes_quad_ratio              " << lanes_quad_ratio_message << std::endl;
+    std::cout << "    -lanes_seed                    " << lanes_seed_message << std::endl;
+    std::cout << std::endl;
+    std::cout << "  Planner:" << std::endl;
+    std::cout << "    -planner_cruise_speed          " << planner_cruise_speed_message << std::endl;
+    std::cout << "    -planner_slow_speed            " << planner_slow_speed_message << std::endl;
+    std::cout << "    -planner_on_frames             " << planner_on_frames_message << std::endl;
+    std::cout << "    -planner_off_frames            " << planner_off_frames_message << std::endl;
+    std::cout << "    -planner_stop_hold_frames      " << planner_stop_hold_frames_message << std::endl;
+    std::cout << std::endl;
+    std::cout << "  Tracker:" << std::endl;
+    std::cout << "    -tracker_enable                " << tracker_enable_message << std::endl;
+    std::cout << "    -tracker_max_interval          " << tracker_max_interval_message << std::endl;
+    std::cout << "    -tracker_min_iou               " << tracker_min_iou_message << std::endl;
+    std::cout << "    -tracker_min_hits              " << tracker_min_hits_message << std::endl;
+    std::cout << "    -tracker_max_missed            " << tracker_max_missed_message << std::endl;
+    std::cout << std::endl;
+    std::cout << "  Motion gate:" << std::endl;
+    std::cout << "    -motion_gate_enable            " << motion_gate_enable_message << std::endl;
+    std::cout << "    -motion_gate_threshold         " << motion_gate_threshold_message << std::endl;
+    std::cout << "    -motion_gate_refresh_frames    " << motion_gate_refresh_frames_message << std::endl;
+    std::cout << std::endl;
+    std::cout << "  Scheduler:" << std::endl;
+    std::cout << "    -scheduler_enable              " << scheduler_enable_message << std::endl;
+    std::cout << "    -scheduler_lanes_deadline_ms   " << scheduler_deadline_message << std::endl;
+    std::cout << "    -scheduler_cars_deadline_ms    " << scheduler_deadline_message << std::endl;
+    std::cout << "    -scheduler_traffic_deadline_ms " << scheduler_deadline_message << std::endl;
+    std::cout << "    -scheduler_max_decimation      " << scheduler_max_decimation_message << std::endl;
+    std::cout << std::endl;
+    std::cout << "  Threads:" << std::endl;
+    std::cout << "    -threads_<stage> \"<spec>\"      " << threads_message << std::endl;
+    std::cout << "                                   Stages: capture, show, lanes, cars, traffic, planner, actuator." << std::endl;
+    std::cout << std::endl;
+    std::cout << "  Drive log:" << std::endl;
+    std::cout << "    -log_path \"<path>\"             " << log_path_message << std::endl;
+    std::cout << "    -log_frames \"<mode>\"           " << log_frames_message << std::endl;
+    std::cout << "    -log_jpeg_quality              " << log_jpeg_quality_message << std::endl;
+    std::cout << std::endl;
+    std::cout << "  Video:" << std::endl;
+    std::cout << "    -video_path \"<path>\"           " << video_path_message << std::endl;
+    std::cout << "    -video_fps                     " << video_fps_message << std::endl;
+    std::cout << "    -video_codec \"<fourcc>\"        " << video_codec_message << std::endl;
+    std::cout << "    -video_queue                   " << video_queue_message << std::endl;
+    std::cout << std::endl;
+    std::cout << "  Layer profiling:" << std::endl;
+    std::cout << "    -perf_counts_enable            " << perf_counts_enable_message << std::endl;
+    std::cout << "    -perf_counts_inferences        " << perf_counts_inferences_message << std::endl;
+    std::cout << "    -perf_counts_prefix \"<path>\"   " << perf_counts_prefix_message << std::endl;
+    std::cout << "    -perf_counts_format \"<format>\" " << perf_counts_format_message << std::endl;
+    std::cout << std::endl;
+    std::cout << "  Metrics:" << std::endl;
+    std::cout << "    -metrics_listen \"<spec>\"       " << metrics_listen_message << std::endl;
+    std::cout << std::endl;
+    std::cout << "  Actuator:" << std::endl;
+    std::cout << "    -vehicle_link \"<spec>\"         " << vehicle_link_message << std::endl;
+    std::cout << "    -actuator_rate_hz              " << actuator_rate_hz_message << std::endl;
+    std::cout << "    -actuator_min_gap_us           " << actuator_min_gap_us_message << std::endl;
+    std::cout << "    -actuator_priority             " << actuator_priority_message << std::endl;
+}
@@ -6,40 +6,202 @@
  */
 #include "AutoPilotThreadOperations.h"
 
-#include <pthread.h>
-#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <errno.h>
+#include <iomanip>
+#include <limits.h>
+#include <sched.h>
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <samples/slog.hpp>
 
-void createAllThreads(const vector<void*(*)(void*)>& threadRoutines,vector<pthread_t>& threads,
-		vector<int>& threadsCreationResults)
+ThreadConfig parseThreadConfig(const std::string& name, const std::string& spec)
 {
-	for (unsigned short k = 0; k < threadRoutines.size(); ++k)
+	ThreadConfig config(name);
+	std::stringstream stream(spec);
+	std::string item;
+	while (stream >> item)
 	{
-		threadsCreationResults[k] = pthread_create(&threads[k], NULL,threadRoutines[k], NULL);
+		const size_t colon = item.find(':');
+		const std::string key = item.substr(0, colon);
+		const std::string value = colon == std::string::npos ? "" : item.substr(colon + 1);
+		const std::string where = "Bad thread attribute \"" + item + "\" for " + name;
+		char end = 0;
 
-		if (threadsCreationResults[k]) {
-			fprintf(stderr, "Error - pthread_create() return code: %d\n",threadsCreationResults[k]);
-			exit(EXIT_FAILURE);
+		if (key == "cpus")
+		{
+			std::stringstream list(value);
+			std::string cpu;
+			while (std::getline(list, cpu, ','))
+			{
+				int n = -1;
+				if (std::sscanf(cpu.c_str(), "%d%c", &n, &end) != 1 || n < 0 || n >= CPU_SETSIZE)
+					throw std::logic_error(where + ", expected cpus:<n>[,<n>...]");
+				config.cpus.push_back(n);
+			}
+			if (config.cpus.empty())
+				throw std::logic_error(where + ", expected cpus:<n>[,<n>...]");
+		}
+		else if (key == "fifo")
+		{
+			if (std::sscanf(value.c_str(), "%d%c", &config.fifoPriority, &end) != 1 ||
+			    config.fifoPriority < sched_get_priority_min(SCHED_FIFO) ||
+			    config.fifoPriority > sched_get_priority_max(SCHED_FIFO))
+				throw std::logic_error(where + ", expected fifo:<" + std::to_string(sched_get_priority_min(SCHED_FIFO)) +
+				                       ".." + std::to_string(sched_get_priority_max(SCHED_FIFO)) + ">");
+		}
+		else if (key == "nice")
+		{
+			if (std::sscanf(value.c_str(), "%d%c", &config.nice, &end) != 1 || config.nice < -20 || config.nice > 19)
+				throw std::logic_error(where + ", expected nice:<-20..19>");
+		}
+		else if (key == "stack")
+		{
+			unsigned long size = 0;
+			char unit = 0;
+			const int fields = std::sscanf(value.c_str(), "%lu%c%c", &size, &unit, &end);
+			if (fields == 2 && (unit == 'k' || unit == 'K'))
+				size <<= 10;
+			else if (fields == 2 && (unit == 'm' || unit == 'M'))
+				size <<= 20;
+			else if (fields != 1)
+				throw std::logic_error(where + ", expected stack:<bytes>[k|m]");
+			config.stackSize = size;
+		}
+		else
+		{
+			throw std::logic_error(where + ", expected cpus:, fifo:, nice: or stack:");
 		}
 	}
+	return config;
 }
 
-void printThreadsCreationResults(const vector<void*(*)(void*)>& threadRoutines,
-		const vector<int>& threadCreationResult)
+static double threadCpuSeconds(clockid_t clock)
 {
-	for (unsigned short k = 0; k < threadRoutines.size(); ++k)
+	timespec ts;
+	if (clock_gettime(clock, &ts) != 0)
+		return 0;
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void ThreadLauncher::applyConfig(const ThreadConfig& config)
+{
+	if (!config.name.empty())
+		pthread_setname_np(pthread_self(), config.name.substr(0, 15).c_str());
+
+	if (!config.cpus.empty())
 	{
-		cout << "pthread_create() for thread " << k << " returns "<< threadCreationResult[k] << endl;
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (int cpu : config.cpus)
+			CPU_SET(cpu, &set);
+		int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+		if (result != 0)
+			slog::warn << config.name << ": CPU affinity not applied (" << strerror(result) << ")" << slog::endl;
+	}
+
+	if (config.fifoPriority > 0)
+	{
+		sched_param param = {};
+		param.sched_priority = config.fifoPriority;
+		int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+		if (result != 0)
+			slog::warn << config.name << ": SCHED_FIFO " << config.fifoPriority
+			           << " not applied (" << strerror(result) << "), running with default policy" << slog::endl;
+	}
+	else if (config.nice != 0)
+	{
+		// On Linux the nice level belongs to the thread, not the whole process
+		if (setpriority(PRIO_PROCESS, syscall(SYS_gettid), config.nice) != 0)
+			slog::warn << config.name << ": nice " << config.nice << " not applied (" << strerror(errno) << ")" << slog::endl;
 	}
 }
 
-void joinThreads(const vector<pthread_t>& threads)
+void* ThreadLauncher::entry(void* arg)
 {
-	for (auto thr : threads)
+	Thread* thread = static_cast<Thread*>(arg);
 	{
-		pthread_join(thr, NULL);
+		std::lock_guard<std::mutex> lock(thread->launcher->mtx);
+		thread->tid = syscall(SYS_gettid);
 	}
+	applyConfig(thread->config);
+
+	thread->routine();
+
+	const double cpuSeconds = threadCpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+	std::lock_guard<std::mutex> lock(thread->launcher->mtx);
+	thread->cpuSeconds = cpuSeconds;
+	thread->finished = std::chrono::steady_clock::now();
+	thread->running = false;
+	return nullptr;
 }
 
+void ThreadLauncher::launch(const ThreadConfig& config, const std::function<void()>& routine)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	threads.push_back(Thread());
+	Thread& thread = threads.back();
+	thread.launcher = this;
+	thread.config = config;
+	thread.routine = routine;
+	thread.tid = 0;
+	thread.cpuSeconds = 0;
+	thread.running = true;
+	thread.started = std::chrono::steady_clock::now();
+
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	if (config.stackSize > 0)
+	{
+		const size_t page = sysconf(_SC_PAGESIZE);
+		const size_t size = std::max<size_t>(config.stackSize, PTHREAD_STACK_MIN);
+		const size_t stackSize = (size + page - 1) / page * page;
+		int result = pthread_attr_setstacksize(&attr, stackSize);
+		if (result != 0)
+			slog::warn << config.name << ": stack size " << stackSize << " not applied (" << strerror(result)
+			           << "), running with the default stack" << slog::endl;
+	}
+	int result = pthread_create(&thread.handle, &attr, entry, &thread);
+	pthread_attr_destroy(&attr);
+
+	if (result != 0)
+	{
+		threads.pop_back();
+		throw std::runtime_error("Cannot create thread " + config.name + ": " + strerror(result));
+	}
+}
 
+void ThreadLauncher::joinAll()
+{
+	for (auto& thread : threads)
+		pthread_join(thread.handle, nullptr);
+}
 
+std::string ThreadLauncher::cpuTimeReport()
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	const auto now = std::chrono::steady_clock::now();
+	std::ostringstream report;
+	report << std::fixed << std::setprecision(2);
+	for (const auto& thread : threads)
+	{
+		double cpuSeconds = thread.cpuSeconds;
+		clockid_t clock;
+		if (thread.running && pthread_getcpuclockid(thread.handle, &clock) == 0)
+			cpuSeconds = threadCpuSeconds(clock);
+		const double wallSeconds = std::chrono::duration<double>((thread.running ? now : thread.finished) - thread.started).count();
 
+		report << std::left << std::setw(10) << thread.config.name << std::right
+		       << " tid " << std::setw(6) << thread.tid
+		       << "  cpu " << std::setw(9) << cpuSeconds << " s"
+		       << "  " << std::setw(6) << (wallSeconds > 0 ? 100 * cpuSeconds / wallSeconds : 0.0) << " % of a core"
+		       << (thread.running ? "" : "  (finished)") << "\n";
+	}
+	return report.str();
+}
@@ -8,17 +8,75 @@
 #ifndef AUTOPILOTTHREADOPERATIONS_H_
 #define AUTOPILOTTHREADOPERATIONS_H_
 
-
 #include <pthread.h>
+#include <sys/types.h>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
 #include <vector>
-#include<iostream>
 
-using namespace std;
+/*
+ * Attributes of one pipeline thread
+ */
+struct ThreadConfig
+{
+	std::string name;          // shown by top -H, at most 15 characters are kept
+	std::vector<int> cpus;     // CPUs the thread may run on, empty - any
+	int fifoPriority;          // > 0 - SCHED_FIFO with this priority
+	int nice;                  // nice level of a SCHED_OTHER thread
+	size_t stackSize;          // bytes, 0 - default
+
+	ThreadConfig(const std::string& name = ""):
+		name(name), fifoPriority(0), nice(0), stackSize(0)
+	{
+	}
+};
+
+/*
+ * Parses space separated "cpus:<n>[,<n>...]", "fifo:<priority>", "nice:<level>" and
+ * "stack:<bytes>[k|m]" items, e.g. "cpus:2,3 nice:5". Throws std::logic_error on bad input.
+ */
+ThreadConfig parseThreadConfig(const std::string& name, const std::string& spec);
+
+/*
+ * Starts the pipeline threads with their names, affinity, scheduling and stack size and
+ * keeps them to report the CPU time each one used.
+ */
+class ThreadLauncher
+{
+private:
+	struct Thread
+	{
+		ThreadLauncher* launcher;
+		ThreadConfig config;
+		std::function<void()> routine;
+		pthread_t handle;
+		pid_t tid;                 // 0 until the thread started
+		std::chrono::steady_clock::time_point started;
+		std::chrono::steady_clock::time_point finished;
+		double cpuSeconds;         // set when the routine returned
+		bool running;
+	};
 
-void createAllThreads(const vector<void*(*)(void*)>& threadRoutines,vector<pthread_t>& threads,vector<int>& threadsCreationResults);
+	std::list<Thread> threads;
+	std::mutex mtx;
 
-void printThreadsCreationResults(const vector<void*(*)(void*)>& threadRoutines,const vector<int>& threadCreationResult);
+	static void* entry(void* arg);
+	static void applyConfig(const ThreadConfig& config);
+public:
+	/*
+	 * Throws std::runtime_error when the thread cannot be created. Attributes the system
+	 * refuses (SCHED_FIFO without the privilege, a missing CPU) are logged and skipped.
+	 */
+	void launch(const ThreadConfig& config, const std::function<void()>& routine);
+	void joinAll();
 
-void joinThreads(const vector<pthread_t>& threads);
+	/*
+	 * One line per thread: CPU time so far and its share of one core since the start
+	 */
+	std::string cpuTimeReport();
+};
 
 #endif
@@ -0,0 +1,165 @@
+/*
+ * BehaviourPlanner.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "BehaviourPlanner.h"
+#include "VehicleProtocol.h"
+
+#include <algorithm>
+#include <cmath>
+
+Debounce::Debounce(int onFrames, int offFrames):
+	onFrames(onFrames),
+	offFrames(offFrames),
+	count(0),
+	state(false)
+{
+}
+
+bool Debounce::update(bool observed)
+{
+	if (observed == state)
+	{
+		count = 0;
+		return state;
+	}
+
+	if (++count >= (state ? offFrames : onFrames))
+	{
+		state = observed;
+		count = 0;
+	}
+	return state;
+}
+
+bool Debounce::active() const
+{
+	return state;
+}
+
+const char* driveStateName(DriveState state)
+{
+	switch (state)
+	{
+	case DriveState::Cruise: return "CRUISE";
+	case DriveState::Slow:   return "SLOW";
+	case DriveState::Yield:  return "YIELD";
+	case DriveState::Stop:   return "STOP";
+	}
+	return "UNKNOWN";
+}
+
+BehaviourPlanner::BehaviourPlanner(const PlannerParams& params, size_t frameWidth, size_t frameHeight):
+	params(params),
+	frameWidth(frameWidth),
+	frameHeight(frameHeight),
+	pedestrianAhead(params.onFrames, params.offFrames),
+	vehicleAhead(params.onFrames, params.offFrames),
+	redLight(params.onFrames, params.offFrames),
+	stopSign(params.onFrames, params.offFrames),
+	giveWay(params.onFrames, params.offFrames),
+	priorityRoad(params.onFrames, params.offFrames),
+	limit30(params.onFrames, params.offFrames),
+	limit50(params.onFrames, params.offFrames),
+	laneLost(params.onFrames, params.offFrames),
+	speedLimit(params.cruiseSpeed),
+	stopHold(0),
+	state(DriveState::Cruise)
+{
+}
+
+bool BehaviourPlanner::isAhead(const Detection& object, float minHeight) const
+{
+	float centerX = (object.xmin + object.xmax) / 2;
+	return object.ymax - object.ymin >= minHeight * frameHeight &&
+		centerX >= params.corridorLeft * frameWidth &&
+		centerX <= params.corridorRight * frameWidth;
+}
+
+PlannerDecision BehaviourPlanner::step(const WorldSnapshot& world)
+{
+	bool seen[(size_t)ObjectClass::Count] = {};
+	bool pedestrian = false, vehicle = false;
+
+	for (auto& detections : world.detections)
+	{
+		for (auto& object : detections.objects)
+		{
+			seen[(size_t)object.objectClass] = true;
+			if (object.objectClass == ObjectClass::Pedestrian)
+				pedestrian = pedestrian || isAhead(object, params.minPedestrianHeight);
+			else if (object.objectClass == ObjectClass::Vehicle)
+				vehicle = vehicle || isAhead(object, params.minVehicleHeight);
+		}
+	}
+
+	pedestrianAhead.update(pedestrian);
+	vehicleAhead.update(vehicle);
+	redLight.update(seen[(size_t)ObjectClass::TrafficLightRed] && !seen[(size_t)ObjectClass::TrafficLightGreen]);
+	giveWay.update(seen[(size_t)ObjectClass::GiveWay]);
+	priorityRoad.update(seen[(size_t)ObjectClass::PriorityRoad]);
+	laneLost.update(!world.lane.valid);
+
+	// Stop once per sign, the hold starts when the sign is confirmed
+	bool stopWasActive = stopSign.active();
+	if (stopSign.update(seen[(size_t)ObjectClass::Stop]) && !stopWasActive)
+		stopHold = params.stopHoldFrames;
+
+	// A speed limit holds until the next limit sign
+	bool limit30WasActive = limit30.active();
+	bool limit50WasActive = limit50.active();
+	if (limit30.update(seen[(size_t)ObjectClass::SpeedLimit30]) && !limit30WasActive)
+		speedLimit = params.limit30Speed;
+	if (limit50.update(seen[(size_t)ObjectClass::SpeedLimit50]) && !limit50WasActive)
+		speedLimit = params.limit50Speed;
+
+	PlannerDecision decision;
+	if (pedestrianAhead.active() || redLight.active() || stopHold > 0)
+		decision.state = DriveState::Stop;
+	else if (giveWay.active() && !priorityRoad.active())
+		decision.state = DriveState::Yield;
+	else if (vehicleAhead.active() || laneLost.active())
+		decision.state = DriveState::Slow;
+	else
+		decision.state = DriveState::Cruise;
+
+	if (stopHold > 0)
+		--stopHold;
+
+	switch (decision.state)
+	{
+	case DriveState::Stop:
+		decision.speed = 0;
+		break;
+	case DriveState::Slow:
+	case DriveState::Yield:
+		decision.speed = std::min(params.slowSpeed, speedLimit);
+		break;
+	default:
+		decision.speed = std::min(params.cruiseSpeed, speedLimit);
+		break;
+	}
+	decision.stopOn = decision.state == DriveState::Stop;
+
+	/* The angle reaches about +-180 degrees, saturate it to the servo before the cast */
+	decision.steerValid = world.lane.valid && std::isfinite(world.lane.steeringAngle);
+	decision.steer = STEER_NEUTRAL;
+	if (decision.steerValid)
+		decision.steer = (int8_t)std::min<float>(STEER_MAX,
+			std::max<float>(STEER_MIN, std::floor(world.lane.steeringAngle) + STEER_NEUTRAL));
+
+	state = decision.state;
+	return decision;
+}
+
+DriveState BehaviourPlanner::getState() const
+{
+	return state;
+}
+
+int16_t BehaviourPlanner::getSpeedLimit() const
+{
+	return speedLimit;
+}
@@ -0,0 +1,96 @@
+/*
+ * BehaviourPlanner.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "WorldModel.h"
+
+struct PlannerParams
+{
+	int16_t cruiseSpeed = 60;
+	int16_t limit50Speed = 50;
+	int16_t limit30Speed = 30;
+	int16_t slowSpeed = 20;
+
+	// An object is "ahead" when its box is this tall (fraction of the frame height)
+	// and its center lies in the [corridorLeft, corridorRight] band of the frame width
+	float minPedestrianHeight = 0.15f;
+	float minVehicleHeight = 0.20f;
+	float corridorLeft = 0.25f;
+	float corridorRight = 0.75f;
+
+	// Hysteresis, a condition needs onFrames consecutive hits to become active
+	// and offFrames consecutive misses to clear
+	int onFrames = 3;
+	int offFrames = 5;
+
+	// Frames to stand still at a stop sign before moving on
+	int stopHoldFrames = 30;
+
+	uint32_t budgetUs = 1000;
+};
+
+/*
+ * N-frame hysteresis over a per-frame boolean observation
+ */
+class Debounce
+{
+private:
+	int onFrames, offFrames;
+	int count;
+	bool state;
+public:
+	Debounce(int onFrames, int offFrames);
+
+	// Returns the debounced state after this frame
+	bool update(bool observed);
+	bool active() const;
+};
+
+enum class DriveState : uint8_t
+{
+	Cruise,
+	Slow,
+	Yield,
+	Stop
+};
+
+const char* driveStateName(DriveState state);
+
+struct PlannerDecision
+{
+	DriveState state;
+	int16_t speed;
+	bool stopOn;
+	bool steerValid;    // false - keep the last steering command
+	int8_t steer;       // servo value in [STEER_MIN, STEER_MAX]
+};
+
+class BehaviourPlanner
+{
+private:
+	PlannerParams params;
+	float frameWidth, frameHeight;
+
+	Debounce pedestrianAhead, vehicleAhead, redLight, stopSign, giveWay, priorityRoad, limit30, limit50, laneLost;
+	int16_t speedLimit;
+	int stopHold;
+	DriveState state;
+
+	bool isAhead(const Detection& object, float minHeight) const;
+public:
+	BehaviourPlanner(const PlannerParams& params, size_t frameWidth, size_t frameHeight);
+
+	/*
+	 * One planning step, called once per captured frame. Allocation free.
+	 */
+	PlannerDecision step(const WorldSnapshot& world);
+
+	DriveState getState() const;
+	int16_t getSpeedLimit() const;
+};
@@ -0,0 +1,94 @@
+/*
+ * BoundedQueue.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+/*
+ * Blocking FIFO with a fixed capacity. close() wakes everybody up: producers fail from
+ * then on, consumers drain what is left and then fail.
+ */
+template <typename T>
+class BoundedQueue
+{
+private:
+	std::mutex mtx;
+	std::condition_variable notEmpty, notFull;
+	std::deque<T> items;
+	size_t capacity;
+	bool closed;
+public:
+	explicit BoundedQueue(size_t capacity):
+		capacity(capacity),
+		closed(false)
+	{
+	}
+
+	/*
+	 * Blocks while the queue is full, false if it was closed
+	 */
+	bool push(T item)
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		notFull.wait(lock, [&]() { return closed || items.size() < capacity; });
+		if (closed)
+			return false;
+		items.push_back(std::move(item));
+		lock.unlock();
+		notEmpty.notify_one();
+		return true;
+	}
+
+	/*
+	 * Never blocks, false if the queue is full or closed
+	 */
+	bool tryPush(T item)
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		if (closed || items.size() >= capacity)
+			return false;
+		items.push_back(std::move(item));
+		lock.unlock();
+		notEmpty.notify_one();
+		return true;
+	}
+
+	/*
+	 * Blocks while the queue is empty, false once it is closed and drained
+	 */
+	bool pop(T& item)
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		notEmpty.wait(lock, [&]() { return closed || !items.empty(); });
+		if (items.empty())
+			return false;
+		item = std::move(items.front());
+		items.pop_front();
+		lock.unlock();
+		notFull.notify_one();
+		return true;
+	}
+
+	void close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			closed = true;
+		}
+		notEmpty.notify_all();
+		notFull.notify_all();
+	}
+
+	size_t size()
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		return items.size();
+	}
+};
@@ -0,0 +1,67 @@
+/*
+ * ConfigFile.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "ConfigFile.h"
+
+#include <fstream>
+#include <gflags/gflags.h>
+#include <set>
+#include <stdexcept>
+
+static std::string trim(const std::string& text)
+{
+	const char* blanks = " \t\r\n";
+	size_t begin = text.find_first_not_of(blanks);
+	if (begin == std::string::npos)
+		return "";
+	return text.substr(begin, text.find_last_not_of(blanks) - begin + 1);
+}
+
+void loadConfigFile(const std::string& path)
+{
+	std::ifstream file(path);
+	if (!file)
+		throw std::logic_error("Cannot open config file " + path);
+
+	std::string line, section;
+	std::set<std::string> fromFile;
+	for (size_t lineNum = 1; std::getline(file, line); ++lineNum)
+	{
+		line = trim(line.substr(0, line.find_first_of(";#")));
+		if (line.empty())
+			continue;
+
+		const std::string where = path + ":" + std::to_string(lineNum);
+
+		if (line.front() == '[')
+		{
+			if (line.back() != ']')
+				throw std::logic_error(where + " unterminated section");
+			section = trim(line.substr(1, line.size() - 2));
+			continue;
+		}
+
+		size_t equals = line.find('=');
+		if (equals == std::string::npos)
+			throw std::logic_error(where + " expected key = value");
+
+		std::string key = trim(line.substr(0, equals));
+		std::string value = trim(line.substr(equals + 1));
+		std::string flag = section.empty() ? key : section + "_" + key;
+
+		gflags::CommandLineFlagInfo info;
+		if (!gflags::GetCommandLineFlagInfo(flag.c_str(), &info))
+			throw std::logic_error(where + " unknown option " + flag);
+
+		// The command line overrides the file
+		if (!info.is_default && !fromFile.count(flag))
+			continue;
+
+		if (gflags::SetCommandLineOption(flag.c_str(), value.c_str()).empty())
+			throw std::logic_error(where + " invalid value \"" + value + "\" for " + flag);
+		fromFile.insert(flag);
+	}
+}
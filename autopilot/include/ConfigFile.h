@@ -0,0 +1,23 @@
+/*
+ * ConfigFile.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <string>
+
+/*
+ * Applies an INI file on top of the gflags defaults:
+ *
+ *   ; comment
+ *   vehicle_link = sim
+ *   [cars]
+ *   device = CPU        -> --cars_device=CPU
+ *
+ * Flags set explicitly on the command line are left alone. Unknown keys and
+ * values gflags rejects throw std::logic_error.
+ */
+void loadConfigFile(const std::string& path);
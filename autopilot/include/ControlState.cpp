@@ -0,0 +1,101 @@
+/*
+ * ControlState.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "ControlState.h"
+
+#include <thread>
+#include <time.h>
+
+VehicleCommand ControlState::toCommand() const
+{
+	VehicleCommand command;
+	command.speed = speed;
+	command.steer = steer;
+	command.lightsOn = lightsOn;
+	command.stopOn = stopOn;
+	return command;
+}
+
+bool ControlState::isStale(uint64_t nowNs, uint64_t deadlineNs) const
+{
+	return version == 0 || nowNs - timestampNs > deadlineNs;
+}
+
+ControlChannel::ControlChannel():
+	sequence(0),
+	packed(pack(ControlState())),
+	timestamp(0)
+{
+}
+
+uint32_t ControlChannel::pack(const ControlState& state)
+{
+	return (uint32_t)(uint16_t)state.speed |
+		((uint32_t)(uint8_t)state.steer << 16) |
+		((uint32_t)state.lightsOn << 24) |
+		((uint32_t)state.stopOn << 25);
+}
+
+void ControlChannel::unpack(uint32_t word, ControlState& state)
+{
+	state.speed = (int16_t)(word & 0xFFFF);
+	state.steer = (int8_t)((word >> 16) & 0xFF);
+	state.lightsOn = (word >> 24) & 1;
+	state.stopOn = (word >> 25) & 1;
+}
+
+void ControlChannel::publish(const ControlState& state)
+{
+	current = state;
+	current.timestampNs = nowNs();
+
+	uint32_t seq = sequence.load(std::memory_order_relaxed);
+	sequence.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	packed.store(pack(current), std::memory_order_relaxed);
+	timestamp.store(current.timestampNs, std::memory_order_relaxed);
+
+	sequence.store(seq + 2, std::memory_order_release);
+	current.version = (seq + 2) / 2;
+}
+
+ControlState ControlChannel::read() const
+{
+	ControlState state;
+	uint32_t begin = 0, end = 0, word = 0;
+	uint64_t stamp = 0;
+	do
+	{
+		begin = sequence.load(std::memory_order_acquire);
+		if (begin & 1)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		word = packed.load(std::memory_order_relaxed);
+		stamp = timestamp.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		end = sequence.load(std::memory_order_relaxed);
+	} while ((begin & 1) || begin != end);
+
+	unpack(word, state);
+	state.timestampNs = stamp;
+	state.version = begin / 2;
+	return state;
+}
+
+void ControlChannel::setChangeListener(const std::function<void()>& listener)
+{
+	onChange = listener;
+}
+
+uint64_t ControlChannel::nowNs()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
@@ -0,0 +1,86 @@
+/*
+ * ControlState.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include "VehicleProtocol.h"
+
+/*
+ * One consistent vehicle command as seen by the actuator
+ */
+struct ControlState
+{
+	int16_t speed = 0;
+	int8_t steer = STEER_NEUTRAL;
+	bool lightsOn = false;
+	bool stopOn = false;
+	uint32_t version = 0;        // 0 - nothing published yet
+	uint64_t timestampNs = 0;    // CLOCK_MONOTONIC of the last publish
+
+	VehicleCommand toCommand() const;
+
+	/*
+	 * True when the command was never published or is older than deadlineNs
+	 */
+	bool isStale(uint64_t nowNs, uint64_t deadlineNs) const;
+};
+
+/*
+ * Seqlock protected ControlState. Writers are serialized by a mutex and publish the whole
+ * state at once; readers never take a lock and retry only while a write is in flight, so
+ * they can never observe a half updated command.
+ */
+class ControlChannel
+{
+private:
+	std::atomic<uint32_t> sequence;
+	// payload is kept in relaxed atomics so the racing reads of the seqlock are well defined
+	std::atomic<uint32_t> packed;
+	std::atomic<uint64_t> timestamp;
+
+	std::mutex writerMtx;
+	ControlState current;
+	std::function<void()> onChange;
+
+	static uint32_t pack(const ControlState& state);
+	static void unpack(uint32_t word, ControlState& state);
+	void publish(const ControlState& state);
+public:
+	ControlChannel();
+
+	ControlState read() const;
+
+	/*
+	 * Applies modify to the latest state and publishes it, e.g.
+	 * channel.update([&](ControlState& state){ state.steer = angle; });
+	 */
+	template <typename Modifier>
+	void update(Modifier modify)
+	{
+		std::unique_lock<std::mutex> lock(writerMtx);
+		ControlState next = current;
+		modify(next);
+		bool changed = pack(next) != pack(current);
+		publish(next);
+		lock.unlock();
+
+		if (changed && onChange)
+			onChange();
+	}
+
+	/*
+	 * Called on the writer thread whenever a publish changes the command, not just its timestamp.
+	 * Must be set before writers start.
+	 */
+	void setChangeListener(const std::function<void()>& listener);
+
+	static uint64_t nowNs();
+};
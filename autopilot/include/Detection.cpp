@@ -0,0 +1,96 @@
+/*
+ * Detection.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "Detection.h"
+
+#include <algorithm>
+
+ObjectClass objectClassFromLabel(const std::string& label)
+{
+	// pedestrian_and_vehicles model (VOC classes)
+	if (label == "person")
+		return ObjectClass::Pedestrian;
+	if (label == "car" || label == "bus" || label == "motorbike" || label == "bicycle" || label == "train")
+		return ObjectClass::Vehicle;
+
+	// traffic_signs model
+	if (label == "speed_limit_30")
+		return ObjectClass::SpeedLimit30;
+	if (label == "speed_limit_50")
+		return ObjectClass::SpeedLimit50;
+	if (label == "priority_road")
+		return ObjectClass::PriorityRoad;
+	if (label == "give_way")
+		return ObjectClass::GiveWay;
+	if (label == "stop")
+		return ObjectClass::Stop;
+	if (label == "traffic_light_red")
+		return ObjectClass::TrafficLightRed;
+	if (label == "traffic_light_green")
+		return ObjectClass::TrafficLightGreen;
+
+	return ObjectClass::Unknown;
+}
+
+const char* objectClassName(ObjectClass objectClass)
+{
+	switch (objectClass)
+	{
+	case ObjectClass::Pedestrian:        return "pedestrian";
+	case ObjectClass::Vehicle:           return "vehicle";
+	case ObjectClass::SpeedLimit30:      return "speed_limit_30";
+	case ObjectClass::SpeedLimit50:      return "speed_limit_50";
+	case ObjectClass::PriorityRoad:      return "priority_road";
+	case ObjectClass::GiveWay:           return "give_way";
+	case ObjectClass::Stop:              return "stop";
+	case ObjectClass::TrafficLightRed:   return "traffic_light_red";
+	case ObjectClass::TrafficLightGreen: return "traffic_light_green";
+	case ObjectClass::Unknown:
+	case ObjectClass::Count:             break;
+	}
+	return "unknown";
+}
+
+std::vector<ObjectClass> objectClassesFromLabels(const std::vector<std::string>& labels)
+{
+	std::vector<ObjectClass> classes;
+	classes.reserve(labels.size());
+	for (auto& label : labels)
+		classes.push_back(objectClassFromLabel(label));
+	return classes;
+}
+
+float intersectionOverUnion(const Detection& a, const Detection& b)
+{
+	const float width = std::min(a.xmax, b.xmax) - std::max(a.xmin, b.xmin);
+	const float height = std::min(a.ymax, b.ymax) - std::max(a.ymin, b.ymin);
+	if (width <= 0 || height <= 0)
+		return 0;
+	const float intersection = width * height;
+	return intersection / ((a.xmax - a.xmin) * (a.ymax - a.ymin) + (b.xmax - b.xmin) * (b.ymax - b.ymin) - intersection);
+}
+
+void suppressDuplicates(std::vector<Detection>& objects, float iouThreshold)
+{
+	std::stable_sort(objects.begin(), objects.end(), [](const Detection& a, const Detection& b) {
+		return a.confidence > b.confidence;
+	});
+
+	size_t kept = 0;
+	for (size_t i = 0; i < objects.size(); ++i)
+	{
+		bool duplicate = false;
+		for (size_t j = 0; j < kept && !duplicate; ++j)
+		{
+			const bool sameClass = objects[j].objectClass == objects[i].objectClass &&
+			                       (objects[i].objectClass != ObjectClass::Unknown || objects[j].label == objects[i].label);
+			duplicate = sameClass && intersectionOverUnion(objects[j], objects[i]) > iouThreshold;
+		}
+		if (!duplicate)
+			objects[kept++] = objects[i];
+	}
+	objects.resize(kept);
+}
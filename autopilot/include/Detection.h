@@ -0,0 +1,67 @@
+/*
+ * Detection.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*
+ * What the planner understands, independent of the label ids of each model
+ */
+enum class ObjectClass : uint8_t
+{
+	Unknown,
+	Pedestrian,
+	Vehicle,
+	SpeedLimit30,
+	SpeedLimit50,
+	PriorityRoad,
+	GiveWay,
+	Stop,
+	TrafficLightRed,
+	TrafficLightGreen,
+	Count
+};
+
+ObjectClass objectClassFromLabel(const std::string& label);
+
+const char* objectClassName(ObjectClass objectClass);
+
+/*
+ * Maps a model's .labels file to planner classes, indexed by label id
+ */
+std::vector<ObjectClass> objectClassesFromLabels(const std::vector<std::string>& labels);
+
+/*
+ * One detection in frame pixel coordinates
+ */
+struct Detection
+{
+	int label;
+	ObjectClass objectClass;
+	float confidence;
+	float xmin, ymin, xmax, ymax;
+	uint32_t trackId;    // 0 - not tracked
+};
+
+float intersectionOverUnion(const Detection& a, const Detection& b);
+
+/*
+ * Class aware greedy NMS: drops every detection that overlaps a more confident one of the
+ * same planner class (of the same label for Unknown) by more than iouThreshold. Classes
+ * are model independent, so the objects of several models can be merged in one call.
+ */
+void suppressDuplicates(std::vector<Detection>& objects, float iouThreshold);
+
+struct DetectionSet
+{
+	uint64_t frameId = 0;
+	uint64_t timestampNs = 0;
+	std::vector<Detection> objects;
+};
@@ -0,0 +1,171 @@
+/*
+ * DetectionDecoder.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "DetectionDecoder.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/core/version.hpp>
+#include <sstream>
+#include <stdexcept>
+
+static constexpr int proposalSize = 7;
+
+// The box is scaled with one 4 float store
+static_assert(offsetof(Detection, ymax) == offsetof(Detection, xmin) + 3 * sizeof(float),
+              "Detection box coordinates must be contiguous");
+
+#if CV_SIMD128
+// OpenCV 5 dropped the comparison and bitwise operators of the vector types, v_gt and friends came with 4.6
+#if CV_VERSION_MAJOR < 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR < 6)
+static inline cv::v_float32x4 greater(const cv::v_float32x4& a, const cv::v_float32x4& b) { return a > b; }
+static inline cv::v_float32x4 less(const cv::v_float32x4& a, const cv::v_float32x4& b) { return a < b; }
+static inline cv::v_int32x4 bitAnd(const cv::v_int32x4& a, const cv::v_int32x4& b) { return a & b; }
+#else
+static inline cv::v_float32x4 greater(const cv::v_float32x4& a, const cv::v_float32x4& b) { return cv::v_gt(a, b); }
+static inline cv::v_float32x4 less(const cv::v_float32x4& a, const cv::v_float32x4& b) { return cv::v_lt(a, b); }
+static inline cv::v_int32x4 bitAnd(const cv::v_int32x4& a, const cv::v_int32x4& b) { return cv::v_and(a, b); }
+#endif
+
+/*
+ * Bit i set for every lane i of a comparison result that holds, what v_signmask returned
+ */
+static inline int laneBits(const cv::v_float32x4& mask)
+{
+	return cv::v_reduce_sum(bitAnd(cv::v_reinterpret_as_s32(mask), cv::v_int32x4(1, 2, 4, 8)));
+}
+#endif
+
+std::vector<Region> parseRegions(const std::string& spec)
+{
+	std::vector<Region> regions;
+	std::stringstream stream(spec);
+	std::string item;
+	while (stream >> item)
+	{
+		if (item == "full")
+		{
+			regions.push_back(Region{0, 0, 1, 1});
+			continue;
+		}
+
+		char end;
+		if (item.compare(0, 5, "grid:") == 0)
+		{
+			// Nothing may follow the columns and rows or the overlap
+			int columns = 0, rows = 0;
+			float overlap = 0;
+			const bool valid = std::sscanf(item.c_str(), "grid:%dx%d%c", &columns, &rows, &end) == 2 ||
+			                   std::sscanf(item.c_str(), "grid:%dx%d:%f%c", &columns, &rows, &overlap, &end) == 3;
+			if (!valid || columns < 1 || rows < 1 || overlap < 0 || overlap >= 1)
+				throw std::logic_error("Bad grid \"" + item + "\", expected grid:<columns>x<rows>[:<overlap>]");
+			// n tiles of size t overlapping by overlap * t cover 1: t * (n - (n - 1) * overlap) = 1
+			const float width = 1 / (columns - (columns - 1) * overlap);
+			const float height = 1 / (rows - (rows - 1) * overlap);
+			for (int row = 0; row < rows; ++row)
+				for (int column = 0; column < columns; ++column)
+					regions.push_back(Region{column * width * (1 - overlap), row * height * (1 - overlap), width, height});
+			continue;
+		}
+
+		Region region;
+		if (std::sscanf(item.c_str(), "%f,%f,%f,%f%c", &region.x, &region.y, &region.width, &region.height, &end) != 4 ||
+		    region.x < 0 || region.y < 0 || region.width <= 0 || region.height <= 0 ||
+		    region.x + region.width > 1.0001f || region.y + region.height > 1.0001f)
+			throw std::logic_error("Bad region \"" + item + "\", expected x,y,width,height within [0, 1]");
+		regions.push_back(region);
+	}
+	return regions;
+}
+
+DetectionDecoder::DetectionDecoder(int maxProposalCount, float threshold, const std::vector<ObjectClass>& objectClasses):
+	maxProposalCount(maxProposalCount),
+	threshold(threshold),
+	objectClasses(objectClasses)
+{
+	survivors.reserve(maxProposalCount);
+}
+
+const std::vector<int>& DetectionDecoder::filter(const float* proposals)
+{
+	survivors.resize(maxProposalCount);
+	int count = 0;
+	int i = 0;
+#if CV_SIMD128
+	const cv::v_float32x4 threshold4 = cv::v_setall_f32(threshold), zero = cv::v_setzero_f32();
+	for (; i + 4 <= maxProposalCount; i += 4)
+	{
+		const float* p = proposals + i * proposalSize;
+		const cv::v_float32x4 imageId(p[0], p[proposalSize], p[2 * proposalSize], p[3 * proposalSize]);
+		const cv::v_float32x4 confidence(p[2], p[proposalSize + 2], p[2 * proposalSize + 2], p[3 * proposalSize + 2]);
+		int keep = laneBits(greater(confidence, threshold4));
+		const cv::v_float32x4 ended = less(imageId, zero);
+		const int end = cv::v_check_any(ended) ? laneBits(ended) : 0;
+		if (end)
+			keep &= (end & -end) - 1;    // the list ends with image_id -1, keep what comes before
+
+		// Branch free compaction, every lane is written and only the kept ones are counted
+		survivors[count] = i;
+		count += keep & 1;
+		survivors[count] = i + 1;
+		count += (keep >> 1) & 1;
+		survivors[count] = i + 2;
+		count += (keep >> 2) & 1;
+		survivors[count] = i + 3;
+		count += (keep >> 3) & 1;
+
+		if (end)
+		{
+			survivors.resize(count);
+			return survivors;
+		}
+	}
+#endif
+	for (; i < maxProposalCount; ++i)
+	{
+		const float* p = proposals + i * proposalSize;
+		if (p[0] < 0)
+			break;
+		survivors[count] = i;
+		count += p[2] > threshold;
+	}
+	survivors.resize(count);
+	return survivors;
+}
+
+void DetectionDecoder::decode(const float* proposals, size_t frameWidth, size_t frameHeight,
+                              const std::vector<Region>& regions, std::vector<Detection>& objects)
+{
+	const std::vector<int>& kept = filter(proposals);
+	size_t next = objects.size();
+	objects.resize(next + kept.size());
+
+	const Region full{0, 0, 1, 1};
+	for (int index : kept)
+	{
+		const float* p = proposals + index * proposalSize;
+		const size_t item = static_cast<size_t>(p[0]);
+		const Region& region = item < regions.size() ? regions[item] : full;
+		const float scaleX = frameWidth * region.width, scaleY = frameHeight * region.height;
+		const float offsetX = frameWidth * region.x, offsetY = frameHeight * region.y;
+
+		Detection& object = objects[next++];
+		object.label = static_cast<int>(p[1]);
+		object.objectClass = static_cast<size_t>(object.label) < objectClasses.size() ?
+		                     objectClasses[object.label] : ObjectClass::Unknown;
+		object.confidence = p[2];
+#if CV_SIMD128
+		const cv::v_float32x4 scale(scaleX, scaleY, scaleX, scaleY), offset(offsetX, offsetY, offsetX, offsetY);
+		cv::v_store(&object.xmin, cv::v_fma(cv::v_load(p + 3), scale, offset));
+#else
+		object.xmin = p[3] * scaleX + offsetX;
+		object.ymin = p[4] * scaleY + offsetY;
+		object.xmax = p[5] * scaleX + offsetX;
+		object.ymax = p[6] * scaleY + offsetY;
+#endif
+	}
+}
@@ -0,0 +1,57 @@
+/*
+ * DetectionDecoder.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Detection.h"
+
+/*
+ * Part of the frame a batch item of the network sees, relative to the frame size
+ */
+struct Region
+{
+	float x, y, width, height;
+};
+
+/*
+ * "x,y,width,height" regions separated by spaces, "full" for the whole frame and
+ * "grid:<columns>x<rows>[:<overlap>]" for tiles overlapping by the given fraction of a
+ * tile. Empty is the whole frame. Throws std::logic_error.
+ */
+std::vector<Region> parseRegions(const std::string& spec);
+
+/*
+ * Turns the [1, 1, N, 7] DetectionOutput blob of an SSD (image_id, label, confidence,
+ * xmin, ymin, xmax, ymax, relative coordinates) into detections. The confidence test
+ * runs on 4 proposals at a time without branches, the survivors are compacted into a
+ * preallocated index array and their boxes are scaled 4 coordinates at a time, so the
+ * cost only depends on the number of proposals up to the end marker.
+ */
+class DetectionDecoder
+{
+private:
+	int maxProposalCount;
+	float threshold;
+	std::vector<ObjectClass> objectClasses;    // by label id
+	std::vector<int> survivors;
+public:
+	DetectionDecoder(int maxProposalCount, float threshold, const std::vector<ObjectClass>& objectClasses);
+
+	/*
+	 * Indices of the proposals above the threshold, in blob order, valid until the next call
+	 */
+	const std::vector<int>& filter(const float* proposals);
+
+	/*
+	 * Appends the proposals above the threshold in frameWidth x frameHeight pixel coordinates.
+	 * The boxes of batch item i are relative to regions[i], no regions is the whole frame.
+	 */
+	void decode(const float* proposals, size_t frameWidth, size_t frameHeight, const std::vector<Region>& regions,
+	            std::vector<Detection>& objects);
+};
@@ -0,0 +1,585 @@
+/*
+ * DriveLog.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "DriveLog.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <opencv2/imgcodecs/imgcodecs.hpp>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <samples/slog.hpp>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "The drive log is written in host byte order, which has to be little endian"
+#endif
+
+static const char fileMagic[8] = {'A', 'P', 'D', 'R', 'V', 'L', 'O', 'G'};
+static const char chunkMagic[4] = {'C', 'H', 'N', 'K'};
+static const char indexMagic[4] = {'D', 'I', 'D', 'X'};
+static const uint32_t fileVersion = 2;
+
+static const size_t fileHeaderSize = 16;
+static const size_t chunkHeaderSize = 32;
+static const size_t recordHeaderSize = 24;
+static const size_t indexEntrySize = 32;
+static const size_t trailerSize = 24;
+static const size_t detectionSize = 32;
+
+// Flush a chunk once it spans this much time even if it is not full
+static const uint64_t chunkSpanNs = 1000000000ULL;
+
+template <typename T>
+static void put(std::vector<uint8_t>& out, T value)
+{
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+	out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+static void putBytes(std::vector<uint8_t>& out, const void* data, size_t size)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	out.insert(out.end(), bytes, bytes + size);
+}
+
+template <typename T>
+static T get(const uint8_t* data)
+{
+	T value;
+	memcpy(&value, data, sizeof(T));
+	return value;
+}
+
+DriveLogWriter::DriveLogWriter(const std::string& path, int jpegQuality, size_t chunkBytes, size_t queueCapacity):
+	file(fopen(path.c_str(), "wb")),
+	path(path),
+	jpegQuality(jpegQuality),
+	chunkBytes(chunkBytes),
+	queue(queueCapacity),
+	current(),
+	offset(fileHeaderSize),
+	queued(0),
+	dropped(0),
+	bytes(0),
+	failed(false)
+{
+	if (file == nullptr)
+		throw std::logic_error("Cannot create drive log " + path + ": " + strerror(errno));
+
+	std::vector<uint8_t> header;
+	putBytes(header, fileMagic, sizeof(fileMagic));
+	put<uint32_t>(header, fileVersion);
+	put<uint32_t>(header, 0);
+	if (fwrite(header.data(), 1, header.size(), file) != header.size())
+	{
+		const std::string error = strerror(errno);
+		fclose(file);
+		file = nullptr;
+		throw std::logic_error("Cannot write drive log " + path + ": " + error);
+	}
+
+	chunk.reserve(chunkBytes + chunkBytes / 4);
+	writer = std::thread(&DriveLogWriter::writeLoop, this);
+}
+
+DriveLogWriter::~DriveLogWriter()
+{
+	close();
+}
+
+void DriveLogWriter::enqueue(Pending&& record)
+{
+	if (queue.tryPush(std::move(record)))
+		++queued;
+	else
+		++dropped;
+}
+
+void DriveLogWriter::logSource(const std::string& name)
+{
+	Pending record;
+	record.type = DriveLogType::Source;
+	record.timestampNs = ControlChannel::nowNs();
+	record.frameId = 0;
+	putBytes(record.payload, name.data(), name.size());
+	enqueue(std::move(record));
+}
+
+void DriveLogWriter::logFrame(uint64_t frameId, uint64_t timestampNs, const cv::Mat& frame)
+{
+	Pending record;
+	record.type = DriveLogType::Frame;
+	record.timestampNs = timestampNs;
+	record.frameId = frameId;
+	record.image = frame;
+	enqueue(std::move(record));
+}
+
+void DriveLogWriter::logFrameRef(uint64_t frameId, uint64_t timestampNs, uint64_t sourceIndex)
+{
+	Pending record;
+	record.type = DriveLogType::FrameRef;
+	record.timestampNs = timestampNs;
+	record.frameId = frameId;
+	put<uint64_t>(record.payload, sourceIndex);
+	enqueue(std::move(record));
+}
+
+void DriveLogWriter::logDetections(DetectorId detector, const DetectionSet& set)
+{
+	Pending record;
+	record.type = DriveLogType::Detections;
+	record.timestampNs = set.timestampNs;
+	record.frameId = set.frameId;
+	record.payload.reserve(8 + set.objects.size() * detectionSize);
+	put<uint8_t>(record.payload, (uint8_t)detector);
+	putBytes(record.payload, "\0\0\0", 3);
+	put<uint32_t>(record.payload, set.objects.size());
+	for (const Detection& object : set.objects)
+	{
+		put<int32_t>(record.payload, object.label);
+		put<uint8_t>(record.payload, (uint8_t)object.objectClass);
+		putBytes(record.payload, "\0\0\0", 3);
+		put<float>(record.payload, object.confidence);
+		put<float>(record.payload, object.xmin);
+		put<float>(record.payload, object.ymin);
+		put<float>(record.payload, object.xmax);
+		put<float>(record.payload, object.ymax);
+		put<uint32_t>(record.payload, object.trackId);
+	}
+	enqueue(std::move(record));
+}
+
+void DriveLogWriter::logLane(const LaneState& lane, const std::vector<float>& center)
+{
+	Pending record;
+	record.type = DriveLogType::Lane;
+	record.timestampNs = lane.timestampNs;
+	record.frameId = lane.frameId;
+	record.payload.reserve(12 + center.size() * sizeof(float));
+	put<float>(record.payload, lane.steeringAngle);
+	put<uint8_t>(record.payload, lane.valid);
+	putBytes(record.payload, "\0\0\0", 3);
+	put<uint32_t>(record.payload, center.size());
+	putBytes(record.payload, center.data(), center.size() * sizeof(float));
+	enqueue(std::move(record));
+}
+
+void DriveLogWriter::logCommand(uint64_t timestampNs, const VehicleCommand& command, uint32_t controlVersion)
+{
+	Pending record;
+	record.type = DriveLogType::Command;
+	record.timestampNs = timestampNs;
+	record.frameId = 0;
+	put<int16_t>(record.payload, command.speed);
+	put<int8_t>(record.payload, command.steer);
+	put<uint8_t>(record.payload, (command.lightsOn ? 1 : 0) | (command.stopOn ? 2 : 0));
+	put<uint32_t>(record.payload, controlVersion);
+	enqueue(std::move(record));
+}
+
+void DriveLogWriter::writeLoop()
+{
+	const std::vector<int> jpegParams = {cv::IMWRITE_JPEG_QUALITY, jpegQuality};
+	Pending record;
+	while (queue.pop(record))
+	{
+		if (record.type == DriveLogType::Frame)
+		{
+			cv::imencode(".jpg", record.image, record.payload, jpegParams);
+			record.image.release();
+		}
+
+		put<uint8_t>(chunk, (uint8_t)record.type);
+		putBytes(chunk, "\0\0\0", 3);
+		put<uint32_t>(chunk, record.payload.size());
+		put<uint64_t>(chunk, record.timestampNs);
+		put<uint64_t>(chunk, record.frameId);
+		putBytes(chunk, record.payload.data(), record.payload.size());
+
+		// Records of different threads are not strictly ordered in time
+		if (current.records == 0 || record.timestampNs < current.firstNs)
+			current.firstNs = record.timestampNs;
+		current.lastNs = std::max(current.lastNs, record.timestampNs);
+		++current.records;
+
+		if (chunk.size() >= chunkBytes || current.lastNs - current.firstNs >= chunkSpanNs)
+			flushChunk();
+	}
+	flushChunk();
+}
+
+void DriveLogWriter::flushChunk()
+{
+	if (current.records == 0)
+		return;
+	if (failed)
+	{
+		dropped += current.records;
+		chunk.clear();
+		current = IndexEntry();
+		return;
+	}
+
+	std::vector<uint8_t> header;
+	putBytes(header, chunkMagic, sizeof(chunkMagic));
+	put<uint32_t>(header, current.records);
+	put<uint64_t>(header, chunk.size());
+	put<uint64_t>(header, current.firstNs);
+	put<uint64_t>(header, current.lastNs);
+
+	// Whole chunks reach the kernel, a crash loses at most the chunk being filled
+	if (fwrite(header.data(), 1, header.size(), file) != header.size() ||
+	    fwrite(chunk.data(), 1, chunk.size(), file) != chunk.size() || fflush(file) != 0)
+	{
+		// Part of the chunk may be in the file, the offsets of anything after it are unknown
+		slog::warn << "Drive log " << path << ": write failed, " << strerror(errno)
+		           << ", dropping the records from here on" << slog::endl;
+		failed = true;
+		dropped += current.records;
+	}
+	else
+	{
+		current.offset = offset;
+		index.push_back(current);
+		offset += header.size() + chunk.size();
+		bytes = offset;
+	}
+
+	chunk.clear();
+	current = IndexEntry();
+}
+
+void DriveLogWriter::close()
+{
+	if (file == nullptr)
+		return;
+
+	queue.close();
+	writer.join();
+
+	// Without the index the log is read like one cut short by a crash
+	if (failed)
+	{
+		fclose(file);
+		file = nullptr;
+		return;
+	}
+
+	std::vector<uint8_t> footer;
+	for (const IndexEntry& entry : index)
+	{
+		put<uint64_t>(footer, entry.offset);
+		put<uint64_t>(footer, entry.firstNs);
+		put<uint64_t>(footer, entry.lastNs);
+		put<uint32_t>(footer, entry.records);
+		put<uint32_t>(footer, 0);
+	}
+	put<uint64_t>(footer, dropped);
+	put<uint64_t>(footer, offset);
+	put<uint32_t>(footer, index.size());
+	putBytes(footer, indexMagic, sizeof(indexMagic));
+	if (fwrite(footer.data(), 1, footer.size(), file) != footer.size() || fflush(file) != 0)
+	{
+		slog::warn << "Drive log " << path << ": index not written, " << strerror(errno) << slog::endl;
+		failed = true;
+	}
+	else
+		bytes = offset + footer.size();
+
+	fclose(file);
+	file = nullptr;
+}
+
+uint64_t DriveLogWriter::getQueued() const
+{
+	return queued;
+}
+
+uint64_t DriveLogWriter::getDropped() const
+{
+	return dropped;
+}
+
+uint64_t DriveLogWriter::getBytes() const
+{
+	return bytes;
+}
+
+size_t DriveLogWriter::getQueueDepth()
+{
+	return queue.size();
+}
+
+bool DriveLogWriter::hasFailed() const
+{
+	return failed;
+}
+
+const std::string& DriveLogWriter::getPath() const
+{
+	return path;
+}
+
+DriveLogReader::DriveLogReader(const std::string& path):
+	base(nullptr),
+	size(0),
+	indexed(false),
+	dropped(0),
+	chunkIndex(0),
+	position(0)
+{
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		throw std::logic_error("Cannot open drive log " + path + ": " + strerror(errno));
+
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size >= (off_t)fileHeaderSize)
+	{
+		void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping != MAP_FAILED)
+		{
+			base = static_cast<const uint8_t*>(mapping);
+			size = info.st_size;
+		}
+	}
+	::close(fd);
+
+	if (base == nullptr || memcmp(base, fileMagic, sizeof(fileMagic)) != 0 || get<uint32_t>(base + 8) != fileVersion)
+	{
+		if (base != nullptr)
+			munmap(const_cast<uint8_t*>(base), size);
+		throw std::logic_error(path + " is not a drive log");
+	}
+
+	indexed = readIndex();
+	if (!indexed)
+		scanChunks();
+	rewind();
+}
+
+DriveLogReader::~DriveLogReader()
+{
+	munmap(const_cast<uint8_t*>(base), size);
+}
+
+bool DriveLogReader::readIndex()
+{
+	if (size < fileHeaderSize + trailerSize || memcmp(base + size - 4, indexMagic, sizeof(indexMagic)) != 0)
+		return false;
+
+	const uint64_t droppedRecords = get<uint64_t>(base + size - trailerSize);
+	const uint64_t indexOffset = get<uint64_t>(base + size - 16);
+	const uint32_t count = get<uint32_t>(base + size - 8);
+	if (indexOffset < fileHeaderSize || indexOffset + (uint64_t)count * indexEntrySize + trailerSize != size)
+		return false;
+
+	std::vector<Chunk> found;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const uint8_t* entry = base + indexOffset + i * indexEntrySize;
+		Chunk chunk;
+		chunk.offset = get<uint64_t>(entry);
+		chunk.firstNs = get<uint64_t>(entry + 8);
+		chunk.lastNs = get<uint64_t>(entry + 16);
+		chunk.records = get<uint32_t>(entry + 24);
+		if (chunk.offset + chunkHeaderSize > indexOffset || memcmp(base + chunk.offset, chunkMagic, sizeof(chunkMagic)) != 0)
+			return false;
+		chunk.bytes = get<uint64_t>(base + chunk.offset + 8);
+		if (chunk.offset + chunkHeaderSize + chunk.bytes > indexOffset)
+			return false;
+		found.push_back(chunk);
+	}
+	chunks.swap(found);
+	dropped = droppedRecords;
+	return true;
+}
+
+void DriveLogReader::scanChunks()
+{
+	uint64_t offset = fileHeaderSize;
+	while (offset + chunkHeaderSize <= size && memcmp(base + offset, chunkMagic, sizeof(chunkMagic)) == 0)
+	{
+		Chunk chunk;
+		chunk.offset = offset;
+		chunk.records = get<uint32_t>(base + offset + 4);
+		chunk.bytes = get<uint64_t>(base + offset + 8);
+		chunk.firstNs = get<uint64_t>(base + offset + 16);
+		chunk.lastNs = get<uint64_t>(base + offset + 24);
+		// The last chunk may have been cut short
+		if (chunk.bytes > size - offset - chunkHeaderSize)
+			break;
+		chunks.push_back(chunk);
+		offset += chunkHeaderSize + chunk.bytes;
+	}
+}
+
+void DriveLogReader::enterChunk(size_t index)
+{
+	chunkIndex = index;
+	position = index < chunks.size() ? chunks[index].offset + chunkHeaderSize : 0;
+}
+
+size_t DriveLogReader::chunkCount() const
+{
+	return chunks.size();
+}
+
+bool DriveLogReader::hasIndex() const
+{
+	return indexed;
+}
+
+uint64_t DriveLogReader::droppedRecords() const
+{
+	return dropped;
+}
+
+uint64_t DriveLogReader::firstTimestampNs() const
+{
+	uint64_t first = 0;
+	for (const Chunk& chunk : chunks)
+		if (first == 0 || chunk.firstNs < first)
+			first = chunk.firstNs;
+	return first;
+}
+
+uint64_t DriveLogReader::lastTimestampNs() const
+{
+	uint64_t last = 0;
+	for (const Chunk& chunk : chunks)
+		last = std::max(last, chunk.lastNs);
+	return last;
+}
+
+void DriveLogReader::rewind()
+{
+	enterChunk(0);
+}
+
+bool DriveLogReader::seek(uint64_t timestampNs)
+{
+	for (size_t i = 0; i < chunks.size(); ++i)
+	{
+		if (chunks[i].lastNs >= timestampNs)
+		{
+			enterChunk(i);
+			return true;
+		}
+	}
+	enterChunk(chunks.size());
+	return false;
+}
+
+bool DriveLogReader::next(DriveLogRecord& record)
+{
+	while (chunkIndex < chunks.size())
+	{
+		const uint64_t end = chunks[chunkIndex].offset + chunkHeaderSize + chunks[chunkIndex].bytes;
+		if (position + recordHeaderSize <= end)
+		{
+			const uint8_t* header = base + position;
+			const uint32_t payloadSize = get<uint32_t>(header + 4);
+			if (position + recordHeaderSize + payloadSize <= end)
+			{
+				record.type = (DriveLogType)header[0];
+				record.size = payloadSize;
+				record.timestampNs = get<uint64_t>(header + 8);
+				record.frameId = get<uint64_t>(header + 16);
+				record.data = header + recordHeaderSize;
+				position += recordHeaderSize + payloadSize;
+				return true;
+			}
+		}
+		enterChunk(chunkIndex + 1);
+	}
+	return false;
+}
+
+std::string DriveLogReader::decodeSource(const DriveLogRecord& record)
+{
+	if (record.type != DriveLogType::Source)
+		return std::string();
+	return std::string(reinterpret_cast<const char*>(record.data), record.size);
+}
+
+cv::Mat DriveLogReader::decodeFrame(const DriveLogRecord& record)
+{
+	if (record.type != DriveLogType::Frame || record.size == 0)
+		return cv::Mat();
+	// imdecode only reads the buffer
+	const cv::Mat encoded(1, record.size, CV_8UC1, const_cast<uint8_t*>(record.data));
+	return cv::imdecode(encoded, cv::IMREAD_COLOR);
+}
+
+bool DriveLogReader::decodeFrameRef(const DriveLogRecord& record, uint64_t& sourceIndex)
+{
+	if (record.type != DriveLogType::FrameRef || record.size != sizeof(uint64_t))
+		return false;
+	sourceIndex = get<uint64_t>(record.data);
+	return true;
+}
+
+bool DriveLogReader::decodeDetections(const DriveLogRecord& record, DetectorId& detector, DetectionSet& set)
+{
+	if (record.type != DriveLogType::Detections || record.size < 8)
+		return false;
+	const uint32_t count = get<uint32_t>(record.data + 4);
+	if (record.data[0] >= (uint8_t)DetectorId::Count || record.size != 8 + (uint64_t)count * detectionSize)
+		return false;
+
+	detector = (DetectorId)record.data[0];
+	set.frameId = record.frameId;
+	set.timestampNs = record.timestampNs;
+	set.objects.resize(count);
+	const uint8_t* data = record.data + 8;
+	for (Detection& object : set.objects)
+	{
+		object.label = get<int32_t>(data);
+		object.objectClass = (ObjectClass)data[4];
+		object.confidence = get<float>(data + 8);
+		object.xmin = get<float>(data + 12);
+		object.ymin = get<float>(data + 16);
+		object.xmax = get<float>(data + 20);
+		object.ymax = get<float>(data + 24);
+		object.trackId = get<uint32_t>(data + 28);
+		data += detectionSize;
+	}
+	return true;
+}
+
+bool DriveLogReader::decodeLane(const DriveLogRecord& record, LaneState& lane, std::vector<float>& center)
+{
+	if (record.type != DriveLogType::Lane || record.size < 12)
+		return false;
+	const uint32_t rows = get<uint32_t>(record.data + 8);
+	if (record.size != 12 + (uint64_t)rows * sizeof(float))
+		return false;
+
+	lane.steeringAngle = get<float>(record.data);
+	lane.valid = record.data[4] != 0;
+	lane.frameId = record.frameId;
+	lane.timestampNs = record.timestampNs;
+	center.resize(rows);
+	memcpy(center.data(), record.data + 12, rows * sizeof(float));
+	return true;
+}
+
+bool DriveLogReader::decodeCommand(const DriveLogRecord& record, VehicleCommand& command, uint32_t& controlVersion)
+{
+	if (record.type != DriveLogType::Command || record.size != 8)
+		return false;
+	command.speed = get<int16_t>(record.data);
+	command.steer = get<int8_t>(record.data + 2);
+	command.lightsOn = (record.data[3] & 1) != 0;
+	command.stopOn = (record.data[3] & 2) != 0;
+	controlVersion = get<uint32_t>(record.data + 4);
+	return true;
+}
@@ -0,0 +1,196 @@
+/*
+ * DriveLog.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include "BoundedQueue.h"
+#include "ControlState.h"
+#include "VehicleProtocol.h"
+#include "WorldModel.h"
+
+/*
+ * Drive log file layout, all integers little endian:
+ *
+ *   file    = header chunk* [index trailer]
+ *   header  = "APDRVLOG" uint32 version uint32 0
+ *   chunk   = "CHNK" uint32 records uint64 bytes uint64 firstNs uint64 lastNs record*
+ *   record  = uint8 type uint8[3] 0 uint32 size uint64 timestampNs uint64 frameId payload[size]
+ *   index   = (uint64 offset uint64 firstNs uint64 lastNs uint32 records uint32 0)*
+ *   trailer = uint64 dropped uint64 indexOffset uint32 chunks "DIDX"
+ *
+ * Chunks are only appended, a log cut short by a crash or a failed write is read up to its
+ * last complete chunk by scanning them instead of using the index. dropped counts the
+ * records the writer could not queue.
+ */
+enum class DriveLogType : uint8_t
+{
+	Source = 1,        // payload: name of the frame source
+	Frame,             // payload: JPEG
+	FrameRef,          // payload: uint64 index of the frame in the source
+	Detections,        // payload: uint8 DetectorId uint8[3] uint32 count, 32 bytes per Detection
+	Lane,              // payload: float steeringAngle uint8 valid uint8[3] uint32 rows, float center[rows]
+	Command            // payload: int16 speed int8 steer uint8 flags uint32 controlVersion
+};
+
+/*
+ * One record as stored in the log, data points into the mapping of the reader
+ */
+struct DriveLogRecord
+{
+	DriveLogType type;
+	uint64_t timestampNs;
+	uint64_t frameId;
+	const uint8_t* data;
+	uint32_t size;
+};
+
+/*
+ * Appends records from the pipeline threads without blocking them: log*() only queue the
+ * record, a writer thread encodes frames, packs the records into chunks and writes them.
+ * Records are dropped and counted while the queue is full. After a failed write nothing
+ * more is written, not even the index, and the records of every later chunk are dropped.
+ */
+class DriveLogWriter
+{
+private:
+	struct Pending
+	{
+		DriveLogType type;
+		uint64_t timestampNs;
+		uint64_t frameId;
+		cv::Mat image;                 // Frame only, encoded by the writer thread
+		std::vector<uint8_t> payload;
+	};
+
+	struct IndexEntry
+	{
+		uint64_t offset;
+		uint64_t firstNs;
+		uint64_t lastNs;
+		uint32_t records;
+	};
+
+	FILE* file;
+	std::string path;
+	int jpegQuality;
+	size_t chunkBytes;
+	BoundedQueue<Pending> queue;
+	std::thread writer;
+
+	// owned by the writer thread
+	std::vector<uint8_t> chunk;
+	IndexEntry current;
+	std::vector<IndexEntry> index;
+	uint64_t offset;
+
+	std::atomic<uint64_t> queued;
+	std::atomic<uint64_t> dropped;
+	std::atomic<uint64_t> bytes;
+	std::atomic<bool> failed;
+
+	void enqueue(Pending&& record);
+	void writeLoop();
+	void flushChunk();
+public:
+	/*
+	 * Throws std::logic_error if the file cannot be created
+	 */
+	DriveLogWriter(const std::string& path, int jpegQuality = 80, size_t chunkBytes = 1 << 20,
+	               size_t queueCapacity = 256);
+	virtual ~DriveLogWriter();
+
+	void logSource(const std::string& name);
+	/*
+	 * frame is referenced, not copied, the caller must not write to its pixels afterwards
+	 */
+	void logFrame(uint64_t frameId, uint64_t timestampNs, const cv::Mat& frame);
+	void logFrameRef(uint64_t frameId, uint64_t timestampNs, uint64_t sourceIndex);
+	void logDetections(DetectorId detector, const DetectionSet& set);
+	void logLane(const LaneState& lane, const std::vector<float>& center);
+	void logCommand(uint64_t timestampNs, const VehicleCommand& command, uint32_t controlVersion);
+
+	/*
+	 * Writes what is queued, the index and closes the file. Called by the destructor.
+	 */
+	void close();
+
+	uint64_t getQueued() const;
+	uint64_t getDropped() const;
+	uint64_t getBytes() const;
+	// a write failed, the log ends with the last chunk written before it
+	bool hasFailed() const;
+	// records waiting for the writer thread
+	size_t getQueueDepth();
+	const std::string& getPath() const;
+};
+
+/*
+ * Maps a drive log and walks its records in order, seek() jumps to a timestamp through
+ * the chunk index
+ */
+class DriveLogReader
+{
+private:
+	struct Chunk
+	{
+		uint64_t offset;
+		uint64_t firstNs;
+		uint64_t lastNs;
+		uint32_t records;
+		uint64_t bytes;
+	};
+
+	const uint8_t* base;
+	size_t size;
+	std::vector<Chunk> chunks;
+	bool indexed;
+	uint64_t dropped;
+	size_t chunkIndex;
+	uint64_t position;             // next record, absolute offset
+
+	bool readIndex();
+	void scanChunks();
+	void enterChunk(size_t index);
+public:
+	/*
+	 * Throws std::logic_error if the file is not a drive log
+	 */
+	explicit DriveLogReader(const std::string& path);
+	virtual ~DriveLogReader();
+
+	DriveLogReader(const DriveLogReader&) = delete;
+	DriveLogReader& operator=(const DriveLogReader&) = delete;
+
+	size_t chunkCount() const;
+	// false if the log was not closed and the chunks were found by scanning
+	bool hasIndex() const;
+	// records the writer dropped while recording, 0 without an index
+	uint64_t droppedRecords() const;
+	uint64_t firstTimestampNs() const;
+	uint64_t lastTimestampNs() const;
+
+	void rewind();
+	/*
+	 * Continues from the chunk holding the first record at or after timestampNs
+	 */
+	bool seek(uint64_t timestampNs);
+	bool next(DriveLogRecord& record);
+
+	static std::string decodeSource(const DriveLogRecord& record);
+	static cv::Mat decodeFrame(const DriveLogRecord& record);
+	static bool decodeFrameRef(const DriveLogRecord& record, uint64_t& sourceIndex);
+	static bool decodeDetections(const DriveLogRecord& record, DetectorId& detector, DetectionSet& set);
+	static bool decodeLane(const DriveLogRecord& record, LaneState& lane, std::vector<float>& center);
+	static bool decodeCommand(const DriveLogRecord& record, VehicleCommand& command, uint32_t& controlVersion);
+};
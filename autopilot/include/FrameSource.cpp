@@ -0,0 +1,232 @@
+/*
+ * FrameSource.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "FrameSource.h"
+
+#include <algorithm>
+#include <opencv2/imgcodecs/imgcodecs.hpp>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <samples/slog.hpp>
+#include <samples/args_helper.hpp>
+
+VideoSource::VideoSource(const std::string& source):
+	source(source),
+	frames(0)
+{
+	if (source == "cam")
+		capture.open(0);
+	else
+		capture.open(source.c_str());
+
+	if (!capture.isOpened())
+		throw std::logic_error("Cannot open input file or camera " + source);
+}
+
+bool VideoSource::read(cv::Mat& frame)
+{
+	if (!capture.read(frame) || frame.empty())
+		return false;
+	++frames;
+	return true;
+}
+
+uint64_t VideoSource::lastIndex() const
+{
+	return frames - 1;
+}
+
+size_t VideoSource::width() const
+{
+	return (size_t)capture.get(cv::CAP_PROP_FRAME_WIDTH);
+}
+
+size_t VideoSource::height() const
+{
+	return (size_t)capture.get(cv::CAP_PROP_FRAME_HEIGHT);
+}
+
+std::string VideoSource::name() const
+{
+	return source;
+}
+
+ImageDirectorySource::ImageDirectorySource(const std::string& directory, const ImageDecodeParams& params):
+	directory(directory),
+	params(params),
+	decodeFlags(cv::IMREAD_COLOR),
+	next(0),
+	lastFileIndex(0),
+	scheduled(0),
+	stopping(false)
+{
+	readInputFilesArguments(files, directory);
+	std::sort(files.begin(), files.end());
+	open();
+}
+
+ImageDirectorySource::ImageDirectorySource(const std::string& name, const std::vector<std::string>& files,
+                                           const ImageDecodeParams& params):
+	directory(name),
+	files(files),
+	params(params),
+	decodeFlags(cv::IMREAD_COLOR),
+	next(0),
+	lastFileIndex(0),
+	scheduled(0),
+	stopping(false)
+{
+	open();
+}
+
+ImageDirectorySource::~ImageDirectorySource()
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		stopping = true;
+	}
+	slotFree.notify_all();
+	for (auto& decoder : decoders)
+		decoder.join();
+}
+
+void ImageDirectorySource::open()
+{
+	// Frame size is the size of the first readable image
+	cv::Mat first;
+	while (!files.empty())
+	{
+		first = cv::imread(files.front());
+		if (!first.empty())
+			break;
+		slog::warn << "Skipping " << files.front() << ", not an image" << slog::endl;
+		files.erase(files.begin());
+	}
+
+	if (files.empty())
+		throw std::logic_error("No images in " + directory);
+
+	// JPEG decodes directly at the reduced size, other formats are scaled after decoding
+	if (params.minSize.area() > 0)
+	{
+		static const int reduced[][2] = {{8, cv::IMREAD_REDUCED_COLOR_8}, {4, cv::IMREAD_REDUCED_COLOR_4},
+		                                 {2, cv::IMREAD_REDUCED_COLOR_2}};
+		for (const auto& factor : reduced)
+		{
+			if (first.cols / factor[0] >= params.minSize.width && first.rows / factor[0] >= params.minSize.height)
+			{
+				decodeFlags = factor[1];
+				first = decode(0);
+				break;
+			}
+		}
+	}
+	frameSize = first.size();
+
+	if (params.threads > 0)
+	{
+		window.resize(std::max<size_t>(params.prefetch, 1));
+		for (size_t i = 0; i < params.threads; ++i)
+			decoders.emplace_back(&ImageDirectorySource::decodeLoop, this);
+	}
+}
+
+cv::Mat ImageDirectorySource::decode(size_t index) const
+{
+	return cv::imread(files[index], decodeFlags);
+}
+
+void ImageDirectorySource::decodeLoop()
+{
+	std::unique_lock<std::mutex> lock(mtx);
+	while (true)
+	{
+		slotFree.wait(lock, [&]() { return stopping || scheduled >= files.size() || scheduled < next + window.size(); });
+		if (stopping || scheduled >= files.size())
+			return;
+
+		const size_t index = scheduled++;
+		lock.unlock();
+		cv::Mat image = decode(index);
+		lock.lock();
+
+		Slot& slot = window[index % window.size()];
+		slot.image = image;
+		slot.ready = true;
+		slotReady.notify_all();
+	}
+}
+
+bool ImageDirectorySource::read(cv::Mat& frame)
+{
+	while (next < files.size())
+	{
+		const size_t index = next;
+		if (decoders.empty())
+		{
+			frame = decode(index);
+			++next;
+		}
+		else
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			Slot& slot = window[index % window.size()];
+			slotReady.wait(lock, [&]() { return slot.ready; });
+			frame = slot.image;
+			slot.image.release();
+			slot.ready = false;
+			++next;
+			lock.unlock();
+			slotFree.notify_all();
+		}
+
+		if (!frame.empty())
+		{
+			lastFileIndex = index;
+			return true;
+		}
+		slog::warn << "Skipping " << files[index] << ", not an image" << slog::endl;
+	}
+	return false;
+}
+
+size_t ImageDirectorySource::width() const
+{
+	return frameSize.width;
+}
+
+size_t ImageDirectorySource::height() const
+{
+	return frameSize.height;
+}
+
+std::string ImageDirectorySource::name() const
+{
+	return directory;
+}
+
+size_t ImageDirectorySource::count() const
+{
+	return files.size();
+}
+
+const std::string& ImageDirectorySource::lastFile() const
+{
+	return files[lastFileIndex];
+}
+
+uint64_t ImageDirectorySource::lastIndex() const
+{
+	return lastFileIndex;
+}
+
+std::unique_ptr<FrameSource> createFrameSource(const std::string& input, const ImageDecodeParams& params)
+{
+	struct stat sb;
+	if (input != "cam" && stat(input.c_str(), &sb) == 0 && S_ISDIR(sb.st_mode))
+		return std::unique_ptr<FrameSource>(new ImageDirectorySource(input, params));
+	return std::unique_ptr<FrameSource>(new VideoSource(input));
+}
@@ -0,0 +1,125 @@
+/*
+ * FrameSource.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <opencv2/core/core.hpp>
+#include <opencv2/videoio/videoio.hpp>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Where frames come from: a camera, a video file or a directory of images
+ */
+class FrameSource
+{
+public:
+	virtual ~FrameSource() {}
+
+	/*
+	 * Next frame, false at the end of the stream
+	 */
+	virtual bool read(cv::Mat& frame) = 0;
+
+	/*
+	 * Position in the source of the frame returned by the last read(), counting the frames
+	 * read() skipped; a drive log records it to read the frame again on replay
+	 */
+	virtual uint64_t lastIndex() const = 0;
+
+	virtual size_t width() const = 0;
+	virtual size_t height() const = 0;
+	virtual std::string name() const = 0;
+};
+
+class VideoSource : public FrameSource
+{
+private:
+	cv::VideoCapture capture;
+	std::string source;
+	uint64_t frames;
+public:
+	// "cam" opens the first camera
+	explicit VideoSource(const std::string& source);
+
+	bool read(cv::Mat& frame) override;
+	uint64_t lastIndex() const override;
+	size_t width() const override;
+	size_t height() const override;
+	std::string name() const override;
+};
+
+struct ImageDecodeParams
+{
+	size_t threads = 0;        // decoding threads, 0 - decode on the thread calling read()
+	size_t prefetch = 8;       // images decoded ahead of read()
+	cv::Size minSize;          // decode at 1/2, 1/4 or 1/8 while the image stays at least this large, empty - full size
+};
+
+/*
+ * Images of a directory in file name order. With decoding threads the next images are
+ * decoded in parallel while the caller works on the current one; read() still returns
+ * them in order.
+ */
+class ImageDirectorySource : public FrameSource
+{
+private:
+	struct Slot
+	{
+		cv::Mat image;
+		bool ready = false;
+	};
+
+	std::string directory;
+	std::vector<std::string> files;
+	ImageDecodeParams params;
+	int decodeFlags;
+	size_t next;
+	size_t lastFileIndex;
+	cv::Size frameSize;
+
+	// Images [next, next + prefetch) are decoded into window[index % prefetch]
+	std::vector<Slot> window;
+	size_t scheduled;
+	bool stopping;
+	std::mutex mtx;
+	std::condition_variable slotFree, slotReady;
+	std::vector<std::thread> decoders;
+
+	void open();
+	cv::Mat decode(size_t index) const;
+	void decodeLoop();
+public:
+	explicit ImageDirectorySource(const std::string& directory, const ImageDecodeParams& params = ImageDecodeParams());
+	/*
+	 * Reads the given files instead of a whole directory, name is used in messages
+	 */
+	ImageDirectorySource(const std::string& name, const std::vector<std::string>& files,
+	                     const ImageDecodeParams& params = ImageDecodeParams());
+	virtual ~ImageDirectorySource();
+
+	bool read(cv::Mat& frame) override;
+	// Index of the file in files, unreadable files in between are counted
+	uint64_t lastIndex() const override;
+	size_t width() const override;
+	size_t height() const override;
+	std::string name() const override;
+
+	size_t count() const;
+	// File of the frame returned by the last read()
+	const std::string& lastFile() const;
+};
+
+/*
+ * Picks the source for -i, throws std::logic_error if it cannot be opened
+ */
+std::unique_ptr<FrameSource> createFrameSource(const std::string& input, const ImageDecodeParams& params = ImageDecodeParams());
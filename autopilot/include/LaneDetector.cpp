@@ -3,24 +3,25 @@
 using namespace std;
 
 constexpr double PI(std::acos(-1));
-constexpr uint16_t lineThreshold(50);
-constexpr uint16_t maxIterations(10);
-constexpr uint16_t histHeight(100);
-constexpr uint16_t slices = 10;
 
-LaneDetector::LaneDetector(float resizeRatio , uint16_t width, uint16_t height):
+LaneDetector::LaneDetector(float resizeRatio , uint16_t width, uint16_t height, const LaneParams& params):
     resizeRatio(resizeRatio),
     width(width*resizeRatio),
     height(height*resizeRatio),
+    params(params),
     angleFilter(0.5,50,100,0),
     steeringAngle(0),
     steeringAngleFiltered(0),
-	xMiddle(height, this->width / 2)
+	xMiddle(height, this->width / 2),
+    lanesDetected(false),
+    ransacIterations(0)
 {
-   ransac.Initialize(lineThreshold, maxIterations);
+   ransac.Initialize(params.lineThreshold, params.maxIterations);
+   if (params.seed != 0)
+     ransac.Seed(params.seed);
 
-   quadA[0] = cv::Point2f(0, this->height/1.4);
-   quadA[1] = cv::Point2f(this->width - 1 , this->height/1.4);
+   quadA[0] = cv::Point2f(0, this->height/params.quadRatio);
+   quadA[1] = cv::Point2f(this->width - 1 , this->height/params.quadRatio);
    quadA[2] = cv::Point2f(this->width-1, this->height-1);
    quadA[3] = cv::Point2f(0, this->height-1);
 
@@ -51,7 +52,8 @@ void LaneDetector::inversePerspective(cv::Mat& image)
 
 vector<uint16_t>* LaneDetector::calcHistogram(cv::Mat& image)
 {
-  static vector<uint16_t> histogram(image.cols);
+  static vector<uint16_t> histogram;
+  histogram.resize(image.cols);
 
   for(uint16_t i = 0; i < image.cols; ++i)
     histogram[i] = countNonZero(image.col(i));
@@ -61,18 +63,18 @@ vector<uint16_t>* LaneDetector::calcHistogram(cv::Mat& image)
 
 cv::Mat LaneDetector::plotHistogram(std::vector<uint16_t>* histogram)
 {
-  cv::Mat histogramImage(histHeight, width, CV_8UC3, cv::Scalar(0, 0, 0));
+  cv::Mat histogramImage(params.histHeight, width, CV_8UC3, cv::Scalar(0, 0, 0));
 
   for(uint16_t i = 0; i < width; ++i){
-    line(histogramImage, cv::Point(i-1, histHeight-(*histogram)[i-1]),
-      cv::Point(i, histHeight-(*histogram)[i]), cv::Scalar(255, 0, 0), 2, 8, 0);
+    line(histogramImage, cv::Point(i-1, params.histHeight-(*histogram)[i-1]),
+      cv::Point(i, params.histHeight-(*histogram)[i]), cv::Scalar(255, 0, 0), 2, 8, 0);
   }
   return histogramImage;
 }
 
 std::vector<std::vector<uint16_t>> LaneDetector::calcLanePoints(cv::Mat& image)
 {
-  const uint16_t sliceSize = (image.rows)/slices;
+  const uint16_t sliceSize = (image.rows)/params.slices;
   uint16_t maxLeftPos,maxRightPos;
   vector<uint16_t>* histogram;
   vector<uint16_t> leftVectorX, leftVectorY, rightVectorX, rightVectorY;
@@ -81,13 +83,14 @@ std::vector<std::vector<uint16_t>> LaneDetector::calcLanePoints(cv::Mat& image)
 
   static cv::Mat crop(sliceSize, image.cols, CV_8UC1);
 
-  for (uint16_t sliceNum = 0; sliceNum < slices; ++sliceNum)
+  for (uint16_t sliceNum = 0; sliceNum < params.slices; ++sliceNum)
   {
 	  crop = cv::Mat(image, cv::Rect(0, sliceNum * sliceSize, image.cols, sliceSize));
 	  histogram = calcHistogram(crop);
 
 	  const uint16_t y = (sliceNum * sliceSize) + 0.5 * sliceSize;
-	  const uint16_t middle = xMiddle[y];
+	  // search around the last lane center, the image center if the last frame had no lanes
+	  const uint16_t middle = y < xMiddle.size() ? xMiddle[y] : image.cols / 2;
 
 	  maxRightPos = distance(
 			  histogram->begin() + middle,max_element_forward(histogram->begin() + middle, histogram->end()));
@@ -103,6 +106,7 @@ std::vector<std::vector<uint16_t>> LaneDetector::calcLanePoints(cv::Mat& image)
   }
 
   if(ransac.Estimate(leftPoints)){
+    ransacIterations += params.maxIterations;
     auto leftInliers = ransac.GetBestInliers();
     for (auto& inliner : leftInliers)
     {
@@ -114,6 +118,7 @@ std::vector<std::vector<uint16_t>> LaneDetector::calcLanePoints(cv::Mat& image)
 
 
   if(ransac.Estimate(rightPoints)){
+    ransacIterations += params.maxIterations;
     auto rightInliers = ransac.GetBestInliers();
     for (auto& inliner : rightInliers)
     {
@@ -152,6 +157,7 @@ std::vector<std::vector<float>>* LaneDetector::fitLanePoints(std::vector<std::ve
 
    xMiddle.clear();
    yMiddle.clear();
+   lanesDetected = false;
 
    for (auto pt : points){
      if(pt.empty())
@@ -172,6 +178,13 @@ std::vector<std::vector<float>>* LaneDetector::fitLanePoints(std::vector<std::ve
    for(uint16_t i = 0; i < rx.size(); ++i)
       rightPointsMap[rx[i]] = ry[i];
 
+   // The 2nd degree fit needs 3 rows per lane, the extrapolation extrapolationSamples
+   // interpolated rows at each end
+   if (extrapolationSamples < 2 || leftPointsMap.size() < 3 || rightPointsMap.size() < 3 ||
+       (--leftPointsMap.end())->first - leftPointsMap.begin()->first < extrapolationSamples ||
+       (--rightPointsMap.end())->first - rightPointsMap.begin()->first < extrapolationSamples)
+     return nullptr;
+
    for (auto i = leftPointsMap.begin(); i != leftPointsMap.end(); ++i)
    {
       x.push_back(i->first); y.push_back(i->second);
@@ -241,6 +254,7 @@ std::vector<std::vector<float>>* LaneDetector::fitLanePoints(std::vector<std::ve
      xMiddle.push_back((rightInterpY[i]+leftInterpY[i])/2);
      yMiddle.push_back(rightInterpX[i]);
    }
+   lanesDetected = true;
    static std::vector<std::vector<float>> ret;
    ret.clear();
    ret = { leftInterpY, leftInterpX, rightInterpY, rightInterpX};
@@ -339,16 +353,31 @@ float LaneDetector::getFilteredSteeringAngle()
   return steeringAngleFiltered;
 }
 
+bool LaneDetector::lanesFound()
+{
+  return lanesDetected;
+}
+
+const vector<float>& LaneDetector::getLaneCenter()
+{
+  return xMiddle;
+}
+
+uint64_t LaneDetector::getRansacIterations()
+{
+  return ransacIterations;
+}
+
 cv::Mat* LaneDetector::runCurvePipeline(cv::Mat& input)
 {
    static cv::Mat image;
    resize(input, image, cv::Size(), resizeRatio, resizeRatio);
    transformPerspective(image);
    convertToGrayscale(image);
-//   auto fittedPoints = fitLanePoints(calcLanePoints(image),image);
-//   image = cv::Mat::zeros(height, width, CV_8UC3);
-//   plotLanePoints(fittedPoints, image);
-//   calcSteeringAngle(image, true, true);
+   auto fittedPoints = fitLanePoints(calcLanePoints(image),image);
+   image = cv::Mat::zeros(height, width, CV_8UC3);
+   plotLanePoints(fittedPoints, image);
+   calcSteeringAngle(image, true, true);
 //   cv::imshow("processed", image);
 //   inversePerspective(image);
    resize(image, image, cv::Size(), 1/resizeRatio, 1/resizeRatio);
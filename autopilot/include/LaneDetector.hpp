@@ -11,21 +11,33 @@
 
 using namespace std;
 
+struct LaneParams {
+  uint16_t lineThreshold = 50;     // RANSAC inlier distance
+  uint16_t maxIterations = 10;     // RANSAC iterations
+  uint16_t histHeight = 100;
+  uint16_t slices = 10;
+  float quadRatio = 1.4f;          // bird's eye view starts at height / quadRatio
+  uint32_t seed = 0;               // RANSAC seed, 0 - random on every run, otherwise the same lanes on any core count
+};
+
 class LaneDetector {
   private:
 
   float resizeRatio;
   uint16_t width, height;
+  LaneParams params;
   Kalman angleFilter;
   float steeringAngle;
   float steeringAngleFiltered;
   cv::Point2f quadA[4], quadB[4];
   GRANSAC::RANSAC<Line2DModel, 2> ransac;
   vector<float> xMiddle, yMiddle;
+  bool lanesDetected;
+  uint64_t ransacIterations;
 
   public:
 
-  LaneDetector(float,uint16_t, uint16_t);
+  LaneDetector(float,uint16_t, uint16_t, const LaneParams& = LaneParams());
 
   void convertToGrayscale(cv::Mat&);
   void transformPerspective(cv::Mat&);
@@ -42,6 +54,12 @@ class LaneDetector {
   void calcSteeringAngle(cv::Mat&, bool, bool);
   float getSteeringAngle();
   float getFilteredSteeringAngle();
+  // both lanes were fitted in the last frame
+  bool lanesFound();
+  // lane center column per row of the last bird's eye view, empty if no lanes were found
+  const vector<float>& getLaneCenter();
+  // RANSAC iterations run since construction
+  uint64_t getRansacIterations();
 };
 
 template <class ForwardIterator>
@@ -0,0 +1,210 @@
+/*
+ * LayerProfile.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "LayerProfile.h"
+#include "Percentile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <samples/csv_dumper.hpp>
+
+using namespace InferenceEngine;
+
+LayerProfile::LayerProfile(const std::string& model, const std::string& device):
+	model(model),
+	device(device)
+{
+}
+
+void LayerProfile::add(const std::map<std::string, InferenceEngineProfileInfo>& counts)
+{
+	long long total = 0;
+	for (const auto& count : counts)
+	{
+		Layer& layer = layers[count.first];
+		if (layer.realTimeUs.empty())
+		{
+			layer.name = count.first;
+			layer.type = count.second.layer_type;
+			layer.cpuTimeUs = 0;
+		}
+		layer.execType = count.second.exec_type;
+		layer.status = count.second.status;
+		layer.executionIndex = count.second.execution_index;
+		layer.realTimeUs.push_back(count.second.realTime_uSec);
+		layer.cpuTimeUs += count.second.cpu_uSec;
+		if (count.second.realTime_uSec > 0)
+			total += count.second.realTime_uSec;
+	}
+	totalUs.push_back(total);
+}
+
+size_t LayerProfile::inferences() const
+{
+	return totalUs.size();
+}
+
+std::vector<const LayerProfile::Layer*> LayerProfile::sorted() const
+{
+	std::vector<const Layer*> result;
+	for (const auto& layer : layers)
+		result.push_back(&layer.second);
+	std::stable_sort(result.begin(), result.end(), [](const Layer* l, const Layer* r)
+	{
+		return l->executionIndex < r->executionIndex;
+	});
+	return result;
+}
+
+LayerProfile::Stats LayerProfile::stats(std::vector<long long> samples)
+{
+	Stats result = {0, 0, 0, 0, 0};
+	if (samples.empty())
+		return result;
+
+	std::sort(samples.begin(), samples.end());
+	long long sum = 0;
+	for (long long sample : samples)
+		sum += sample;
+	result.mean = (double)sum / samples.size();
+	result.p50 = nearestRank(samples, 0.5);
+	result.p90 = nearestRank(samples, 0.9);
+	result.p99 = nearestRank(samples, 0.99);
+	result.max = samples.back();
+	return result;
+}
+
+const char* LayerProfile::statusName(InferenceEngineProfileInfo::LayerStatus status)
+{
+	switch (status)
+	{
+	case InferenceEngineProfileInfo::EXECUTED:
+		return "EXECUTED";
+	case InferenceEngineProfileInfo::NOT_RUN:
+		return "NOT_RUN";
+	case InferenceEngineProfileInfo::OPTIMIZED_OUT:
+		return "OPTIMIZED_OUT";
+	}
+	return "UNKNOWN";
+}
+
+bool LayerProfile::write(const std::string& path) const
+{
+	if (path.size() > 5 && path.compare(path.size() - 5, 5, ".json") == 0)
+		return writeJson(path);
+	return writeCsv(path);
+}
+
+bool LayerProfile::writeCsv(const std::string& path) const
+{
+	CsvDumper dumper(true, path);
+	if (!dumper.dumpEnabled())
+		return false;
+
+	dumper << "layer" << "type" << "exec_type" << "status" << "execution_index" << "runs" << "mean_us"
+	       << "p50_us" << "p90_us" << "p99_us" << "max_us" << "cpu_mean_us";
+	dumper.endLine();
+	for (const Layer* layer : sorted())
+	{
+		const Stats time = stats(layer->realTimeUs);
+		dumper << layer->name << layer->type << layer->execType << statusName(layer->status) << layer->executionIndex
+		       << layer->realTimeUs.size() << time.mean << time.p50 << time.p90 << time.p99 << time.max
+		       << (double)layer->cpuTimeUs / layer->realTimeUs.size();
+		dumper.endLine();
+	}
+	// Whole network, as the sum of its executed layers; the type columns only apply to layers
+	const Stats total = stats(totalUs);
+	dumper << "total" << "" << "" << "" << "" << totalUs.size() << total.mean << total.p50 << total.p90
+	       << total.p99 << total.max << "";
+	dumper.endLine();
+	return true;
+}
+
+static std::string jsonString(const std::string& text)
+{
+	std::string out = "\"";
+	for (char c : text)
+	{
+		if (c == '"' || c == '\\')
+		{
+			out += '\\';
+			out += c;
+		}
+		else if ((unsigned char)c < 0x20)
+		{
+			char escaped[8];
+			snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+			out += escaped;
+		}
+		else
+			out += c;
+	}
+	return out + "\"";
+}
+
+static void writeJsonStats(std::ostream& out, double mean, long long p50, long long p90, long long p99, long long max)
+{
+	out << "\"mean_us\": " << mean << ", \"p50_us\": " << p50 << ", \"p90_us\": " << p90 << ", \"p99_us\": "
+	    << p99 << ", \"max_us\": " << max;
+}
+
+bool LayerProfile::writeJson(const std::string& path) const
+{
+	std::ofstream out(path);
+	if (!out)
+		return false;
+
+	out << std::fixed << std::setprecision(1);
+	const Stats total = stats(totalUs);
+	out << "{\n  \"model\": " << jsonString(model) << ",\n  \"device\": " << jsonString(device)
+	    << ",\n  \"inferences\": " << totalUs.size() << ",\n  \"total\": {";
+	writeJsonStats(out, total.mean, total.p50, total.p90, total.p99, total.max);
+	out << "},\n  \"layers\": [";
+
+	const char* separator = "\n";
+	for (const Layer* layer : sorted())
+	{
+		const Stats time = stats(layer->realTimeUs);
+		out << separator << "    {\"name\": " << jsonString(layer->name) << ", \"type\": " << jsonString(layer->type)
+		    << ", \"exec_type\": " << jsonString(layer->execType) << ", \"status\": \"" << statusName(layer->status)
+		    << "\", \"execution_index\": " << layer->executionIndex << ", \"runs\": " << layer->realTimeUs.size() << ", ";
+		writeJsonStats(out, time.mean, time.p50, time.p90, time.p99, time.max);
+		out << ", \"cpu_mean_us\": " << (double)layer->cpuTimeUs / layer->realTimeUs.size() << "}";
+		separator = ",\n";
+	}
+	out << "\n  ]\n}\n";
+	return (bool)out;
+}
+
+std::string LayerProfile::slowest(size_t count) const
+{
+	std::vector<std::pair<double, const Layer*>> executed;
+	for (const Layer* layer : sorted())
+		if (layer->status == InferenceEngineProfileInfo::EXECUTED)
+			executed.push_back(std::make_pair(stats(layer->realTimeUs).mean, layer));
+	std::stable_sort(executed.begin(), executed.end(), [](const std::pair<double, const Layer*>& l,
+	                                                      const std::pair<double, const Layer*>& r)
+	{
+		return l.first > r.first;
+	});
+
+	const double totalMean = stats(totalUs).mean;
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(1);
+	for (size_t i = 0; i < executed.size() && i < count; ++i)
+	{
+		const Layer* layer = executed[i].second;
+		out << "  " << std::setw(40) << std::left << layer->name << std::setw(16) << layer->type
+		    << std::setw(24) << layer->execType << std::right << std::setw(10) << executed[i].first << " us";
+		if (totalMean > 0)
+			out << std::setw(7) << 100 * executed[i].first / totalMean << " %";
+		out << "\n";
+	}
+	return out.str();
+}
@@ -0,0 +1,67 @@
+/*
+ * LayerProfile.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <inference_engine.hpp>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*
+ * Per-layer performance counters of one network collected over many inferences. The
+ * report lists every layer in execution order with the mean and percentiles of its time,
+ * which shows the layers worth pruning or quantizing on a device.
+ */
+class LayerProfile
+{
+private:
+	struct Layer
+	{
+		std::string name;
+		std::string type;
+		std::string execType;
+		InferenceEngine::InferenceEngineProfileInfo::LayerStatus status;
+		unsigned executionIndex;
+		std::vector<long long> realTimeUs;
+		long long cpuTimeUs;
+	};
+
+	struct Stats
+	{
+		double mean;
+		long long p50, p90, p99, max;
+	};
+
+	std::string model;
+	std::string device;
+	std::map<std::string, Layer> layers;
+	std::vector<long long> totalUs;    // sum of the executed layers, per inference
+
+	std::vector<const Layer*> sorted() const;
+	static Stats stats(std::vector<long long> samples);
+	static const char* statusName(InferenceEngine::InferenceEngineProfileInfo::LayerStatus status);
+public:
+	LayerProfile(const std::string& model, const std::string& device);
+
+	void add(const std::map<std::string, InferenceEngine::InferenceEngineProfileInfo>& counts);
+	size_t inferences() const;
+
+	/*
+	 * *.json - one object with the layers as an array, anything else - CSV through CsvDumper.
+	 * false if the file cannot be written.
+	 */
+	bool write(const std::string& path) const;
+	bool writeCsv(const std::string& path) const;
+	bool writeJson(const std::string& path) const;
+
+	/*
+	 * The count slowest executed layers by mean time, one per line
+	 */
+	std::string slowest(size_t count) const;
+};
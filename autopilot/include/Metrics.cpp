@@ -0,0 +1,361 @@
+/*
+ * Metrics.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <samples/slog.hpp>
+
+static void appendNumber(std::string& out, double value)
+{
+	char text[32];
+	snprintf(text, sizeof(text), "%.17g", value);
+	out += text;
+}
+
+static void appendSample(std::string& out, const std::string& name, const std::string& labels, double value)
+{
+	out += name;
+	out += labels;
+	out += ' ';
+	appendNumber(out, value);
+	out += '\n';
+}
+
+Counter::Counter():
+	value(0)
+{
+}
+
+uint64_t Counter::get() const
+{
+	return value.load(std::memory_order_relaxed);
+}
+
+void Counter::write(std::string& out, const std::string& name, const std::string& labels) const
+{
+	out += name + labels + " " + std::to_string(get()) + "\n";
+}
+
+Gauge::Gauge():
+	value(0)
+{
+}
+
+double Gauge::get() const
+{
+	return value.load(std::memory_order_relaxed);
+}
+
+void Gauge::write(std::string& out, const std::string& name, const std::string& labels) const
+{
+	appendSample(out, name, labels, get());
+}
+
+Histogram::Histogram(const std::vector<double>& bounds):
+	bounds(bounds),
+	buckets(new std::atomic<uint64_t>[bounds.size() + 1]),
+	sum(0)
+{
+	std::sort(this->bounds.begin(), this->bounds.end());
+	for (size_t i = 0; i <= bounds.size(); ++i)
+		buckets[i].store(0, std::memory_order_relaxed);
+}
+
+void Histogram::observe(double v)
+{
+	const size_t bucket = std::lower_bound(bounds.begin(), bounds.end(), v) - bounds.begin();
+	buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+
+	double current = sum.load(std::memory_order_relaxed);
+	while (!sum.compare_exchange_weak(current, current + v, std::memory_order_relaxed))
+		;
+}
+
+uint64_t Histogram::getCount() const
+{
+	uint64_t count = 0;
+	for (size_t i = 0; i <= bounds.size(); ++i)
+		count += buckets[i].load(std::memory_order_relaxed);
+	return count;
+}
+
+void Histogram::write(std::string& out, const std::string& name, const std::string& labels) const
+{
+	// The buckets are read one by one while observe() goes on, keep them cumulative anyway
+	const std::string prefix = labels.empty() ? "{" : labels.substr(0, labels.size() - 1) + ",";
+	uint64_t cumulative = 0;
+	for (size_t i = 0; i <= bounds.size(); ++i)
+	{
+		cumulative += buckets[i].load(std::memory_order_relaxed);
+		out += name + "_bucket" + prefix + "le=\"";
+		if (i < bounds.size())
+			appendNumber(out, bounds[i]);
+		else
+			out += "+Inf";
+		out += "\"} " + std::to_string(cumulative) + "\n";
+	}
+	appendSample(out, name + "_sum", labels, sum.load(std::memory_order_relaxed));
+	out += name + "_count" + labels + " " + std::to_string(cumulative) + "\n";
+}
+
+SampledMetric::SampledMetric(const std::function<double()>& sample):
+	sample(sample)
+{
+}
+
+void SampledMetric::write(std::string& out, const std::string& name, const std::string& labels) const
+{
+	appendSample(out, name, labels, sample());
+}
+
+Metric* MetricsRegistry::find(const std::string& name, const std::string& type, const std::string& labels)
+{
+	for (Family& family : families)
+	{
+		if (family.name != name)
+			continue;
+		if (family.type != type)
+			throw std::logic_error("Metric " + name + " is a " + family.type + ", not a " + type);
+		for (Series& series : family.series)
+			if (series.labels == labels)
+				return series.metric.get();
+	}
+	return nullptr;
+}
+
+Metric* MetricsRegistry::add(const std::string& name, const std::string& help, const std::string& type,
+                             const std::string& labels, Metric* metric)
+{
+	Series series;
+	series.labels = labels;
+	series.metric.reset(metric);
+
+	for (Family& family : families)
+	{
+		if (family.name == name)
+		{
+			family.series.push_back(std::move(series));
+			return metric;
+		}
+	}
+	Family family;
+	family.name = name;
+	family.help = help;
+	family.type = type;
+	family.series.push_back(std::move(series));
+	families.push_back(std::move(family));
+	return metric;
+}
+
+static std::string braced(const std::string& labels)
+{
+	return labels.empty() ? labels : "{" + labels + "}";
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	Metric* metric = find(name, "counter", braced(labels));
+	if (metric == nullptr)
+		metric = add(name, help, "counter", braced(labels), new Counter());
+	return *static_cast<Counter*>(metric);
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const std::string& labels)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	Metric* metric = find(name, "gauge", braced(labels));
+	if (metric == nullptr)
+		metric = add(name, help, "gauge", braced(labels), new Gauge());
+	return *static_cast<Gauge*>(metric);
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                      const std::vector<double>& bounds, const std::string& labels)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	Metric* metric = find(name, "histogram", braced(labels));
+	if (metric == nullptr)
+		metric = add(name, help, "histogram", braced(labels), new Histogram(bounds));
+	return *static_cast<Histogram*>(metric);
+}
+
+void MetricsRegistry::sampled(const std::string& name, const std::string& help, const std::string& type,
+                              const std::function<double()>& sample, const std::string& labels)
+{
+	if (type != "counter" && type != "gauge")
+		throw std::logic_error("Sampled metric " + name + " should be a counter or a gauge, not a " + type);
+
+	std::lock_guard<std::mutex> lock(mtx);
+	if (find(name, type, braced(labels)) != nullptr)
+		throw std::logic_error("Sampled metric " + name + braced(labels) + " is already registered");
+	add(name, help, type, braced(labels), new SampledMetric(sample));
+}
+
+std::string MetricsRegistry::exposition() const
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	std::string out;
+	for (const Family& family : families)
+	{
+		out += "# HELP " + family.name + " " + family.help + "\n";
+		out += "# TYPE " + family.name + " " + family.type + "\n";
+		for (const Series& series : family.series)
+			series.metric->write(out, family.name, series.labels);
+	}
+	return out;
+}
+
+MetricsServer::MetricsServer(const MetricsRegistry& registry, const std::string& listen):
+	registry(registry),
+	listen(listen),
+	listenFd(-1),
+	stopping(false)
+{
+	if (listen.compare(0, 5, "unix:") == 0 && listen.size() > 5)
+	{
+		unixPath = listen.substr(5);
+		sockaddr_un address;
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if (unixPath.size() >= sizeof(address.sun_path))
+			throw std::logic_error("Metrics socket path " + unixPath + " is too long");
+		strncpy(address.sun_path, unixPath.c_str(), sizeof(address.sun_path) - 1);
+
+		// A socket left behind by a previous run
+		unlink(unixPath.c_str());
+		listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (listenFd >= 0 && bind(listenFd, (const sockaddr*)&address, sizeof(address)) != 0)
+		{
+			::close(listenFd);
+			listenFd = -1;
+		}
+	}
+	else if (listen.compare(0, 4, "tcp:") == 0)
+	{
+		char* end = nullptr;
+		const long port = strtol(listen.c_str() + 4, &end, 10);
+		if (end == listen.c_str() + 4 || *end != '\0' || port <= 0 || port > 65535)
+			throw std::logic_error("Metrics port should be 1-65535, not \"" + listen.substr(4) + "\"");
+
+		sockaddr_in address;
+		memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_port = htons(port);
+		// Scraped from the companion computer through ssh or a local agent, never exposed
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+		listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		const int reuse = 1;
+		if (listenFd >= 0 && (setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+		                      bind(listenFd, (const sockaddr*)&address, sizeof(address)) != 0))
+		{
+			::close(listenFd);
+			listenFd = -1;
+		}
+	}
+	else
+		throw std::logic_error("Metrics listen should be \"tcp:<port>\" or \"unix:<path>\", not \"" + listen + "\"");
+
+	if (listenFd < 0 || ::listen(listenFd, 4) != 0)
+		throw std::logic_error("Cannot listen for metrics on " + listen + ": " + strerror(errno));
+
+	server = std::thread(&MetricsServer::serveLoop, this);
+}
+
+MetricsServer::~MetricsServer()
+{
+	close();
+}
+
+void MetricsServer::serveLoop()
+{
+	pthread_setname_np(pthread_self(), "metrics");
+	while (!stopping)
+	{
+		int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+		if (fd < 0)
+		{
+			if (errno != EINTR && errno != ECONNABORTED && !stopping)
+			{
+				slog::warn << "Metrics on " << listen << ": accept failed, " << strerror(errno) << slog::endl;
+				return;
+			}
+			continue;
+		}
+		serve(fd);
+		::close(fd);
+	}
+}
+
+void MetricsServer::serve(int fd)
+{
+	// A scraper that stops talking must not hold the server
+	timeval timeout;
+	timeout.tv_sec = 1;
+	timeout.tv_usec = 0;
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+	std::string request;
+	char buffer[1024];
+	while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192)
+	{
+		const ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+		if (n <= 0)
+			return;
+		request.append(buffer, n);
+	}
+
+	std::string response;
+	if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 6, "GET / ") == 0)
+	{
+		const std::string body = registry.exposition();
+		response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+		           std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+	}
+	else
+		response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+	for (size_t sent = 0; sent < response.size();)
+	{
+		const ssize_t n = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+		if (n <= 0)
+			return;
+		sent += n;
+	}
+}
+
+void MetricsServer::close()
+{
+	if (!server.joinable())
+		return;
+
+	stopping = true;
+	// Wakes up accept()
+	shutdown(listenFd, SHUT_RDWR);
+	server.join();
+	::close(listenFd);
+	if (!unixPath.empty())
+		unlink(unixPath.c_str());
+}
+
+const std::string& MetricsServer::getListen() const
+{
+	return listen;
+}
@@ -0,0 +1,168 @@
+/*
+ * Metrics.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Metrics are updated with relaxed atomics only, the pipeline threads never take a lock
+ * for them. Registration and export take the registry lock.
+ */
+class Metric
+{
+public:
+	virtual ~Metric() {}
+	// Prometheus samples of the metric, labels already formatted as {...} or empty
+	virtual void write(std::string& out, const std::string& name, const std::string& labels) const = 0;
+};
+
+class Counter : public Metric
+{
+private:
+	std::atomic<uint64_t> value;
+public:
+	Counter();
+
+	void add(uint64_t n = 1)
+	{
+		value.fetch_add(n, std::memory_order_relaxed);
+	}
+	uint64_t get() const;
+
+	void write(std::string& out, const std::string& name, const std::string& labels) const override;
+};
+
+class Gauge : public Metric
+{
+private:
+	std::atomic<double> value;
+public:
+	Gauge();
+
+	void set(double v)
+	{
+		value.store(v, std::memory_order_relaxed);
+	}
+	double get() const;
+
+	void write(std::string& out, const std::string& name, const std::string& labels) const override;
+};
+
+/*
+ * Fixed buckets, observe() is a search over the bounds and two relaxed atomic updates; the
+ * count is the sum of the buckets
+ */
+class Histogram : public Metric
+{
+private:
+	std::vector<double> bounds;                         // upper bounds, ascending, +Inf is implicit
+	std::unique_ptr<std::atomic<uint64_t>[]> buckets;   // not cumulative, bounds.size() + 1
+	std::atomic<double> sum;
+public:
+	explicit Histogram(const std::vector<double>& bounds);
+
+	void observe(double v);
+	uint64_t getCount() const;
+
+	void write(std::string& out, const std::string& name, const std::string& labels) const override;
+};
+
+/*
+ * Value read when the metrics are exported, for numbers the code keeps anyway (queue
+ * depths, counters of other classes)
+ */
+class SampledMetric : public Metric
+{
+private:
+	std::function<double()> sample;
+public:
+	explicit SampledMetric(const std::function<double()>& sample);
+
+	void write(std::string& out, const std::string& name, const std::string& labels) const override;
+};
+
+/*
+ * Named metrics exported in the Prometheus text format. Every call with the same name and
+ * labels returns the same metric; the references stay valid for the life of the registry.
+ */
+class MetricsRegistry
+{
+private:
+	struct Series
+	{
+		std::string labels;
+		std::unique_ptr<Metric> metric;
+	};
+
+	struct Family
+	{
+		std::string name;
+		std::string help;
+		std::string type;
+		std::vector<Series> series;
+	};
+
+	mutable std::mutex mtx;
+	std::vector<Family> families;
+
+	Metric* find(const std::string& name, const std::string& type, const std::string& labels);
+	Metric* add(const std::string& name, const std::string& help, const std::string& type,
+	            const std::string& labels, Metric* metric);
+public:
+	/*
+	 * labels are given without braces, e.g. stage="lanes"
+	 */
+	Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+	Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+	Histogram& histogram(const std::string& name, const std::string& help, const std::vector<double>& bounds,
+	                     const std::string& labels = "");
+	/*
+	 * type is "counter" or "gauge"
+	 */
+	void sampled(const std::string& name, const std::string& help, const std::string& type,
+	             const std::function<double()>& sample, const std::string& labels = "");
+
+	std::string exposition() const;
+};
+
+/*
+ * Serves the exposition of a registry over HTTP on "tcp:<port>" (127.0.0.1 only) or
+ * "unix:<path>", on its own thread
+ */
+class MetricsServer
+{
+private:
+	const MetricsRegistry& registry;
+	std::string listen;
+	std::string unixPath;
+	int listenFd;
+	std::atomic<bool> stopping;
+	std::thread server;
+
+	void serveLoop();
+	void serve(int fd);
+public:
+	/*
+	 * Throws std::logic_error if listen is malformed or the socket cannot be bound
+	 */
+	MetricsServer(const MetricsRegistry& registry, const std::string& listen);
+	virtual ~MetricsServer();
+
+	MetricsServer(const MetricsServer&) = delete;
+	MetricsServer& operator=(const MetricsServer&) = delete;
+
+	void close();
+	const std::string& getListen() const;
+};
@@ -0,0 +1,46 @@
+/*
+ * MotionGate.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "MotionGate.h"
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+// Coarse enough to ignore sensor noise, fine enough to see a pedestrian stepping in
+static const cv::Size thumbnailSize(32, 24);
+
+cv::Mat makeThumbnail(const cv::Mat& frame)
+{
+	cv::Mat small, gray;
+	cv::resize(frame, small, thumbnailSize, 0, 0, cv::INTER_AREA);
+	if (small.channels() == 1)
+		return small;
+	cv::cvtColor(small, gray, cv::COLOR_BGR2GRAY);
+	return gray;
+}
+
+MotionGate::MotionGate(const MotionGateParams& params):
+	params(params),
+	referenceFrameId(0)
+{
+}
+
+float MotionGate::score(const cv::Mat& thumbnail) const
+{
+	if (reference.empty() || reference.size() != thumbnail.size())
+		return 255;
+	return cv::norm(thumbnail, reference, cv::NORM_L1) / thumbnail.total();
+}
+
+bool MotionGate::changed(const cv::Mat& thumbnail, uint64_t frameId) const
+{
+	return frameId - referenceFrameId >= (uint64_t)params.refreshFrames || score(thumbnail) >= params.threshold;
+}
+
+void MotionGate::commit(const cv::Mat& thumbnail, uint64_t frameId)
+{
+	thumbnail.copyTo(reference);
+	referenceFrameId = frameId;
+}
@@ -0,0 +1,55 @@
+/*
+ * MotionGate.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <opencv2/core/core.hpp>
+
+struct MotionGateParams
+{
+	float threshold = 2.0f;      // mean absolute thumbnail difference in gray levels that counts as a change
+	int refreshFrames = 30;      // captured frames after which a static scene is inferred anyway
+};
+
+/*
+ * Gray, area averaged thumbnail of a frame, what the gate compares. Cheap enough for the
+ * capture stage.
+ */
+cv::Mat makeThumbnail(const cv::Mat& frame);
+
+/*
+ * Decides whether a stage has to look at a frame again: the frame's thumbnail is compared
+ * with the thumbnail of the last frame the stage processed. Asking has no side effects, the
+ * stage commits a frame once its results are out, so a frame it skipped for another reason
+ * (the scheduler, a failed inference) is still a change on the next one.
+ */
+class MotionGate
+{
+private:
+	MotionGateParams params;
+	cv::Mat reference;
+	uint64_t referenceFrameId;
+public:
+	explicit MotionGate(const MotionGateParams& params);
+
+	/*
+	 * Mean absolute difference from the reference in gray levels, 255 without a reference
+	 */
+	float score(const cv::Mat& thumbnail) const;
+
+	/*
+	 * True if the scene changed by more than the threshold since the last committed frame
+	 * or refreshFrames captured frames went by since then
+	 */
+	bool changed(const cv::Mat& thumbnail, uint64_t frameId) const;
+
+	/*
+	 * The stage processed the frame, it becomes the new reference
+	 */
+	void commit(const cv::Mat& thumbnail, uint64_t frameId);
+};
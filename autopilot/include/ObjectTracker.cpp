@@ -0,0 +1,198 @@
+/*
+ * ObjectTracker.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "ObjectTracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+ConstantVelocity::ConstantVelocity(float x, float measurementVariance, float velocityVariance):
+	x(x),
+	v(0),
+	p00(measurementVariance),
+	p01(0),
+	p11(velocityVariance)
+{
+}
+
+void ConstantVelocity::predict(float dt, float accelerationVariance)
+{
+	// F = [1 dt; 0 1], Q of a white noise acceleration
+	x += v * dt;
+	p00 += dt * (2 * p01 + dt * p11) + accelerationVariance * dt * dt * dt / 3;
+	p01 += dt * p11 + accelerationVariance * dt * dt / 2;
+	p11 += accelerationVariance * dt;
+}
+
+void ConstantVelocity::update(float z, float measurementVariance)
+{
+	const float innovation = z - x;
+	const float s = p00 + measurementVariance;
+	const float k0 = p00 / s, k1 = p01 / s;
+	x += k0 * innovation;
+	v += k1 * innovation;
+	p11 -= k1 * p01;
+	p01 *= 1 - k0;
+	p00 *= 1 - k0;
+}
+
+float ConstantVelocity::position() const
+{
+	return x;
+}
+
+float ConstantVelocity::velocity() const
+{
+	return v;
+}
+
+// Until a track has been seen twice its velocity is anything up to this, pixels / s
+static constexpr float initialSpeed = 500;
+
+ObjectTracker::ObjectTracker(const TrackerParams& params):
+	params(params),
+	nextId(1),
+	lastTimestampNs(0),
+	frameIntervalS(0)
+{
+}
+
+void ObjectTracker::predictTo(uint64_t timestampNs)
+{
+	if (lastTimestampNs != 0 && timestampNs > lastTimestampNs)
+	{
+		const float dt = (timestampNs - lastTimestampNs) / 1e9f;
+		frameIntervalS = frameIntervalS == 0 ? dt : 0.9f * frameIntervalS + 0.1f * dt;
+
+		const float q = params.accelerationNoise * params.accelerationNoise;
+		for (Track& track : tracks)
+		{
+			track.cx.predict(dt, q);
+			track.cy.predict(dt, q);
+			track.w.predict(dt, q);
+			track.h.predict(dt, q);
+		}
+	}
+	lastTimestampNs = timestampNs;
+}
+
+Detection ObjectTracker::predictedBox(const Track& track) const
+{
+	Detection box = track.object;
+	const float halfWidth = std::max(1.0f, track.w.position()) / 2;
+	const float halfHeight = std::max(1.0f, track.h.position()) / 2;
+	box.xmin = track.cx.position() - halfWidth;
+	box.xmax = track.cx.position() + halfWidth;
+	box.ymin = track.cy.position() - halfHeight;
+	box.ymax = track.cy.position() + halfHeight;
+	box.trackId = track.id;
+	return box;
+}
+
+void ObjectTracker::update(const std::vector<Detection>& detections, uint64_t timestampNs)
+{
+	predictTo(timestampNs);
+
+	// Greedy assignment, the best overlapping pair of the same class first
+	struct Candidate
+	{
+		float iou;
+		size_t track, detection;
+	};
+	std::vector<Candidate> candidates;
+	for (size_t t = 0; t < tracks.size(); ++t)
+	{
+		const Detection predicted = predictedBox(tracks[t]);
+		for (size_t d = 0; d < detections.size(); ++d)
+		{
+			if (detections[d].objectClass != predicted.objectClass || detections[d].label != predicted.label)
+				continue;
+			const float iou = intersectionOverUnion(predicted, detections[d]);
+			if (iou >= params.minIou)
+				candidates.push_back(Candidate{iou, t, d});
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+		return a.iou > b.iou;
+	});
+
+	const float r = params.measurementNoise * params.measurementNoise;
+	std::vector<bool> trackMatched(tracks.size(), false), detectionMatched(detections.size(), false);
+	for (const Candidate& candidate : candidates)
+	{
+		if (trackMatched[candidate.track] || detectionMatched[candidate.detection])
+			continue;
+		trackMatched[candidate.track] = detectionMatched[candidate.detection] = true;
+
+		Track& track = tracks[candidate.track];
+		const Detection& object = detections[candidate.detection];
+		track.cx.update((object.xmin + object.xmax) / 2, r);
+		track.cy.update((object.ymin + object.ymax) / 2, r);
+		track.w.update(object.xmax - object.xmin, r);
+		track.h.update(object.ymax - object.ymin, r);
+		track.object = object;
+		track.hits++;
+		track.missed = 0;
+	}
+
+	for (size_t t = 0; t < tracks.size(); ++t)
+		if (!trackMatched[t])
+			tracks[t].missed++;
+	tracks.erase(std::remove_if(tracks.begin(), tracks.end(), [&](const Track& track) {
+		return track.missed > params.maxMissed;
+	}), tracks.end());
+
+	const float velocityVariance = initialSpeed * initialSpeed;
+	for (size_t d = 0; d < detections.size(); ++d)
+	{
+		if (detectionMatched[d])
+			continue;
+		const Detection& object = detections[d];
+		tracks.push_back(Track{nextId++, object,
+		                       ConstantVelocity((object.xmin + object.xmax) / 2, r, velocityVariance),
+		                       ConstantVelocity((object.ymin + object.ymax) / 2, r, velocityVariance),
+		                       ConstantVelocity(object.xmax - object.xmin, r, velocityVariance),
+		                       ConstantVelocity(object.ymax - object.ymin, r, velocityVariance),
+		                       1, 0});
+	}
+}
+
+void ObjectTracker::predict(uint64_t timestampNs)
+{
+	predictTo(timestampNs);
+}
+
+void ObjectTracker::getObjects(std::vector<Detection>& objects) const
+{
+	// A track the detector lost coasts on its prediction until it is dropped
+	for (const Track& track : tracks)
+		if (track.hits >= params.minHits && track.missed <= params.maxMissed)
+			objects.push_back(predictedBox(track));
+}
+
+int ObjectTracker::detectionInterval() const
+{
+	// Largest movement per frame relative to the object size; new tracks have no velocity yet
+	float motion = 0;
+	for (const Track& track : tracks)
+	{
+		if (track.hits < 2)
+			return 1;
+		const float size = std::max(1.0f, std::min(track.w.position(), track.h.position()));
+		const float speed = std::max(std::max(std::fabs(track.cx.velocity()), std::fabs(track.cy.velocity())),
+		                             std::max(std::fabs(track.w.velocity()), std::fabs(track.h.velocity())));
+		motion = std::max(motion, speed * frameIntervalS / size);
+	}
+
+	if (motion * params.maxInterval <= params.maxShift)
+		return std::max(1, params.maxInterval);
+	return std::max(1, std::min(params.maxInterval, (int)(params.maxShift / motion)));
+}
+
+size_t ObjectTracker::trackCount() const
+{
+	return tracks.size();
+}
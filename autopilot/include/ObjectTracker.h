@@ -0,0 +1,94 @@
+/*
+ * ObjectTracker.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "Detection.h"
+
+struct TrackerParams
+{
+	float minIou = 0.3f;             // a detection continues a track if their boxes overlap this much
+	int minHits = 1;                 // detections before a track is reported
+	int maxMissed = 3;               // detector runs a track survives without a matching detection
+	float measurementNoise = 4.0f;   // box coordinate noise of the detector, pixels
+	float accelerationNoise = 400.0f;    // pixels / s^2
+	int maxInterval = 4;             // most frames between detector runs, 1 - run on every frame
+	float maxShift = 0.25f;          // an object may move this fraction of its size between detector runs
+};
+
+/*
+ * Constant velocity Kalman filter of one coordinate
+ */
+class ConstantVelocity
+{
+private:
+	float x, v;              // position, velocity per second
+	float p00, p01, p11;     // covariance
+public:
+	ConstantVelocity(float x, float measurementVariance, float velocityVariance);
+
+	void predict(float dt, float accelerationVariance);
+	void update(float z, float measurementVariance);
+	float position() const;
+	float velocity() const;
+};
+
+/*
+ * SORT style multi object tracker: every track keeps a constant velocity Kalman filter of
+ * its box center and size, detections are matched to the predicted boxes greedily by IoU
+ * within the same class. Between detector runs the tracks are only predicted, so the
+ * planner gets an object state on every frame while the detector runs on every Nth.
+ */
+class ObjectTracker
+{
+private:
+	struct Track
+	{
+		uint32_t id;
+		Detection object;    // label, class and confidence of the last matching detection
+		ConstantVelocity cx, cy, w, h;
+		int hits;
+		int missed;
+	};
+
+	TrackerParams params;
+	std::vector<Track> tracks;
+	uint32_t nextId;
+	uint64_t lastTimestampNs;
+	float frameIntervalS;    // smoothed time between frames
+
+	void predictTo(uint64_t timestampNs);
+	Detection predictedBox(const Track& track) const;
+public:
+	explicit ObjectTracker(const TrackerParams& params);
+
+	/*
+	 * The detector ran on the frame taken at timestampNs
+	 */
+	void update(const std::vector<Detection>& detections, uint64_t timestampNs);
+
+	/*
+	 * The detector skipped the frame taken at timestampNs
+	 */
+	void predict(uint64_t timestampNs);
+
+	/*
+	 * Confirmed tracks at their current predicted box, including the ones that missed up to
+	 * maxMissed detector runs
+	 */
+	void getObjects(std::vector<Detection>& objects) const;
+
+	/*
+	 * Frames until the next detector run: maxInterval for a still scene, fewer the faster
+	 * the tracked objects move relative to their size, 1 at most every frame
+	 */
+	int detectionInterval() const;
+
+	size_t trackCount() const;
+};
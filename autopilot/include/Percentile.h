@@ -0,0 +1,23 @@
+/*
+ * Percentile.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/*
+ * Nearest rank percentile of sorted samples, p in [0, 1]: the smallest sample with at
+ * least p of the samples at or below it. The samples must not be empty.
+ */
+template <typename T>
+T nearestRank(const std::vector<T>& sorted, double p)
+{
+	const double rank = std::ceil(p * sorted.size());
+	return sorted[std::min(sorted.size(), (size_t)std::max(1.0, rank)) - 1];
+}
@@ -0,0 +1,183 @@
+/*
+ * Replay.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "Replay.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <samples/slog.hpp>
+
+DriveLogSource::DriveLogSource(const std::string& path, bool realtime):
+	reader(path),
+	path(path),
+	refIndex(0),
+	realtime(realtime),
+	firstNs(0),
+	frames(0),
+	timestampNs(0),
+	frameId(0)
+{
+	if (!reader.hasIndex())
+		slog::warn << "Drive log " << path << " was not closed, replaying up to its last complete chunk" << slog::endl;
+	else if (reader.droppedRecords() != 0)
+		slog::warn << "Drive log " << path << " dropped " << reader.droppedRecords()
+		           << " records while recording, the replay misses them" << slog::endl;
+	if (!nextFrame(first, timestampNs, frameId))
+		throw std::logic_error("Drive log " + path + " holds no frames");
+	frameSize = first.size();
+}
+
+bool DriveLogSource::nextFrame(cv::Mat& frame, uint64_t& recordedNs, uint64_t& recordedId)
+{
+	DriveLogRecord record;
+	while (reader.next(record))
+	{
+		uint64_t index = 0;
+		if (record.type == DriveLogType::Source)
+		{
+			recordedSource = DriveLogReader::decodeSource(record);
+			continue;
+		}
+		if (record.type == DriveLogType::Frame)
+			frame = DriveLogReader::decodeFrame(record);
+		else if (DriveLogReader::decodeFrameRef(record, index))
+		{
+			if (!readRef(index, frame))
+				return false;
+		}
+		else
+			continue;
+
+		if (frame.empty())
+		{
+			slog::warn << "Drive log " << path << ": skipping frame " << record.frameId << ", cannot decode it" << slog::endl;
+			continue;
+		}
+		recordedNs = record.timestampNs;
+		recordedId = record.frameId;
+		return true;
+	}
+	return false;
+}
+
+bool DriveLogSource::readRef(uint64_t index, cv::Mat& frame)
+{
+	if (!refSource)
+	{
+		if (recordedSource.empty() || recordedSource == "cam")
+			throw std::logic_error("Drive log " + path + " references frames of \"" + recordedSource +
+			                       "\", record it with -log_frames jpeg to replay it");
+		refSource = createFrameSource(recordedSource);
+	}
+	if (index < refIndex)
+	{
+		slog::warn << "Drive log " << path << ": frame " << index << " of " << recordedSource
+		           << " is out of order, stopping" << slog::endl;
+		return false;
+	}
+
+	// Frames the recording dropped are read and thrown away; the source skips the ones it
+	// cannot read and reports where the frame it returned really is
+	while (refSource->read(frame))
+	{
+		refIndex = refSource->lastIndex() + 1;
+		if (refIndex > index)
+		{
+			if (refIndex == index + 1)
+				return true;
+			slog::warn << "Drive log " << path << ": frame " << index << " of " << recordedSource
+			           << " cannot be read, stopping" << slog::endl;
+			return false;
+		}
+	}
+	return false;
+}
+
+bool DriveLogSource::read(cv::Mat& frame)
+{
+	if (!first.empty())
+	{
+		frame = first;
+		first.release();
+	}
+	else if (!nextFrame(frame, timestampNs, frameId))
+		return false;
+
+	if (frames++ == 0)
+	{
+		start = std::chrono::steady_clock::now();
+		firstNs = timestampNs;
+	}
+	else if (realtime && timestampNs > firstNs)
+		std::this_thread::sleep_until(start + std::chrono::nanoseconds(timestampNs - firstNs));
+	return true;
+}
+
+uint64_t DriveLogSource::lastIndex() const
+{
+	return frames - 1;
+}
+
+size_t DriveLogSource::width() const
+{
+	return frameSize.width;
+}
+
+size_t DriveLogSource::height() const
+{
+	return frameSize.height;
+}
+
+std::string DriveLogSource::name() const
+{
+	return "replay of " + path;
+}
+
+uint64_t DriveLogSource::lastTimestampNs() const
+{
+	return timestampNs;
+}
+
+uint64_t DriveLogSource::lastFrameId() const
+{
+	return frameId;
+}
+
+uint64_t DriveLogSource::framesRead() const
+{
+	return frames;
+}
+
+int LockStep::addStage(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	Stage stage;
+	stage.name = name;
+	stage.done = 0;
+	stages.push_back(stage);
+	return stages.size() - 1;
+}
+
+void LockStep::finish(int stage, uint64_t step)
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		stages[stage].done = std::max(stages[stage].done, step);
+	}
+	progressed.notify_all();
+}
+
+bool LockStep::waitFor(int stage, uint64_t step, std::chrono::milliseconds timeout)
+{
+	std::unique_lock<std::mutex> lock(mtx);
+	return progressed.wait_for(lock, timeout, [&]() { return stages[stage].done >= step; });
+}
+
+const std::string& LockStep::name(int stage) const
+{
+	return stages[stage].name;
+}
@@ -0,0 +1,98 @@
+/*
+ * Replay.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "DriveLog.h"
+#include "FrameSource.h"
+
+/*
+ * Frames of a drive log, decoded from the recorded JPEGs or, for logs recorded with
+ * -log_frames ref, read again from the recorded source. With realtime the frames are
+ * returned with the recorded gaps between them, otherwise as fast as they are asked for.
+ */
+class DriveLogSource : public FrameSource
+{
+private:
+	DriveLogReader reader;
+	std::string path;
+	std::string recordedSource;
+	std::unique_ptr<FrameSource> refSource;    // opened at the first frame reference
+	uint64_t refIndex;                         // index of the next frame of refSource
+	bool realtime;
+
+	cv::Mat first;                             // read by the constructor for the frame size
+	cv::Size frameSize;
+	uint64_t firstNs;
+	std::chrono::steady_clock::time_point start;
+	uint64_t frames;
+	uint64_t timestampNs;
+	uint64_t frameId;
+
+	bool nextFrame(cv::Mat& frame, uint64_t& recordedNs, uint64_t& recordedId);
+	bool readRef(uint64_t index, cv::Mat& frame);
+public:
+	/*
+	 * Throws std::logic_error if the log cannot be read or holds no frames
+	 */
+	DriveLogSource(const std::string& path, bool realtime);
+
+	bool read(cv::Mat& frame) override;
+	// Frames of the log returned so far, minus one
+	uint64_t lastIndex() const override;
+	size_t width() const override;
+	size_t height() const override;
+	std::string name() const override;
+
+	// Recorded capture time and frame id of the frame returned by the last read()
+	uint64_t lastTimestampNs() const;
+	uint64_t lastFrameId() const;
+	uint64_t framesRead() const;
+};
+
+/*
+ * Runs the pipeline threads in lock step while replaying: the capture thread hands a frame
+ * to every stage, waits until each of them finished it and only then moves to the next one,
+ * so every stage sees every frame exactly once and in the same order on every run.
+ */
+class LockStep
+{
+private:
+	struct Stage
+	{
+		std::string name;
+		uint64_t done;
+	};
+
+	std::mutex mtx;
+	std::condition_variable progressed;
+	std::vector<Stage> stages;
+public:
+	/*
+	 * Returns the id of the stage, all stages are added before the threads start
+	 */
+	int addStage(const std::string& name);
+
+	/*
+	 * The stage is done with everything up to step, a frame id or a control version
+	 */
+	void finish(int stage, uint64_t step);
+
+	/*
+	 * Blocks until the stage finished step. Returns false on timeout.
+	 */
+	bool waitFor(int stage, uint64_t step, std::chrono::milliseconds timeout);
+
+	const std::string& name(int stage) const;
+};
@@ -0,0 +1,172 @@
+/*
+ * SSDDetector.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "SSDDetector.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <samples/ocv_common.hpp>
+#include <samples/slog.hpp>
+
+using namespace InferenceEngine;
+
+SSDDetector::SSDDetector(const SSDParams& params):
+	params(params),
+	maxProposalCount(0),
+	objectSize(0)
+{
+	// --------------------------- 1. Load Plugin for inference engine -------------------------------------
+	slog::info << "Loading plugin for " << params.device << slog::endl;
+	plugin = PluginDispatcher().getPluginByDevice(params.device);
+	std::ostringstream version;
+	printPluginVersion(plugin, version);
+	pluginVersion = version.str();
+	slog::info << pluginVersion << slog::endl;
+
+	// --------------------------- 2. Read IR Generated by ModelOptimizer (.xml and .bin files) ------------
+	slog::info << "Loading network files " << params.model << slog::endl;
+	CNNNetReader netReader;
+	netReader.ReadNetwork(params.model);
+	netReader.getNetwork().setBatchSize(std::max<size_t>(1, params.regions.size()));
+	netReader.ReadWeights(fileNameNoExt(params.model) + ".bin");
+
+	std::ifstream labelsFile(fileNameNoExt(params.model) + ".labels");
+	std::copy(std::istream_iterator<std::string>(labelsFile),
+	          std::istream_iterator<std::string>(),
+	          std::back_inserter(labels));
+
+	// --------------------------- 3. Configure input & output ---------------------------------------------
+	/** SSD-based network should have one input and one output **/
+	InputsDataMap inputInfo(netReader.getNetwork().getInputsInfo());
+	if (inputInfo.size() != 1)
+		throw std::logic_error("This app accepts networks having only one input");
+	InputInfo::Ptr& input = inputInfo.begin()->second;
+	inputName = inputInfo.begin()->first;
+	input->setPrecision(Precision::U8);
+	input->getInputData()->setLayout(Layout::NCHW);
+
+	OutputsDataMap outputInfo(netReader.getNetwork().getOutputsInfo());
+	if (outputInfo.size() != 1)
+		throw std::logic_error("This app accepts networks having only one output");
+	DataPtr& output = outputInfo.begin()->second;
+	outputName = outputInfo.begin()->first;
+
+	const int numClasses = netReader.getNetwork().getLayerByName(outputName.c_str())->GetParamAsInt("num_classes");
+	if (static_cast<int>(labels.size()) != numClasses)
+	{
+		if (static_cast<int>(labels.size()) == (numClasses - 1))  // if network assumes default "background" class, having no label
+			labels.insert(labels.begin(), "fake");
+		else
+			labels.clear();
+	}
+	objectClasses = objectClassesFromLabels(labels);
+
+	const SizeVector outputDims = output->getTensorDesc().getDims();
+	if (outputDims.size() != 4)
+		throw std::logic_error("Incorrect output dimensions for SSD");
+	maxProposalCount = outputDims[2];
+	objectSize = outputDims[3];
+	if (objectSize != 7)
+		throw std::logic_error("Output should have 7 as a last dimension");
+	output->setPrecision(Precision::FP32);
+	output->setLayout(Layout::NCHW);
+	decoder.reset(new DetectionDecoder(maxProposalCount, params.threshold, objectClasses));
+
+	// --------------------------- 4. Loading model to the plugin ------------------------------------------
+	std::map<std::string, std::string> config;
+	if (params.device == "CPU" && params.nthreads > 0)
+		config[PluginConfigParams::KEY_CPU_THREADS_NUM] = std::to_string(params.nthreads);
+	if (params.perfCounts)
+		config[PluginConfigParams::KEY_PERF_COUNT] = PluginConfigParams::YES;
+	network = plugin.LoadNetwork(netReader.getNetwork(), config);
+
+	// --------------------------- 5. Create infer request -------------------------------------------------
+	request = network.CreateInferRequestPtr();
+}
+
+void SSDDetector::preprocess(const cv::Mat& frame)
+{
+	/* Resize and copy data from the image to the input blob */
+	Blob::Ptr frameBlob = request->GetBlob(inputName);
+	if (params.regions.empty())
+	{
+		matU8ToBlob<uint8_t>(frame, frameBlob);
+		return;
+	}
+
+	const cv::Rect bounds(0, 0, frame.cols, frame.rows);
+	for (size_t i = 0; i < params.regions.size(); ++i)
+	{
+		const Region& region = params.regions[i];
+		const cv::Rect crop = cv::Rect(region.x * frame.cols, region.y * frame.rows,
+		                               region.width * frame.cols, region.height * frame.rows) & bounds;
+		matU8ToBlob<uint8_t>(frame(crop), frameBlob, i);
+	}
+}
+
+bool SSDDetector::infer()
+{
+	request->StartAsync();
+	return OK == request->Wait(IInferRequest::WaitMode::RESULT_READY);
+}
+
+void SSDDetector::decode(size_t frameWidth, size_t frameHeight, DetectionSet& detections)
+{
+	const float *proposals = request->GetBlob(outputName)->buffer().as<PrecisionTrait<Precision::FP32>::value_type*>();
+	decoder->decode(proposals, frameWidth, frameHeight, params.regions, detections.objects);
+	if (params.nmsIou > 0)
+		suppressDuplicates(detections.objects, params.nmsIou);
+}
+
+std::string SSDDetector::labelName(int label) const
+{
+	return static_cast<size_t>(label) < labels.size() ?
+	       labels[label] : std::string("label #") + std::to_string(label);
+}
+
+int SSDDetector::labelId(const std::string& name) const
+{
+	auto found = std::find(labels.begin(), labels.end(), name);
+	return found == labels.end() ? -1 : (int)(found - labels.begin());
+}
+
+size_t SSDDetector::labelCount() const
+{
+	return labels.size();
+}
+
+const std::string& SSDDetector::getDevice() const
+{
+	return params.device;
+}
+
+const std::string& SSDDetector::getPluginVersion() const
+{
+	return pluginVersion;
+}
+
+std::map<std::string, InferenceEngineProfileInfo> SSDDetector::getPerformanceCounts() const
+{
+	if (!params.perfCounts)
+		return std::map<std::string, InferenceEngineProfileInfo>();
+	return request->GetPerformanceCounts();
+}
+
+void drawDetections(cv::Mat& frame, const DetectionSet& detections, const SSDDetector& detector)
+{
+	for (auto& object : detections.objects)
+	{
+		std::ostringstream conf;
+		conf << ":" << std::fixed << std::setprecision(3) << object.confidence;
+		cv::putText(frame, detector.labelName(object.label) + conf.str(),
+		            cv::Point2f(object.xmin, object.ymin - 5), cv::FONT_HERSHEY_COMPLEX_SMALL, 1,
+		            cv::Scalar(0, 0, 255));
+		cv::rectangle(frame, cv::Point2f(object.xmin, object.ymin), cv::Point2f(object.xmax, object.ymax),
+		              cv::Scalar(0, 0, 255));
+	}
+}
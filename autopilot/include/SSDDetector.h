@@ -0,0 +1,85 @@
+/*
+ * SSDDetector.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <inference_engine.hpp>
+#include <map>
+#include <memory>
+#include <opencv2/core/core.hpp>
+#include <string>
+#include <vector>
+#include "Detection.h"
+#include "DetectionDecoder.h"
+
+struct SSDParams
+{
+	std::string model;             // path to the IR .xml, weights and labels sit next to it
+	std::string device = "CPU";
+	float threshold = 0.5f;
+	uint32_t nthreads = 0;         // CPU plugin threads, 0 - plugin default
+	float nmsIou = 0.0f;           // class aware NMS after decoding, 0 - off
+	std::vector<Region> regions;   // one batch item per region, empty - the whole frame
+	bool perfCounts = false;       // per-layer performance counters, they slow inference down a little
+};
+
+/*
+ * One SSD network on one device with a single infer request. Inference is split in
+ * preprocess/infer/decode so callers can time and overlap the steps.
+ */
+class SSDDetector
+{
+private:
+	SSDParams params;
+	InferenceEngine::InferencePlugin plugin;
+	InferenceEngine::ExecutableNetwork network;
+	InferenceEngine::InferRequest::Ptr request;
+	std::string inputName, outputName;
+	int maxProposalCount;
+	int objectSize;
+	std::vector<std::string> labels;
+	std::vector<ObjectClass> objectClasses;
+	std::unique_ptr<DetectionDecoder> decoder;
+	std::string pluginVersion;
+public:
+	/*
+	 * Loads the network to the plugin, throws std::logic_error if it is not an SSD
+	 */
+	explicit SSDDetector(const SSDParams& params);
+
+	/*
+	 * Resizes and copies frame, or each region of it into its batch item, into the input blob
+	 */
+	void preprocess(const cv::Mat& frame);
+
+	/*
+	 * Runs the request and waits for it, false if the plugin reported an error
+	 */
+	bool infer();
+
+	/*
+	 * Appends the detections above the threshold in frameWidth x frameHeight pixel coordinates,
+	 * then suppresses duplicates among all of them if nmsIou is set
+	 */
+	void decode(size_t frameWidth, size_t frameHeight, DetectionSet& detections);
+
+	std::string labelName(int label) const;
+	// -1 if the model has no such label
+	int labelId(const std::string& name) const;
+	size_t labelCount() const;
+	const std::string& getDevice() const;
+	const std::string& getPluginVersion() const;
+	/*
+	 * Per-layer counters of the last inference, empty unless perfCounts was set
+	 */
+	std::map<std::string, InferenceEngine::InferenceEngineProfileInfo> getPerformanceCounts() const;
+};
+
+/*
+ * Draws boxes and "label:confidence" captions
+ */
+void drawDetections(cv::Mat& frame, const DetectionSet& detections, const SSDDetector& detector);
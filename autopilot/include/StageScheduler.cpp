@@ -0,0 +1,129 @@
+/*
+ * StageScheduler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "StageScheduler.h"
+
+#include <iomanip>
+#include <sstream>
+#include <samples/slog.hpp>
+
+// A stage below this fraction of its deadline has room to spare
+static constexpr float relaxedLoad = 0.7f;
+// Weight of the newest cost sample
+static constexpr float costSmoothing = 0.2f;
+
+StageScheduler::StageScheduler(std::chrono::milliseconds adjustmentPeriod):
+	lastAdjustment(Clock::now()),
+	adjustmentPeriod(adjustmentPeriod)
+{
+}
+
+int StageScheduler::addStage(const StageConfig& config)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	stages.push_back(Stage{config, 0, 1, 0, 0, 0});
+	return stages.size() - 1;
+}
+
+bool StageScheduler::admit(int stage)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	Stage& s = stages[stage];
+	if (++s.framesSinceRun < s.decimation)
+	{
+		s.skips++;
+		return false;
+	}
+	s.framesSinceRun = 0;
+	s.runs++;
+	return true;
+}
+
+void StageScheduler::finish(int stage, float costMs)
+{
+	std::string warning, notice;
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		Stage& s = stages[stage];
+		s.costMs = s.costMs == 0 ? costMs : (1 - costSmoothing) * s.costMs + costSmoothing * costMs;
+
+		if (Clock::now() - lastAdjustment >= adjustmentPeriod)
+		{
+			adjust(warning, notice);
+			lastAdjustment = Clock::now();
+		}
+	}
+
+	// The other stages keep calling admit() while this is written out
+	if (!warning.empty())
+		slog::warn << warning << slog::endl;
+	if (!notice.empty())
+		slog::info << notice << slog::endl;
+}
+
+void StageScheduler::adjust(std::string& warning, std::string& notice)
+{
+	// The most important stage running over its deadline sheds the least important work below it
+	const Stage* overloaded = nullptr;
+	bool relaxed = true;
+	for (const Stage& s : stages)
+	{
+		if (s.costMs > s.config.deadlineMs && (overloaded == nullptr || s.config.priority < overloaded->config.priority))
+			overloaded = &s;
+		if (s.costMs > relaxedLoad * s.config.deadlineMs)
+			relaxed = false;
+	}
+
+	if (overloaded != nullptr)
+	{
+		Stage* victim = nullptr;
+		for (Stage& s : stages)
+			if (s.config.priority > overloaded->config.priority && s.decimation < s.config.maxDecimation &&
+			    (victim == nullptr || s.config.priority > victim->config.priority))
+				victim = &s;
+		if (victim != nullptr)
+		{
+			victim->decimation++;
+			std::ostringstream out;
+			out << "Scheduler: " << overloaded->config.name << " takes " << std::fixed << std::setprecision(1)
+			    << overloaded->costMs << " ms of " << overloaded->config.deadlineMs << ", "
+			    << victim->config.name << " runs on 1 in " << victim->decimation << " frames";
+			warning = out.str();
+		}
+		return;
+	}
+
+	if (relaxed)
+	{
+		Stage* restored = nullptr;
+		for (Stage& s : stages)
+			if (s.decimation > 1 && (restored == nullptr || s.config.priority < restored->config.priority))
+				restored = &s;
+		if (restored != nullptr)
+		{
+			restored->decimation--;
+			notice = "Scheduler: load is down, " + restored->config.name + " runs on 1 in " +
+			         std::to_string(restored->decimation) + " frames";
+		}
+	}
+}
+
+int StageScheduler::getDecimation(int stage)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	return stages[stage].decimation;
+}
+
+std::string StageScheduler::summary()
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(1);
+	for (const Stage& s : stages)
+		out << s.config.name << ": " << s.costMs << " ms of " << s.config.deadlineMs << ", 1 in "
+		    << s.decimation << " frames, " << s.runs << " runs, " << s.skips << " skips" << std::endl;
+	return out.str();
+}
@@ -0,0 +1,83 @@
+/*
+ * StageScheduler.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct StageConfig
+{
+	std::string name;
+	int priority;              // 0 is the most important
+	float deadlineMs;          // the stage is overloaded when one run takes longer
+	int maxDecimation;         // the stage runs on at least every maxDecimation-th frame
+
+	StageConfig(const std::string& name, int priority, float deadlineMs, int maxDecimation = 8):
+		name(name), priority(priority), deadlineMs(deadlineMs), maxDecimation(maxDecimation)
+	{
+	}
+};
+
+/*
+ * Load shedding across the pipeline stages. Every stage asks admit() before it works on a
+ * frame and reports its cost with finish(). While a stage runs over its deadline the
+ * lowest priority stage below it is decimated one step further (runs on every 2nd, 3rd,
+ * ... frame); once every stage is comfortably within its deadline the most important
+ * decimated stage gets one step back.
+ */
+class StageScheduler
+{
+private:
+	struct Stage
+	{
+		StageConfig config;
+		float costMs;              // smoothed
+		int decimation;
+		int framesSinceRun;
+		uint64_t runs, skips;
+	};
+
+	typedef std::chrono::steady_clock Clock;
+
+	std::mutex mtx;
+	std::vector<Stage> stages;
+	Clock::time_point lastAdjustment;
+	std::chrono::milliseconds adjustmentPeriod;
+
+	/*
+	 * Called with mtx held, describes the change in warning (a stage decimated) or notice (a
+	 * stage restored) for the caller to log once the lock is released
+	 */
+	void adjust(std::string& warning, std::string& notice);
+public:
+	explicit StageScheduler(std::chrono::milliseconds adjustmentPeriod = std::chrono::milliseconds(500));
+
+	/*
+	 * Registers a stage before the stage threads start, returns its id
+	 */
+	int addStage(const StageConfig& config);
+
+	/*
+	 * Called for every new frame a stage could process, false if the stage should skip it
+	 */
+	bool admit(int stage);
+
+	/*
+	 * The stage processed a frame in costMs
+	 */
+	void finish(int stage, float costMs);
+
+	int getDecimation(int stage);
+
+	/*
+	 * One line per stage: cost, decimation, runs and skips
+	 */
+	std::string summary();
+};
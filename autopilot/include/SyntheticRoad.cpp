@@ -0,0 +1,75 @@
+/*
+ * SyntheticRoad.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "SyntheticRoad.h"
+
+#include <algorithm>
+#include <cmath>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <vector>
+
+// 0 at the bottom row, 1 at the horizon
+static float depthAt(const RoadParams& params, float y)
+{
+	const float horizonY = params.horizon * params.height;
+	return std::max(0.0f, std::min(1.0f, (params.height - 1 - y) / (params.height - 1 - horizonY)));
+}
+
+float roadCenterAt(const RoadParams& params, float y)
+{
+	const float t = depthAt(params, y);
+	return params.width * (0.5f + params.offset + params.curvature * t * t);
+}
+
+cv::Mat renderRoad(const RoadParams& params)
+{
+	cv::Mat image(params.height, params.width, CV_8UC3, cv::Scalar(70, 70, 70));
+	const int horizonY = params.horizon * params.height;
+	image(cv::Rect(0, 0, params.width, horizonY)).setTo(cv::Scalar(200, 170, 140));
+
+	const int thickness = params.lineThickness > 0 ? params.lineThickness : std::max(1, params.width / 64);
+	std::vector<cv::Point> left, right;
+	for (int y = params.height - 1; y >= horizonY; y -= 2)
+	{
+		// markings converge to 10% of their bottom distance at the horizon
+		const float halfWidth = params.width * params.laneWidth / 2 * (1 - 0.9f * depthAt(params, y));
+		const float center = roadCenterAt(params, y);
+		left.push_back(cv::Point(center - halfWidth, y));
+		right.push_back(cv::Point(center + halfWidth, y));
+	}
+
+	// thinner further away
+	for (size_t i = 1; i < left.size(); ++i)
+	{
+		const float depth = depthAt(params, left[i].y);
+		if (params.dashLength > 0 && std::fmod(depth / params.dashLength, 2.0f) >= 1)
+			continue;
+		const int segmentThickness = std::max(1, (int)(thickness * (1 - 0.8f * depth)));
+		cv::line(image, left[i - 1], left[i], cv::Scalar(255, 255, 255), segmentThickness);
+		cv::line(image, right[i - 1], right[i], cv::Scalar(255, 255, 255), segmentThickness);
+	}
+
+	cv::RNG rng(params.seed);
+	for (int i = 0; i < params.occlusions && !left.empty(); ++i)
+	{
+		// over either marking, somewhere on the nearer two thirds of the road
+		const std::vector<cv::Point>& marking = rng.uniform(0, 2) ? right : left;
+		const cv::Point at = marking[rng.uniform(0, (int)(marking.size() * 2 / 3) + 1)];
+		const int w = params.width / 8, h = params.height / 12;
+		cv::rectangle(image, cv::Rect(at.x - w / 2, at.y - h / 2, w, h), cv::Scalar(70, 70, 70), cv::FILLED);
+	}
+
+	if (params.noise > 0)
+	{
+		cv::Mat noise(image.size(), CV_16SC3);
+		rng.fill(noise, cv::RNG::NORMAL, 0, params.noise);
+		cv::Mat noisy;
+		image.convertTo(noisy, CV_16SC3);
+		noisy += noise;
+		noisy.convertTo(image, CV_8UC3);
+	}
+	return image;
+}
@@ -0,0 +1,37 @@
+/*
+ * SyntheticRoad.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <opencv2/core/core.hpp>
+#include <stdint.h>
+
+/*
+ * A camera view of a two lane road: dark asphalt, two white markings converging towards
+ * the horizon, bending by curvature and shifted by offset
+ */
+struct RoadParams
+{
+	int width = 640;
+	int height = 480;
+	float horizon = 0.45f;        // horizon height, fraction of the image height
+	float laneWidth = 0.6f;       // distance between the markings at the bottom, fraction of width
+	float curvature = 0.0f;       // lateral shift of the lane at the horizon, fraction of width, + is right
+	float offset = 0.0f;          // lateral shift of the whole lane, fraction of width, + is right
+	int lineThickness = 0;        // at the bottom, 0 - width / 64
+	float dashLength = 0.0f;      // length of a dash and of a gap, fraction of the road depth, 0 - solid
+	int occlusions = 0;           // asphalt patches over the markings, shadows or cars hiding them
+	float noise = 0.0f;           // gaussian noise stddev in gray levels
+	uint32_t seed = 1;
+};
+
+cv::Mat renderRoad(const RoadParams& params);
+
+/*
+ * Lane center x in pixels at image row y, the ground truth renderRoad() draws
+ */
+float roadCenterAt(const RoadParams& params, float y);
@@ -0,0 +1,254 @@
+/*
+ * VehicleLink.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "VehicleLink.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/i2c-dev.h>
+#include <stdexcept>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <samples/slog.hpp>
+
+static uint64_t linkNowNs()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * I2CLink
+ */
+I2CLink::I2CLink(const std::string& device, uint8_t address):
+	device(device),
+	address(address),
+	fd(-1)
+{
+}
+
+I2CLink::~I2CLink()
+{
+	if (fd >= 0)
+		close(fd);
+}
+
+bool I2CLink::open()
+{
+	slog::info << "I2C: Connecting to " << device << slog::endl;
+
+	if ((fd = ::open(device.c_str(), O_RDWR)) < 0)
+	{
+		slog::err << "I2C: Failed to access " << device << ": " << strerror(errno) << slog::endl;
+		return false;
+	}
+
+	slog::info << "I2C: acquiring buss to " << std::hex << (int)address << slog::endl;
+
+	if (ioctl(fd, I2C_SLAVE, address) < 0)
+	{
+		slog::err << "I2C: Failed to acquire bus access/talk to slave " << std::hex << (int)address << slog::endl;
+		close(fd);
+		fd = -1;
+		return false;
+	}
+	return true;
+}
+
+bool I2CLink::send(const VehicleCommand& command)
+{
+	uint8_t frame[VehicleProtocol::frameSize];
+	VehicleProtocol::encode(command, frame);
+	return write(fd, frame, sizeof(frame)) == (ssize_t)sizeof(frame);
+}
+
+std::string I2CLink::name() const
+{
+	return "i2c:" + device;
+}
+
+/*
+ * SimulatedLink
+ */
+SimulatedLink::SimulatedLink(uint32_t busDelayUs):
+	busDelayUs(busDelayUs),
+	running(false),
+	received(0),
+	decodeErrors(0)
+{
+	fds[0] = fds[1] = -1;
+}
+
+SimulatedLink::~SimulatedLink()
+{
+	running = false;
+	if (fds[0] >= 0)
+		shutdown(fds[0], SHUT_RDWR);
+	if (endpoint.joinable())
+		endpoint.join();
+	for (int fd : fds)
+		if (fd >= 0)
+			close(fd);
+}
+
+bool SimulatedLink::open()
+{
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) < 0)
+	{
+		slog::err << "SimulatedLink: socketpair failed: " << strerror(errno) << slog::endl;
+		return false;
+	}
+	running = true;
+	endpoint = std::thread(&SimulatedLink::serve, this);
+	slog::info << "SimulatedLink: vehicle endpoint started, bus delay " << busDelayUs << " us" << slog::endl;
+	return true;
+}
+
+bool SimulatedLink::send(const VehicleCommand& command)
+{
+	uint8_t message[sizeof(uint64_t) + VehicleProtocol::frameSize];
+	uint64_t now = linkNowNs();
+	memcpy(message, &now, sizeof(now));
+	VehicleProtocol::encode(command, message + sizeof(now));
+	return ::send(fds[0], message, sizeof(message), MSG_NOSIGNAL) == (ssize_t)sizeof(message);
+}
+
+void SimulatedLink::serve()
+{
+	uint8_t message[64];
+	while (running)
+	{
+		ssize_t size = recv(fds[1], message, sizeof(message), 0);
+		if (size <= 0)
+			break;
+
+		if (busDelayUs != 0)
+			usleep(busDelayUs);
+
+		uint64_t sent;
+		VehicleCommand command;
+		bool valid = size >= (ssize_t)sizeof(sent) &&
+			VehicleProtocol::decode(message + sizeof(sent), size - sizeof(sent), command);
+
+		std::lock_guard<std::mutex> lock(stateMtx);
+		if (!valid)
+		{
+			decodeErrors++;
+			continue;
+		}
+		memcpy(&sent, message, sizeof(sent));
+		latency.add((linkNowNs() - sent) / 1000.0);
+		lastCommand = command;
+		received++;
+	}
+}
+
+std::string SimulatedLink::name() const
+{
+	return "sim";
+}
+
+VehicleCommand SimulatedLink::getLastCommand()
+{
+	std::lock_guard<std::mutex> lock(stateMtx);
+	return lastCommand;
+}
+
+uint64_t SimulatedLink::getReceived()
+{
+	std::lock_guard<std::mutex> lock(stateMtx);
+	return received;
+}
+
+uint64_t SimulatedLink::getDecodeErrors()
+{
+	std::lock_guard<std::mutex> lock(stateMtx);
+	return decodeErrors;
+}
+
+JitterStats SimulatedLink::getLatencyStats()
+{
+	std::lock_guard<std::mutex> lock(stateMtx);
+	return latency;
+}
+
+/*
+ * RecordLink
+ */
+RecordLink::RecordLink(const std::string& path):
+	path(path),
+	file(nullptr)
+{
+}
+
+RecordLink::~RecordLink()
+{
+	if (file != nullptr)
+		fclose(file);
+}
+
+bool RecordLink::open()
+{
+	file = fopen(path.c_str(), "ab");
+	if (file == nullptr)
+	{
+		slog::err << "RecordLink: cannot open " << path << ": " << strerror(errno) << slog::endl;
+		return false;
+	}
+	return true;
+}
+
+bool RecordLink::send(const VehicleCommand& command)
+{
+	uint8_t record[sizeof(uint64_t) + VehicleProtocol::frameSize];
+	uint64_t now = linkNowNs();
+	memcpy(record, &now, sizeof(now));
+	VehicleProtocol::encode(command, record + sizeof(now));
+	return fwrite(record, sizeof(record), 1, file) == 1;
+}
+
+std::string RecordLink::name() const
+{
+	return "record:" + path;
+}
+
+std::vector<RecordLink::Record> RecordLink::readAll(const std::string& path)
+{
+	std::vector<Record> records;
+	FILE* input = fopen(path.c_str(), "rb");
+	if (input == nullptr)
+		return records;
+
+	uint8_t raw[sizeof(uint64_t) + VehicleProtocol::frameSize];
+	while (fread(raw, sizeof(raw), 1, input) == 1)
+	{
+		Record record;
+		memcpy(&record.timestampNs, raw, sizeof(record.timestampNs));
+		if (VehicleProtocol::decode(raw + sizeof(uint64_t), VehicleProtocol::frameSize, record.command))
+			records.push_back(record);
+	}
+	fclose(input);
+	return records;
+}
+
+std::unique_ptr<VehicleLink> createVehicleLink(const std::string& spec)
+{
+	std::string type = spec.substr(0, spec.find(':'));
+	std::string argument = spec.find(':') == std::string::npos ? "" : spec.substr(spec.find(':') + 1);
+
+	if (type == "i2c")
+		return std::unique_ptr<VehicleLink>(new I2CLink(argument.empty() ? "/dev/i2c-1" : argument));
+	if (type == "sim")
+		return std::unique_ptr<VehicleLink>(new SimulatedLink());
+	if (type == "record")
+		return std::unique_ptr<VehicleLink>(new RecordLink(argument.empty() ? "commands.bin" : argument));
+
+	throw std::logic_error("Unknown vehicle link: " + spec);
+}
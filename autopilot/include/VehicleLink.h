@@ -0,0 +1,117 @@
+/*
+ * VehicleLink.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ActuatorLoop.h"
+#include "VehicleProtocol.h"
+
+/*
+ * Transport carrying VehicleCommand frames to the actuators.
+ * open() reports failure instead of exiting so the caller can fall back to another link.
+ */
+class VehicleLink
+{
+public:
+	virtual ~VehicleLink() {}
+
+	virtual bool open() = 0;
+	virtual bool send(const VehicleCommand& command) = 0;
+	virtual std::string name() const = 0;
+};
+
+/*
+ * The Arduino slave on the I2C bus
+ */
+class I2CLink : public VehicleLink
+{
+private:
+	std::string device;
+	uint8_t address;
+	int fd;
+public:
+	I2CLink(const std::string& device, uint8_t address = ADDRESS);
+	virtual ~I2CLink();
+
+	bool open() override;
+	bool send(const VehicleCommand& command) override;
+	std::string name() const override;
+};
+
+/*
+ * In-process vehicle endpoint behind a UNIX SOCK_SEQPACKET socket pair. Every message carries
+ * its send timestamp, the endpoint thread decodes the frame with VehicleProtocol, optionally
+ * holds it for the emulated bus time and records the send to apply latency.
+ */
+class SimulatedLink : public VehicleLink
+{
+private:
+	int fds[2];
+	uint32_t busDelayUs;
+	std::atomic<bool> running;
+	std::thread endpoint;
+
+	std::mutex stateMtx;
+	VehicleCommand lastCommand;
+	uint64_t received;
+	uint64_t decodeErrors;
+	JitterStats latency;
+
+	void serve();
+public:
+	// 6 frame bytes plus the address byte, 9 clocks each on a 100 kHz bus
+	static constexpr uint32_t defaultBusDelayUs = 630;
+
+	explicit SimulatedLink(uint32_t busDelayUs = defaultBusDelayUs);
+	virtual ~SimulatedLink();
+
+	bool open() override;
+	bool send(const VehicleCommand& command) override;
+	std::string name() const override;
+
+	VehicleCommand getLastCommand();
+	uint64_t getReceived();
+	uint64_t getDecodeErrors();
+	JitterStats getLatencyStats();
+};
+
+/*
+ * Appends every frame to a file as [uint64 CLOCK_MONOTONIC ns][VehicleProtocol frame]
+ */
+class RecordLink : public VehicleLink
+{
+private:
+	std::string path;
+	FILE* file;
+public:
+	struct Record
+	{
+		uint64_t timestampNs;
+		VehicleCommand command;
+	};
+
+	explicit RecordLink(const std::string& path);
+	virtual ~RecordLink();
+
+	bool open() override;
+	bool send(const VehicleCommand& command) override;
+	std::string name() const override;
+
+	static std::vector<Record> readAll(const std::string& path);
+};
+
+/*
+ * spec is "i2c[:device]", "sim" or "record:path"
+ */
+std::unique_ptr<VehicleLink> createVehicleLink(const std::string& spec);
@@ -0,0 +1,39 @@
+/*
+ * VehicleProtocol.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "VehicleProtocol.h"
+
+void VehicleProtocol::encode(const VehicleCommand& command, uint8_t* frame)
+{
+	frame[0] = SPEED_VALUE_FLAG;
+	frame[1] = (uint16_t)command.speed >> 8;
+	frame[2] = (uint16_t)command.speed & 0xFF;
+	frame[3] = DIR_VALUE_FLAG;
+	frame[4] = (uint8_t)command.steer;
+	frame[5] = 0;
+
+	if (command.lightsOn)
+		setBit(frame[5], LIGHTS_BIT);
+	else
+		clearBit(frame[5], LIGHTS_BIT);
+
+	if (command.stopOn)
+		setBit(frame[5], STOP_BIT);
+	else
+		clearBit(frame[5], STOP_BIT);
+}
+
+bool VehicleProtocol::decode(const uint8_t* frame, size_t size, VehicleCommand& command)
+{
+	if (size < frameSize || frame[0] != SPEED_VALUE_FLAG || frame[3] != DIR_VALUE_FLAG)
+		return false;
+
+	command.speed = (int16_t)(((uint16_t)frame[1] << 8) | frame[2]);
+	command.steer = (int8_t)frame[4];
+	command.lightsOn = frame[5] & (1 << LIGHTS_BIT);
+	command.stopOn = frame[5] & (1 << STOP_BIT);
+	return true;
+}
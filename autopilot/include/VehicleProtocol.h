@@ -0,0 +1,51 @@
+/*
+ * VehicleProtocol.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <stdint.h>
+
+#define setBit(a,b) ((a) |= (1ULL<<(b)))
+#define clearBit(a,b) ((a) &= ~(1ULL<<(b)))
+
+#define ADDRESS 			(uint8_t) 0x04
+#define SPEED_VALUE_FLAG 	(uint8_t) 0xA1
+#define DIR_VALUE_FLAG 		(uint8_t) 0xB2
+// Steering value of the wheels pointing straight ahead
+#define STEER_NEUTRAL		(int8_t) 50
+// Servo travel, full left to full right
+#define STEER_MIN			(int8_t) 0
+#define STEER_MAX			(int8_t) 100
+
+#define LIGHTS_BIT			0
+#define STOP_BIT			1
+
+struct VehicleCommand
+{
+	int16_t speed = 0;
+	int8_t steer = STEER_NEUTRAL;
+	bool lightsOn = false;
+	bool stopOn = false;
+};
+
+/*
+ * Wire format understood by the Arduino slave:
+ *   [SPEED_VALUE_FLAG][speed MSB][speed LSB][DIR_VALUE_FLAG][steer][flags]
+ * flags bit LIGHTS_BIT - lights on, bit STOP_BIT - stop lights on
+ */
+namespace VehicleProtocol
+{
+	constexpr size_t frameSize = 6;
+
+	void encode(const VehicleCommand& command, uint8_t* frame);
+
+	/*
+	 * Returns false when the frame is truncated or the markers do not match
+	 */
+	bool decode(const uint8_t* frame, size_t size, VehicleCommand& command);
+}
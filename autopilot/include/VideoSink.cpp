@@ -0,0 +1,229 @@
+/*
+ * VideoSink.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "VideoSink.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <samples/slog.hpp>
+
+static bool isY4m(const std::string& path)
+{
+	return path.size() > 4 && path.compare(path.size() - 4, 4, ".y4m") == 0;
+}
+
+VideoSink::VideoSink(const VideoSinkParams& params, const cv::Size& frameSize):
+	params(params),
+	frameSize(frameSize),
+	queue(params.queueCapacity),
+	y4m(nullptr),
+	submitted(0),
+	dropped(0),
+	encoded(0)
+{
+	if (isY4m(params.path))
+	{
+		// 4:2:0 needs even dimensions
+		this->frameSize = cv::Size(frameSize.width & ~1, frameSize.height & ~1);
+		y4m = fopen(params.path.c_str(), "wb");
+		if (y4m == nullptr)
+			throw std::logic_error("Cannot create video " + params.path + ": " + strerror(errno));
+		if (fprintf(y4m, "YUV4MPEG2 W%d H%d F%ld:1000 Ip A1:1 C420jpeg\n", this->frameSize.width, this->frameSize.height,
+		            std::lround(params.fps * 1000)) < 0)
+		{
+			const std::string error = strerror(errno);
+			fclose(y4m);
+			throw std::logic_error("Cannot write video " + params.path + ": " + error);
+		}
+	}
+	else
+	{
+		const std::string& code = params.fourcc;
+		if (code.size() != 4)
+			throw std::logic_error("Video codec should be a four character code, not \"" + code + "\"");
+		if (!writer.open(params.path, cv::VideoWriter::fourcc(code[0], code[1], code[2], code[3]), params.fps, frameSize, true))
+			throw std::logic_error("Cannot create video " + params.path + " with codec " + code);
+	}
+
+	// Inverse of the bird's eye view of LaneDetector, in the resized frame of the lane stage
+	const float w = (uint16_t)(frameSize.width * params.laneResize);
+	const float h = (uint16_t)(frameSize.height * params.laneResize);
+	const cv::Point2f frameQuad[4] = {cv::Point2f(0, h / params.laneQuadRatio), cv::Point2f(w - 1, h / params.laneQuadRatio),
+	                                  cv::Point2f(w - 1, h - 1), cv::Point2f(0, h - 1)};
+	const cv::Point2f birdsEyeQuad[4] = {cv::Point2f(0, 0), cv::Point2f(w - 1, 0), cv::Point2f(w - 1, h - 1),
+	                                     cv::Point2f(0, h - 1)};
+	birdsEyeToFrame = cv::getPerspectiveTransform(birdsEyeQuad, frameQuad);
+
+	encoder = std::thread(&VideoSink::encodeLoop, this);
+}
+
+VideoSink::~VideoSink()
+{
+	close();
+}
+
+void VideoSink::setLaneCenter(const std::vector<float>& center)
+{
+	std::lock_guard<std::mutex> lock(laneMtx);
+	laneCenter = center;
+}
+
+void VideoSink::submit(uint64_t frameId, const cv::Mat& frame, const WorldSnapshot& world, const ControlState& control)
+{
+	++submitted;
+	Pending pending;
+	pending.frameId = frameId;
+	pending.frame = frame;
+	pending.world = world;
+	pending.control = control;
+	{
+		std::lock_guard<std::mutex> lock(laneMtx);
+		pending.laneCenter = laneCenter;
+	}
+	if (!queue.tryPush(std::move(pending)))
+		++dropped;
+}
+
+void VideoSink::composite(const Pending& pending, cv::Mat& image) const
+{
+	if (pending.frame.size() == frameSize)
+		pending.frame.copyTo(image);
+	else
+		cv::resize(pending.frame, image, frameSize);
+	const float scaleX = (float)frameSize.width / pending.frame.cols;
+	const float scaleY = (float)frameSize.height / pending.frame.rows;
+
+	const LaneState& lane = pending.world.lane;
+	if (lane.valid && !pending.laneCenter.empty())
+	{
+		std::vector<cv::Point2f> birdsEye, camera;
+		for (size_t row = 0; row < pending.laneCenter.size(); row += 8)
+			birdsEye.push_back(cv::Point2f(pending.laneCenter[row], row));
+		cv::perspectiveTransform(birdsEye, camera, birdsEyeToFrame);
+
+		std::vector<cv::Point> line;
+		for (const cv::Point2f& point : camera)
+			line.push_back(cv::Point(point.x / params.laneResize * scaleX, point.y / params.laneResize * scaleY));
+		cv::polylines(image, line, false, cv::Scalar(0, 255, 255), 2);
+	}
+
+	// Cars red, traffic blue
+	static const cv::Scalar colors[(size_t)DetectorId::Count] = {cv::Scalar(0, 0, 255), cv::Scalar(255, 0, 0)};
+	for (size_t detector = 0; detector < (size_t)DetectorId::Count; ++detector)
+	{
+		for (const Detection& object : pending.world.detections[detector].objects)
+		{
+			const cv::Point2f topLeft(object.xmin * scaleX, object.ymin * scaleY);
+			std::ostringstream label;
+			label << objectClassName(object.objectClass) << ":" << std::fixed << std::setprecision(2) << object.confidence;
+			if (object.trackId != 0)
+				label << " #" << object.trackId;
+			cv::rectangle(image, topLeft, cv::Point2f(object.xmax * scaleX, object.ymax * scaleY), colors[detector], 2);
+			cv::putText(image, label.str(), topLeft - cv::Point2f(0, 5), cv::FONT_HERSHEY_PLAIN, 1, colors[detector]);
+		}
+	}
+
+	const ControlState& control = pending.control;
+	std::ostringstream status;
+	status << "frame " << pending.frameId << "  lane " << std::fixed << std::setprecision(1) << lane.steeringAngle
+	       << (lane.valid ? "" : " (none)") << "  speed " << control.speed << " steer " << (int)control.steer
+	       << (control.stopOn ? " STOP" : "");
+	cv::putText(image, status.str(), cv::Point2f(5, image.rows - 10), cv::FONT_HERSHEY_PLAIN, 1.2, cv::Scalar(0, 255, 0));
+}
+
+bool VideoSink::writeY4m(const cv::Mat& image)
+{
+	cv::cvtColor(image, yuv, cv::COLOR_BGR2YUV_I420);
+	const size_t size = yuv.total() * yuv.elemSize();
+	return fputs("FRAME\n", y4m) >= 0 && fwrite(yuv.data, 1, size, y4m) == size;
+}
+
+bool VideoSink::writeFrame(const cv::Mat& image)
+{
+	if (y4m != nullptr)
+		return writeY4m(image);
+	// write() reports nothing, a backend that gave up shows as a closed writer
+	if (!writer.isOpened())
+		return false;
+	writer.write(image);
+	return true;
+}
+
+void VideoSink::encodeLoop()
+{
+	Pending pending;
+	cv::Mat image;
+	bool failed = false;
+	while (queue.pop(pending))
+	{
+		// After a failed write the file is cut short, the frames that follow are only counted
+		if (failed)
+		{
+			++dropped;
+			continue;
+		}
+
+		composite(pending, image);
+		pending.frame.release();
+
+		if (!writeFrame(image))
+		{
+			slog::warn << "Video " << params.path << ": write failed, "
+			           << (y4m != nullptr ? strerror(errno) : "the encoder was closed")
+			           << ", dropping the frames from here on" << slog::endl;
+			failed = true;
+			++dropped;
+			continue;
+		}
+		++encoded;
+	}
+}
+
+void VideoSink::close()
+{
+	if (!encoder.joinable())
+		return;
+
+	queue.close();
+	encoder.join();
+	if (y4m != nullptr)
+	{
+		if (fclose(y4m) != 0)
+			slog::warn << "Video " << params.path << ": closing failed, " << strerror(errno) << slog::endl;
+		y4m = nullptr;
+	}
+	writer.release();
+}
+
+uint64_t VideoSink::getSubmitted() const
+{
+	return submitted;
+}
+
+uint64_t VideoSink::getDropped() const
+{
+	return dropped;
+}
+
+uint64_t VideoSink::getEncoded() const
+{
+	return encoded;
+}
+
+size_t VideoSink::getQueueDepth()
+{
+	return queue.size();
+}
+
+const std::string& VideoSink::getPath() const
+{
+	return params.path;
+}
@@ -0,0 +1,102 @@
+/*
+ * VideoSink.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <opencv2/videoio/videoio.hpp>
+#include "BoundedQueue.h"
+#include "ControlState.h"
+#include "WorldModel.h"
+
+struct VideoSinkParams
+{
+	std::string path;              // *.y4m - raw YUV 4:2:0, anything else - cv::VideoWriter
+	double fps = 30;
+	std::string fourcc = "MJPG";   // cv::VideoWriter only
+	size_t queueCapacity = 8;      // frames waiting for the encoder, more are dropped
+	float laneResize = 1;          // of the lane stage, to map its bird's eye view back to the frame
+	float laneQuadRatio = 1.4f;
+};
+
+/*
+ * Records the captured frames with the perception results and the command drawn over them.
+ * submit() only queues the frame, an encoder thread draws the overlays and encodes it.
+ * Frames are dropped and counted while the encoder falls behind, the pipeline never waits.
+ * After a failed write every later frame is dropped as well.
+ */
+class VideoSink
+{
+private:
+	struct Pending
+	{
+		uint64_t frameId;
+		cv::Mat frame;                 // shared with the pipeline, drawn on a copy
+		WorldSnapshot world;
+		std::vector<float> laneCenter;
+		ControlState control;
+	};
+
+	VideoSinkParams params;
+	cv::Size frameSize;
+	cv::Mat birdsEyeToFrame;
+	BoundedQueue<Pending> queue;
+	std::thread encoder;
+
+	// owned by the encoder thread
+	cv::VideoWriter writer;
+	FILE* y4m;
+	cv::Mat yuv;
+
+	std::mutex laneMtx;
+	std::vector<float> laneCenter;
+
+	std::atomic<uint64_t> submitted;
+	std::atomic<uint64_t> dropped;
+	std::atomic<uint64_t> encoded;
+
+	void encodeLoop();
+	void composite(const Pending& pending, cv::Mat& image) const;
+	bool writeY4m(const cv::Mat& image);
+	bool writeFrame(const cv::Mat& image);
+public:
+	/*
+	 * Throws std::logic_error if the file cannot be created
+	 */
+	VideoSink(const VideoSinkParams& params, const cv::Size& frameSize);
+	virtual ~VideoSink();
+
+	/*
+	 * Lane center of the last lane stage run, in its bird's eye view
+	 */
+	void setLaneCenter(const std::vector<float>& center);
+
+	/*
+	 * Never blocks. frame is referenced, not copied, the caller must not write to its
+	 * pixels afterwards.
+	 */
+	void submit(uint64_t frameId, const cv::Mat& frame, const WorldSnapshot& world, const ControlState& control);
+
+	/*
+	 * Encodes what is queued and closes the file. Called by the destructor.
+	 */
+	void close();
+
+	uint64_t getSubmitted() const;
+	uint64_t getDropped() const;
+	uint64_t getEncoded() const;
+	// frames waiting for the encoder thread
+	size_t getQueueDepth();
+	const std::string& getPath() const;
+};
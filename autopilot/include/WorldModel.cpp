@@ -0,0 +1,57 @@
+/*
+ * WorldModel.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "WorldModel.h"
+
+WorldModel::WorldModel():
+	frameId(0)
+{
+}
+
+void WorldModel::publishFrame(uint64_t frameId)
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		this->frameId = frameId;
+	}
+	frameArrived.notify_all();
+}
+
+void WorldModel::publishDetections(DetectorId detector, const DetectionSet& set)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	detections[(size_t)detector] = set;
+}
+
+void WorldModel::publishLane(const LaneState& state)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	lane = state;
+}
+
+bool WorldModel::waitForFrame(uint64_t lastFrameId, WorldSnapshot& snapshot, std::chrono::milliseconds timeout)
+{
+	std::unique_lock<std::mutex> lock(mtx);
+	if (!frameArrived.wait_for(lock, timeout, [&]() { return frameId > lastFrameId; }))
+		return false;
+
+	copyTo(snapshot);
+	return true;
+}
+
+void WorldModel::snapshot(WorldSnapshot& snapshot)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	copyTo(snapshot);
+}
+
+void WorldModel::copyTo(WorldSnapshot& snapshot) const
+{
+	snapshot.frameId = frameId;
+	for (size_t i = 0; i < (size_t)DetectorId::Count; ++i)
+		snapshot.detections[i] = detections[i];
+	snapshot.lane = lane;
+}
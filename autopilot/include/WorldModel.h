@@ -0,0 +1,68 @@
+/*
+ * WorldModel.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include "Detection.h"
+
+enum class DetectorId : uint8_t
+{
+	Cars,
+	Traffic,
+	Count
+};
+
+struct LaneState
+{
+	float steeringAngle = 0;
+	bool valid = false;
+	uint64_t frameId = 0;
+	uint64_t timestampNs = 0;
+};
+
+struct WorldSnapshot
+{
+	uint64_t frameId = 0;
+	DetectionSet detections[(size_t)DetectorId::Count];
+	LaneState lane;
+};
+
+/*
+ * Latest perception results of every stage. Stages publish as they finish, the planner
+ * wakes up once per captured frame and takes a snapshot of everything known so far.
+ */
+class WorldModel
+{
+private:
+	std::mutex mtx;
+	std::condition_variable frameArrived;
+	uint64_t frameId;
+	DetectionSet detections[(size_t)DetectorId::Count];
+	LaneState lane;
+
+	// mtx held
+	void copyTo(WorldSnapshot& snapshot) const;
+public:
+	WorldModel();
+
+	void publishFrame(uint64_t frameId);
+	void publishDetections(DetectorId detector, const DetectionSet& set);
+	void publishLane(const LaneState& state);
+
+	/*
+	 * Everything known so far, without waiting for a new frame
+	 */
+	void snapshot(WorldSnapshot& snapshot);
+
+	/*
+	 * Blocks until a frame newer than lastFrameId was captured. Returns false on timeout.
+	 */
+	bool waitForFrame(uint64_t lastFrameId, WorldSnapshot& snapshot, std::chrono::milliseconds timeout);
+};
@@ -7,6 +7,7 @@
 #include <memory>
 #include <algorithm>
 #include <vector>
+#include <stdint.h>
 #include <omp.h>
 
 #include "AbstractModel.hpp"
@@ -31,6 +32,10 @@ namespace GRANSAC
 
 		std::vector<std::mt19937> m_RandEngines; // Mersenne twister high quality RNG that support *OpenMP* multi-threading
 
+		bool m_Seeded; // Hypotheses are drawn from m_Seed instead of m_RandEngines
+		std::mt19937::result_type m_Seed;
+		uint64_t m_Estimates; // Estimate() calls since Seed()
+
 	public:
 		RANSAC(void)
 		{
@@ -41,10 +46,23 @@ namespace GRANSAC
 				std::random_device SeedDevice;
 				m_RandEngines.push_back(std::mt19937(SeedDevice()));
 			}
+			m_Seeded = false;
+			m_Seed = 0;
+			m_Estimates = 0;
 
 			Reset();
 		};
 
+		// From now on hypothesis i of the n-th Estimate() call is drawn from an engine seeded
+		// with (Seed, n, i), whichever thread samples it. The same data then gives the same
+		// model on every run, on any number of cores and with any OpenMP schedule.
+		void Seed(std::mt19937::result_type Seed)
+		{
+			m_Seeded = true;
+			m_Seed = Seed;
+			m_Estimates = 0;
+		};
+
 		virtual ~RANSAC(void) {};
 
 		void Reset(void)
@@ -82,17 +100,26 @@ namespace GRANSAC
 			std::vector<std::vector<std::shared_ptr<AbstractParameter>>> InliersAccum(m_MaxIterations);
 			m_SampledModels.resize(m_MaxIterations);
 
+			const uint64_t Call = m_Estimates++;
 			int nThreads = std::max(1, omp_get_max_threads());
 			omp_set_dynamic(0); // Explicitly disable dynamic teams
 			omp_set_num_threads(nThreads);
-#pragma omp parallel for
+#pragma omp parallel for schedule(static)
 			for (int i = 0; i < m_MaxIterations; ++i)
 			{
 				// Select t_NumParams random samples
 				std::vector<std::shared_ptr<AbstractParameter>> RandomSamples(t_NumParams);
 				std::vector<std::shared_ptr<AbstractParameter>> RemainderSamples = m_Data; // Without the chosen random samples
 
-				std::shuffle(RemainderSamples.begin(), RemainderSamples.end(), m_RandEngines[omp_get_thread_num()]); // To avoid picking the same element more than once
+				// To avoid picking the same element more than once
+				if (m_Seeded)
+				{
+					std::seed_seq Sequence{(uint32_t)m_Seed, (uint32_t)Call, (uint32_t)(Call >> 32), (uint32_t)i};
+					std::mt19937 HypothesisEngine(Sequence);
+					std::shuffle(RemainderSamples.begin(), RemainderSamples.end(), HypothesisEngine);
+				}
+				else
+					std::shuffle(RemainderSamples.begin(), RemainderSamples.end(), m_RandEngines[omp_get_thread_num()]);
 				std::copy(RemainderSamples.begin(), RemainderSamples.begin() + t_NumParams, RandomSamples.begin());
 				//RemainderSamples.erase(RemainderSamples.begin(), RemainderSamples.begin() + t_NumParams); // Remove the model data points from consideration. 2018: Turns out this is not a good idea
 
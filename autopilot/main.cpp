@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <vector>
@@ -8,12 +9,53 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <opencv2/highgui/highgui.hpp>
-#include <sys/ioctl.h>
-#include <linux/i2c-dev.h>
 #include <thread>
 #include <mutex>
+#include <signal.h>
+#include <string.h>
 #include <unistd.h>
 #include "include/AutoPilot.h"
+#include "include/AutoPilotFlags.h"
+#include "include/ConfigFile.h"
+#include "include/ConfigFile.cpp"
+#include "include/ControlState.h"
+#include "include/ControlState.cpp"
+#include "include/StageScheduler.h"
+#include "include/StageScheduler.cpp"
+#include "include/AutoPilotThreadOperations.h"
+#include "include/AutoPilotThreadOperations.cpp"
+#include "include/ActuatorLoop.h"
+#include "include/ActuatorLoop.cpp"
+#include "include/VehicleProtocol.h"
+#include "include/VehicleProtocol.cpp"
+#include "include/VehicleLink.h"
+#include "include/VehicleLink.cpp"
+#include "include/Detection.h"
+#include "include/Detection.cpp"
+#include "include/WorldModel.h"
+#include "include/WorldModel.cpp"
+#include "include/BehaviourPlanner.h"
+#include "include/BehaviourPlanner.cpp"
+#include "include/DetectionDecoder.h"
+#include "include/DetectionDecoder.cpp"
+#include "include/MotionGate.h"
+#include "include/MotionGate.cpp"
+#include "include/ObjectTracker.h"
+#include "include/ObjectTracker.cpp"
+#include "include/SSDDetector.h"
+#include "include/SSDDetector.cpp"
+#include "include/LayerProfile.h"
+#include "include/LayerProfile.cpp"
+#include "include/FrameSource.h"
+#include "include/FrameSource.cpp"
+#include "include/DriveLog.h"
+#include "include/DriveLog.cpp"
+#include "include/Replay.h"
+#include "include/Replay.cpp"
+#include "include/VideoSink.h"
+#include "include/VideoSink.cpp"
+#include "include/Metrics.h"
+#include "include/Metrics.cpp"
 #include "include/DeltaTimer.h"
 #include "include/DeltaTimer.cpp"
 #include "include/LaneDetector.hpp"
@@ -23,73 +65,362 @@
 
 using namespace InferenceEngine;
 
-cv::VideoCapture cap(0);
+std::unique_ptr<FrameSource> source;
 size_t width;
 size_t height;
 cv::Mat frame(height, width, CV_8UC3);
+// Id of the frame currently held in frame, guarded by frameMtx
+uint64_t frameId = 0;
+// CLOCK_MONOTONIC capture time of frame, the recorded one while replaying, guarded by frameMtx
+uint64_t frameTimestampNs = 0;
+// Motion gate thumbnail of frame, guarded by frameMtx, empty unless -motion_gate_enable
+cv::Mat thumbnail;
 
 mutex frameMtx;
 mutex imShowMtx;
 
-int main()
+// Stage ids in stageScheduler, -1 while the scheduler is off
+int lanesStage = -1;
+int carsStage = -1;
+int trafficStage = -1;
+
+// Created by main from the -actuator_* flags
+std::unique_ptr<ActuatorLoop> actuatorLoop;
+
+ThreadLauncher threadLauncher;
+
+// Opened by main before the actuator starts, written by arduinoI2C only
+std::unique_ptr<VehicleLink> vehicleLink;
+
+// Records what the car saw and did, null unless -log_path is set
+std::unique_ptr<DriveLogWriter> driveLog;
+
+// Annotated recording of the captured frames, null unless -video_path is set
+std::unique_ptr<VideoSink> videoSink;
+
+// Updated by every thread, served with -metrics_listen
+MetricsRegistry metrics;
+std::unique_ptr<MetricsServer> metricsServer;
+// Bounds of the latency histograms, in ms
+const std::vector<double> latencyBoundsMs = {0.1, 0.5, 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+
+// source while replaying a drive log, null otherwise
+DriveLogSource* replay = nullptr;
+// Stage ids in lockStep, -1 unless -replay
+LockStep lockStep;
+int lanesStep = -1;
+int carsStep = -1;
+int trafficStep = -1;
+int plannerStep = -1;
+int actuatorStep = -1;
+
+// Time stamp of stage results: now, or the recorded capture time of the frame while replaying
+static uint64_t resultTimestampNs(uint64_t capturedNs)
 {
-    if (!cap.isOpened()) {
-        throw std::logic_error("Cannot open input file or camera");
-        return -1;
+    return replay ? capturedNs : ControlChannel::nowNs();
+}
+
+bool ParseAndCheckCommandLine(int argc, char *argv[]) {
+    // ---------------------------Parsing and validation of input args--------------------------------------
+    gflags::ParseCommandLineNonHelpFlags(&argc, &argv, true);
+    if (FLAGS_h) {
+        showUsage();
+        return false;
     }
+    slog::info << "Parsing input parameters" << slog::endl;
 
-    // cap.set(cv::CAP_PROP_FRAME_WIDTH, 320);
-    // cap.set(cv::CAP_PROP_FRAME_HEIGHT, 240);
+    if (!FLAGS_config.empty()) {
+        loadConfigFile(FLAGS_config);
+    }
 
-    width = (size_t) cap.get(cv::CAP_PROP_FRAME_WIDTH);
-    height = (size_t) cap.get(cv::CAP_PROP_FRAME_HEIGHT);
+    if (FLAGS_lanes_slices == 0) {
+        throw std::logic_error("Parameter -lanes_slices should be greater than 0");
+    }
+    if (FLAGS_lanes_resize <= 0) {
+        throw std::logic_error("Parameter -lanes_resize should be greater than 0");
+    }
+    parseRegions(FLAGS_cars_regions);
+    parseRegions(FLAGS_traffic_regions);
+    if (FLAGS_tracker_max_interval < 1) {
+        throw std::logic_error("Parameter -tracker_max_interval should be at least 1");
+    }
+    if (FLAGS_scheduler_max_decimation < 1) {
+        throw std::logic_error("Parameter -scheduler_max_decimation should be at least 1");
+    }
+    if (!FLAGS_replay.empty() && FLAGS_scheduler_enable) {
+        throw std::logic_error("Parameter -scheduler_enable cannot be used with -replay, the scheduler decides on timing");
+    }
+    if (!FLAGS_replay.empty() && FLAGS_vehicle_link.compare(0, 4, "i2c:") == 0) {
+        slog::info << "Replaying, commands go to the simulated vehicle instead of " << FLAGS_vehicle_link << slog::endl;
+        FLAGS_vehicle_link = "sim";
+    }
+    if (FLAGS_actuator_rate_hz == 0) {
+        throw std::logic_error("Parameter -actuator_rate_hz should be greater than 0");
+    }
+    if (FLAGS_actuator_min_gap_us >= 1000000 / FLAGS_actuator_rate_hz) {
+        throw std::logic_error("Parameter -actuator_min_gap_us should be shorter than the -actuator_rate_hz period");
+    }
+    if (FLAGS_video_queue == 0) {
+        throw std::logic_error("Parameter -video_queue should be greater than 0");
+    }
+    if (FLAGS_log_frames != "jpeg" && FLAGS_log_frames != "ref" && FLAGS_log_frames != "none") {
+        throw std::logic_error("Parameter -log_frames should be \"jpeg\", \"ref\" or \"none\"");
+    }
+    if (FLAGS_perf_counts_inferences == 0) {
+        throw std::logic_error("Parameter -perf_counts_inferences should be greater than 0");
+    }
+    if (FLAGS_perf_counts_format != "csv" && FLAGS_perf_counts_format != "json") {
+        throw std::logic_error("Parameter -perf_counts_format should be \"csv\" or \"json\"");
+    }
+    parseThreadConfig("capture", FLAGS_threads_capture);
+    parseThreadConfig("show", FLAGS_threads_show);
+    parseThreadConfig("lanes", FLAGS_threads_lanes);
+    parseThreadConfig("cars", FLAGS_threads_cars);
+    parseThreadConfig("traffic", FLAGS_threads_traffic);
+    parseThreadConfig("planner", FLAGS_threads_planner);
+    parseThreadConfig("actuator", FLAGS_threads_actuator);
+
+    return true;
+}
 
-    std::cout << cv::getBuildInformation() << std::endl;
-    std::cout << "InferenceEngine: " << GetInferenceEngineVersion() << std::endl;
+int main(int argc, char *argv[])
+{
+    // Blocked in every thread started from here on (stages, writers, metrics), main waits for them below
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
 
-    std::thread getFrameTh(getFrame);
-    std::thread showFrameTh(showFrame);
-    //std::thread detectLanesTh(detectLanes);
-    std::thread detectCarsTh(detectCars);
-    std::thread detectTrafficTh(detectTraffic);
-    // std::thread arduinoI2CTh(arduinoI2C);
+    try {
+        if (!ParseAndCheckCommandLine(argc, argv)) {
+            return 0;
+        }
+        if (!FLAGS_replay.empty())
+        {
+            replay = new DriveLogSource(FLAGS_replay, FLAGS_replay_realtime);
+            source.reset(replay);
+        }
+        else
+        {
+            ImageDecodeParams decode;
+            decode.threads = FLAGS_input_decode_threads;
+            decode.prefetch = FLAGS_input_prefetch;
+            decode.minSize = cv::Size(FLAGS_input_min_width, FLAGS_input_min_height);
+            source = createFrameSource(FLAGS_i, decode);
+        }
+
+        if (!FLAGS_log_path.empty())
+        {
+            driveLog.reset(new DriveLogWriter(FLAGS_log_path, FLAGS_log_jpeg_quality));
+            driveLog->logSource(source->name());
+        }
 
-    getFrameTh.join();
-    showFrameTh.join();
-    //detectLanesTh.join();
-    detectCarsTh.join();
-    detectTrafficTh.join();
-    // arduinoI2CTh.join();
+        if (!FLAGS_video_path.empty())
+        {
+            VideoSinkParams video;
+            video.path = FLAGS_video_path;
+            video.fps = FLAGS_video_fps;
+            video.fourcc = FLAGS_video_codec;
+            video.queueCapacity = FLAGS_video_queue;
+            video.laneResize = FLAGS_lanes_resize;
+            video.laneQuadRatio = FLAGS_lanes_quad_ratio;
+            videoSink.reset(new VideoSink(video, cv::Size(source->width(), source->height())));
+        }
 
-    atexit(exitRoutine);
-    return 0;
-}
+        if (driveLog)
+        {
+            metrics.sampled("autopilot_queue_depth", "Items waiting for a writer thread", "gauge",
+                            []() { return (double)driveLog->getQueueDepth(); }, "queue=\"drive_log\"");
+            metrics.sampled("autopilot_queue_dropped_total", "Items dropped while a writer thread fell behind", "counter",
+                            []() { return (double)driveLog->getDropped(); }, "queue=\"drive_log\"");
+        }
+        if (videoSink)
+        {
+            metrics.sampled("autopilot_queue_depth", "Items waiting for a writer thread", "gauge",
+                            []() { return (double)videoSink->getQueueDepth(); }, "queue=\"video\"");
+            metrics.sampled("autopilot_queue_dropped_total", "Items dropped while a writer thread fell behind", "counter",
+                            []() { return (double)videoSink->getDropped(); }, "queue=\"video\"");
+        }
+        if (!FLAGS_metrics_listen.empty())
+        {
+            metricsServer.reset(new MetricsServer(metrics, FLAGS_metrics_listen));
+            slog::info << "Serving metrics on " << metricsServer->getListen() << slog::endl;
+        }
+    }
+    catch (const std::exception& error) {
+        slog::err << error.what() << slog::endl;
+        slog::flush();
+        return 1;
+    }
+
+    width = source->width();
+    height = source->height();
+
+    slog::info << cv::getBuildInformation() << slog::endl;
+    std::ostringstream ieVersion;
+    ieVersion << GetInferenceEngineVersion();
+    slog::info << "InferenceEngine: " << ieVersion.str() << slog::endl;
+
+    actuatorLoop.reset(new ActuatorLoop(FLAGS_actuator_rate_hz, FLAGS_actuator_min_gap_us, FLAGS_actuator_priority));
+    controlChannel.setChangeListener([]() { actuatorLoop->notify(); });
+
+    // Lanes steer the car, pedestrians and vehicles come next, signs can wait
+    if (FLAGS_scheduler_enable)
+    {
+        if (FLAGS_lanes_enable)
+            lanesStage = stageScheduler.addStage(StageConfig("lanes", 0, FLAGS_scheduler_lanes_deadline_ms));
+        if (FLAGS_cars_enable)
+            carsStage = stageScheduler.addStage(StageConfig("cars", 1, FLAGS_scheduler_cars_deadline_ms,
+                                                            FLAGS_scheduler_max_decimation));
+        if (FLAGS_traffic_enable)
+            trafficStage = stageScheduler.addStage(StageConfig("traffic", 2, FLAGS_scheduler_traffic_deadline_ms,
+                                                               FLAGS_scheduler_max_decimation));
+    }
+
+    // Every stage finishes a frame before the next one is captured
+    if (replay)
+    {
+        if (FLAGS_lanes_enable)
+            lanesStep = lockStep.addStage("lanes");
+        if (FLAGS_cars_enable)
+            carsStep = lockStep.addStage("cars");
+        if (FLAGS_traffic_enable)
+            trafficStep = lockStep.addStage("traffic");
+        if (FLAGS_planner_enable)
+        {
+            plannerStep = lockStep.addStage("planner");
+            actuatorStep = lockStep.addStage("actuator");
+        }
+    }
+
+    try {
+        // Driving without the vehicle is only meant when asked for with -vehicle_link sim
+        vehicleLink = createVehicleLink(FLAGS_vehicle_link);
+        if (!vehicleLink->open())
+            throw std::logic_error("Cannot open vehicle link " + vehicleLink->name());
+
+        threadLauncher.launch(parseThreadConfig("capture", FLAGS_threads_capture), getFrame);
+        if (FLAGS_show_enable)
+            threadLauncher.launch(parseThreadConfig("show", FLAGS_threads_show), showFrame);
+        if (FLAGS_lanes_enable)
+            threadLauncher.launch(parseThreadConfig("lanes", FLAGS_threads_lanes), detectLanes);
+        if (FLAGS_cars_enable)
+            threadLauncher.launch(parseThreadConfig("cars", FLAGS_threads_cars), detectCars);
+        if (FLAGS_traffic_enable)
+            threadLauncher.launch(parseThreadConfig("traffic", FLAGS_threads_traffic), detectTraffic);
+        if (FLAGS_planner_enable)
+            threadLauncher.launch(parseThreadConfig("planner", FLAGS_threads_planner), planBehaviour);
+        // ActuatorLoop raises itself to SCHED_FIFO -actuator_priority
+        threadLauncher.launch(parseThreadConfig("actuator", FLAGS_threads_actuator), arduinoI2C);
+    }
+    catch (const std::exception& error) {
+        slog::err << error.what() << slog::endl;
+        slog::flush();
+        _exit(1);
+    }
 
-void frameToBlob(const cv::Mat& frame, InferRequest::Ptr& inferRequest,
-                 const std::string& inputName) {
+    int stopSignal = 0;
+    sigwait(&stopSignals, &stopSignal);
+    slog::info << "Stopping on " << strsignal(stopSignal) << slog::endl;
+    exitRoutine();
+    slog::flush();
+    // The stage threads never return, leave without destroying the globals they use
+    _exit(0);
+}
 
-    /* Resize and copy data from the image to the input blob */
-    Blob::Ptr frameBlob = inferRequest->GetBlob(inputName);
-    matU8ToBlob<uint8_t>(frame, frameBlob);
+/*
+ * Replay only: waits until the stages finished frame capturedId, then lets the planner
+ * plan it and waits until the actuator sent the planned command
+ */
+static void stepReplay(uint64_t capturedId, std::vector<int>& waiting)
+{
+    auto wait = [&](int stage, uint64_t step)
+    {
+        if (std::find(waiting.begin(), waiting.end(), stage) == waiting.end() ||
+            lockStep.waitFor(stage, step, std::chrono::milliseconds(REPLAY_STAGE_TIMEOUT_MS)))
+            return;
+        slog::warn << "Replay: " << lockStep.name(stage) << " did not finish " << step << " in "
+                   << REPLAY_STAGE_TIMEOUT_MS << " ms, no longer waiting for it" << slog::endl;
+        waiting.erase(std::find(waiting.begin(), waiting.end(), stage));
+    };
+
+    wait(lanesStep, capturedId);
+    wait(carsStep, capturedId);
+    wait(trafficStep, capturedId);
+    worldModel.publishFrame(capturedId);
+    wait(plannerStep, capturedId);
+    wait(actuatorStep, controlChannel.read().version);
 }
 
 void getFrame()
 {
     DeltaTimer timer;
     cv::Mat frameBuffer(height, width, CV_8UC3);
+    slog::RateLimit fpsReport(std::chrono::seconds(1));
+    // Lock step stages still waited for, replay only
+    std::vector<int> waiting;
+    for (int stage : {lanesStep, carsStep, trafficStep, plannerStep, actuatorStep})
+        if (stage >= 0)
+            waiting.push_back(stage);
+    const auto start = std::chrono::steady_clock::now();
+    Counter& framesCaptured = metrics.counter("autopilot_frames_captured_total", "Frames read from the source");
 
     while(true)
     {
         timer.resetDeltaTimer();
-        cap >> frameBuffer;
+        if (!source->read(frameBuffer))
+        {
+            slog::info << "End of " << source->name() << slog::endl;
+            if (replay)
+            {
+                const float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+                slog::info << "Replayed " << replay->framesRead() << " frames in " << seconds << " s ("
+                           << replay->framesRead() / seconds << " fps)" << slog::endl;
+                // main stops the pipeline as on Ctrl+C
+                kill(getpid(), SIGTERM);
+            }
+            return;
+        }
+
+        cv::Mat capturedThumbnail;
+        if (FLAGS_motion_gate_enable)
+            capturedThumbnail = makeThumbnail(frameBuffer);
+
+        // Never written to once published, readers and the drive log share it
+        cv::Mat captured = frameBuffer.clone();
+
+        const uint64_t capturedNs = replay ? replay->lastTimestampNs() : ControlChannel::nowNs();
 
         frameMtx.lock();
-        frame = frameBuffer.clone();
+        frame = captured;
+        thumbnail = capturedThumbnail;
+        uint64_t capturedId = ++frameId;
+        frameTimestampNs = capturedNs;
         frameMtx.unlock();
+        framesCaptured.add();
+
+        if (driveLog && FLAGS_log_frames == "jpeg")
+            driveLog->logFrame(capturedId, capturedNs, captured);
+        else if (driveLog && FLAGS_log_frames == "ref")
+            driveLog->logFrameRef(capturedId, capturedNs, source->lastIndex());
 
-        std::cout << "Capture FPS : " 
-                  << 1 / ((float)timer.getDeltaTimeMs() / 1000) 
-                  << std::endl;
+        if (replay)
+            stepReplay(capturedId, waiting);
+        else
+            worldModel.publishFrame(capturedId);
+
+        // Drawn with the results known so far, the ones the planner acts on
+        if (videoSink)
+        {
+            WorldSnapshot world;
+            worldModel.snapshot(world);
+            videoSink->submit(capturedId, captured, world, controlChannel.read());
+        }
+
+        slog::info << slog::every(fpsReport) << "Capture FPS : "
+                   << 1 / ((float)timer.getDeltaTimeUs() / 1000000)
+                   << slog::endl;
     }
 }
 
@@ -120,23 +451,70 @@ void detectLanes()
 {
     DeltaTimer timer;
     cv::Mat frameCpy(height, width, CV_8UC3);
-    LaneDetector laneDetector(1, width, height);
+    LaneParams laneParams;
+    laneParams.lineThreshold = FLAGS_lanes_line_threshold;
+    laneParams.maxIterations = FLAGS_lanes_max_iterations;
+    laneParams.histHeight = FLAGS_lanes_hist_height;
+    laneParams.slices = FLAGS_lanes_slices;
+    laneParams.quadRatio = FLAGS_lanes_quad_ratio;
+    laneParams.seed = FLAGS_lanes_seed != 0 || !replay ? FLAGS_lanes_seed : 1;
+    LaneDetector laneDetector(FLAGS_lanes_resize, width, height, laneParams);
 
     string fpsMesage = "";
+    uint64_t lastFrameId = 0;
+
+    Counter& framesIn = metrics.counter("autopilot_stage_frames_in_total", "Frames taken by a stage", "stage=\"lanes\"");
+    Counter& framesOut = metrics.counter("autopilot_stage_frames_out_total", "Results published by a stage", "stage=\"lanes\"");
+    Histogram& latency = metrics.histogram("autopilot_stage_latency_ms", "Time a stage spent on a frame",
+                                           latencyBoundsMs, "stage=\"lanes\"");
+    Counter& ransacIterations = metrics.counter("autopilot_lanes_ransac_iterations_total", "RANSAC iterations run by the lane stage");
+    uint64_t lastRansacIterations = 0;
     
     while(true)
     {
         timer.resetDeltaTimer();
 
         frameMtx.lock();
-        frameCpy = frame.clone();
+        uint64_t frameCpyId = frameId;
+        // While replaying every frame is processed exactly once
+        const bool seen = lanesStep >= 0 && frameCpyId == lastFrameId;
+        if (!seen)
+            frameCpy = frame.clone();
+        const uint64_t frameCpyNs = frameTimestampNs;
         frameMtx.unlock();
-
-        if(!frameCpy.empty())
+        if (seen)
         {
+            usleep(1000);
+            continue;
+        }
+        lastFrameId = frameCpyId;
+        if (!frameCpy.empty())
+            framesIn.add();
 
-            cv::Mat image = *(laneDetector.runCurvePipeline(frame));
-            steer = floor(laneDetector.getSteeringAngle()) + 50;
+        if(!frameCpy.empty() && (lanesStage < 0 || stageScheduler.admit(lanesStage)))
+        {
+            auto t0 = std::chrono::steady_clock::now();
+            cv::Mat image = *(laneDetector.runCurvePipeline(frameCpy));
+            const float elapsedMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            if (lanesStage >= 0)
+                stageScheduler.finish(lanesStage, elapsedMs);
+            latency.observe(elapsedMs);
+            ransacIterations.add(laneDetector.getRansacIterations() - lastRansacIterations);
+            lastRansacIterations = laneDetector.getRansacIterations();
+
+            LaneState lane;
+            lane.steeringAngle = laneDetector.getSteeringAngle();
+            lane.valid = laneDetector.lanesFound();
+            lane.frameId = frameCpyId;
+            lane.timestampNs = resultTimestampNs(frameCpyNs);
+            worldModel.publishLane(lane);
+            framesOut.add();
+            if (driveLog)
+                driveLog->logLane(lane, laneDetector.getLaneCenter());
+            if (videoSink)
+                videoSink->setLaneCenter(laneDetector.getLaneCenter());
+            if (lanesStep >= 0)
+                lockStep.finish(lanesStep, frameCpyId);
 
             cv::putText(image, fpsMesage, cv::Point2f(0, 75), cv::FONT_HERSHEY_PLAIN, 1.5,
                             cv::Scalar(255, 0, 0));
@@ -148,124 +526,157 @@ void detectLanes()
         }
 
         // Need to sincronize in order to not process the same frame
-        usleep(30000);
+        if (lanesStep < 0)
+            usleep(30000);
         fpsMesage =  "Lane detection FPS : " 
           + std::to_string(1 / ((float)timer.getDeltaTimeMs() / 1000));
     }
 }
 
-void detectCars()
+/*
+ * Writes the per-layer report of a detector to <prefix>_<name>_<device>.<format> and logs
+ * its slowest layers
+ */
+static void reportLayerProfile(const LayerProfile& profile, const std::string& name, const std::string& device)
 {
-    cv::Mat frameCpy(height, width, CV_8UC3);
-
-    std::string networkPath = "../../../models/pedestrian_and_vehicles/origin/mobilenet_iter_73000.xml";
-    constexpr float confidenceThreshold = 0.7f;
-
-    try {
-    // --------------------------- 1. Load Plugin for inference engine -------------------------------------
-    slog::info << "Loading plugin" << slog::endl;
-    InferencePlugin plugin = PluginDispatcher().getPluginByDevice(deviceName);
-    printPluginVersion(plugin, std::cout);
-
-    // --------------------------- 2. Read IR Generated by ModelOptimizer (.xml and .bin files) ------------
-    slog::info << "Loading network files" << slog::endl;
-    CNNNetReader netReader;
-    /** Read network model **/
-    netReader.ReadNetwork(networkPath);
-    /** Set batch size to 1 **/
-    slog::info << "Batch size is forced to  1." << slog::endl;
-    netReader.getNetwork().setBatchSize(1);
-    /** Extract model name and load it's weights **/
-    std::string binFileName = fileNameNoExt(networkPath) + ".bin";
-    netReader.ReadWeights(binFileName);
-    /** Read labels (if any)**/
-    std::string labelFileName = fileNameNoExt(networkPath) + ".labels";
-    std::vector<std::string> labels;
-    std::ifstream inputFile(labelFileName);
-    std::copy(std::istream_iterator<std::string>(inputFile),
-              std::istream_iterator<std::string>(),
-              std::back_inserter(labels));
-    // -----------------------------------------------------------------------------------------------------
-
-    /** SSD-based network should have one input and one output **/
-    // --------------------------- 3. Configure input & output ---------------------------------------------
-    // --------------------------- Prepare input blobs -----------------------------------------------------
-    slog::info << "Checking that the inputs are as the app expects" << slog::endl;
-    InputsDataMap inputInfo(netReader.getNetwork().getInputsInfo());
-    if (inputInfo.size() != 1) {
-        throw std::logic_error("This app accepts networks having only one input");
-    }
-    InputInfo::Ptr& input = inputInfo.begin()->second;
-    auto inputName = inputInfo.begin()->first;
-    input->setPrecision(Precision::U8);
-    input->getInputData()->setLayout(Layout::NCHW);
-    // --------------------------- Prepare output blobs -----------------------------------------------------
-    slog::info << "Checking that the outputs are as the app expects" << slog::endl;
-    OutputsDataMap outputInfo(netReader.getNetwork().getOutputsInfo());
-    if (outputInfo.size() != 1) {
-        throw std::logic_error("This app accepts networks having only one output");
-    }
-    DataPtr& output = outputInfo.begin()->second;
-    auto outputName = outputInfo.begin()->first;
-    const int num_classes = netReader.getNetwork().getLayerByName(outputName.c_str())->GetParamAsInt("num_classes");
-    if (static_cast<int>(labels.size()) != num_classes) {
-        if (static_cast<int>(labels.size()) == (num_classes - 1))  // if network assumes default "background" class, having no label
-            labels.insert(labels.begin(), "fake");
-        else
-            labels.clear();
-    }
-    const SizeVector outputDims = output->getTensorDesc().getDims();
-    const int maxProposalCount = outputDims[2];
-    const int objectSize = outputDims[3];
-    if (objectSize != 7) {
-        throw std::logic_error("Output should have 7 as a last dimension");
-    }
-    if (outputDims.size() != 4) {
-        throw std::logic_error("Incorrect output dimensions for SSD");
+    std::string deviceName = device;
+    // HETERO:MYRIAD,CPU and the like
+    std::replace_if(deviceName.begin(), deviceName.end(), [](char c) { return !isalnum((unsigned char)c); }, '_');
+    const std::string path = FLAGS_perf_counts_prefix + "_" + name + "_" + deviceName + "." + FLAGS_perf_counts_format;
+    if (!profile.write(path))
+    {
+        slog::warn << "Cannot write the layer profile of " << name << " to " << path << slog::endl;
+        return;
     }
-    output->setPrecision(Precision::FP32);
-    output->setLayout(Layout::NCHW);
-    // -----------------------------------------------------------------------------------------------------
+    slog::info << "Layer profile of " << name << " on " << device << " over " << profile.inferences()
+               << " inferences written to " << path << ", slowest layers:\n" << profile.slowest(5) << slog::endl;
+}
 
-    // --------------------------- 4. Loading model to the plugin ------------------------------------------
-    slog::info << "Loading model to the plugin" << slog::endl;
-    ExecutableNetwork network = plugin.LoadNetwork(netReader.getNetwork(), {});
-    // -----------------------------------------------------------------------------------------------------
+void runDetector(const SSDParams& params, DetectorId detectorId, const std::string& name, const std::string& windowName,
+                 int stage, int step)
+{
+    cv::Mat frameCpy(height, width, CV_8UC3);
+    Counter& framesIn = metrics.counter("autopilot_stage_frames_in_total", "Frames taken by a stage", "stage=\"" + name + "\"");
+    Counter& framesOut = metrics.counter("autopilot_stage_frames_out_total", "Results published by a stage", "stage=\"" + name + "\"");
+    Counter& inferences = metrics.counter("autopilot_inferences_total", "Frames the model ran on, the others were skipped",
+                                          "detector=\"" + name + "\"");
+    Histogram& inferenceLatency = metrics.histogram("autopilot_inference_latency_ms", "Inference time of a model",
+                                                    latencyBoundsMs, "detector=\"" + name + "\"");
 
-    // --------------------------- 5. Create infer request -------------------------------------------------
-    InferRequest::Ptr async_infer_request_curr = network.CreateInferRequestPtr();
-    // -----------------------------------------------------------------------------------------------------
+    try {
+    SSDDetector detector(params);
+    // Filled until -perf_counts_inferences, then reported once
+    std::unique_ptr<LayerProfile> profile;
+    if (params.perfCounts)
+        profile.reset(new LayerProfile(params.model, params.device));
 
-    // --------------------------- 6. Do inference ---------------------------------------------------------
     slog::info << "Start inference " << slog::endl;
 
     typedef std::chrono::duration<double, std::ratio<1, 1000>> ms;
     auto total_t0 = std::chrono::high_resolution_clock::now();
     auto wallclock = std::chrono::high_resolution_clock::now();
     double ocv_decode_time = 0, ocv_render_time = 0;
+    DetectionSet detectionSet;
 
-    std::cout << "To close the application, press 'CTRL+C' or any key with focus on the output window" << std::endl;
-    while (true) 
+    // With the tracker the detector runs every detectionInterval() frames, the frames in
+    // between get the predicted tracks
+    std::unique_ptr<ObjectTracker> tracker;
+    if (FLAGS_tracker_enable)
+    {
+        TrackerParams trackerParams;
+        trackerParams.minIou = FLAGS_tracker_min_iou;
+        trackerParams.minHits = FLAGS_tracker_min_hits;
+        trackerParams.maxMissed = FLAGS_tracker_max_missed;
+        trackerParams.maxInterval = FLAGS_tracker_max_interval;
+        tracker.reset(new ObjectTracker(trackerParams));
+    }
+    // With the motion gate inference is skipped while the scene does not change, the last
+    // detections (or the predicted tracks) are published again
+    std::unique_ptr<MotionGate> gate;
+    if (FLAGS_motion_gate_enable)
+    {
+        MotionGateParams gateParams;
+        gateParams.threshold = FLAGS_motion_gate_threshold;
+        gateParams.refreshFrames = FLAGS_motion_gate_refresh_frames;
+        gate.reset(new MotionGate(gateParams));
+    }
+    cv::Mat thumbnailCpy;
+    uint64_t lastFrameId = 0;
+    int framesSinceDetection = 0;
+
+    slog::info << "To close the application, press 'CTRL+C' or any key with focus on the output window" << slog::endl;
+    while (true)
     {
         auto t0 = std::chrono::high_resolution_clock::now();
         auto t1 = std::chrono::high_resolution_clock::now();
 
         frameMtx.lock();
-        frameCpy = frame.clone();
+        const uint64_t frameCpyId = frameId;
+        // The tracker, the gate, the scheduler and a replay step once per captured frame
+        const bool seen = (tracker || gate || stage >= 0 || step >= 0) && frameCpyId == lastFrameId;
+        if (!seen)
+        {
+            frameCpy = frame.clone();
+            thumbnailCpy = thumbnail;
+        }
+        const uint64_t frameCpyNs = frameTimestampNs;
         frameMtx.unlock();
+        if (seen)
+        {
+            usleep(1000);
+            continue;
+        }
+        lastFrameId = frameCpyId;
+        if (!frameCpy.empty())
+            framesIn.add();
+
+        bool skip = tracker && ++framesSinceDetection < tracker->detectionInterval();
+        // Asking the gate changes nothing, the frame is committed once its detections are out
+        if (!skip && gate && !thumbnailCpy.empty())
+            skip = !gate->changed(thumbnailCpy, frameCpyId);
+        // Last, the scheduler counts a run for every frame it admits
+        if (!skip && stage >= 0)
+            skip = !stageScheduler.admit(stage);
+
+        if(!frameCpy.empty() && skip)
+        {
+            // Without the tracker the last detections are published again, they keep the
+            // time they were taken at so the planner sees them aging
+            detectionSet.frameId = frameCpyId;
+            if (tracker)
+            {
+                detectionSet.timestampNs = resultTimestampNs(frameCpyNs);
+                detectionSet.objects.clear();
+                tracker->predict(detectionSet.timestampNs);
+                tracker->getObjects(detectionSet.objects);
+            }
+            worldModel.publishDetections(detectorId, detectionSet);
+            framesOut.add();
+            if (driveLog)
+                driveLog->logDetections(detectorId, detectionSet);
 
-        if(!frameCpy.empty())
+            drawDetections(frameCpy, detectionSet, detector);
+        }
+        else if(!frameCpy.empty())
         {
-            frameToBlob(frameCpy, async_infer_request_curr, inputName);
+            auto workStart = std::chrono::steady_clock::now();
+            detector.preprocess(frameCpy);
             t1 = std::chrono::high_resolution_clock::now();
             ocv_decode_time = std::chrono::duration_cast<ms>(t1 - t0).count();
             t0 = std::chrono::high_resolution_clock::now();
-            async_infer_request_curr->StartAsync();
 
-            if (OK == async_infer_request_curr->Wait(IInferRequest::WaitMode::RESULT_READY)) 
+            if (detector.infer())
             {
                 t1 = std::chrono::high_resolution_clock::now();
                 ms detection = std::chrono::duration_cast<ms>(t1 - t0);
+                inferences.add();
+                inferenceLatency.observe(detection.count());
+                if (profile && profile->inferences() < FLAGS_perf_counts_inferences)
+                {
+                    profile->add(detector.getPerformanceCounts());
+                    if (profile->inferences() == FLAGS_perf_counts_inferences)
+                        reportLayerProfile(*profile, name, params.device);
+                }
 
                 t0 = std::chrono::high_resolution_clock::now();
                 ms wall = std::chrono::duration_cast<ms>(t0 - wallclock);
@@ -288,59 +699,55 @@ void detectCars()
                             cv::Scalar(255, 0, 0));
 
                 // ---------------------------Process output blobs--------------------------------------------------
-                // Processing results of the CURRENT request
-                const float *detections = async_infer_request_curr->GetBlob(outputName)->buffer().as<PrecisionTrait<Precision::FP32>::value_type*>();
-                for (int i = 0; i < maxProposalCount; i++) {
-                    float image_id = detections[i * objectSize + 0];
-                    if (image_id < 0) {
-                        break;
-                    }
-
-                    float confidence = detections[i * objectSize + 2];
-                    auto label = static_cast<int>(detections[i * objectSize + 1]);
-                    float xmin = detections[i * objectSize + 3] * width;
-                    float ymin = detections[i * objectSize + 4] * height;
-                    float xmax = detections[i * objectSize + 5] * width;
-                    float ymax = detections[i * objectSize + 6] * height;
-
-                    if (confidence > confidenceThreshold) {
-                        /** Drawing only objects when > confidence_threshold probability **/
-                        std::ostringstream conf;
-                        conf << ":" << std::fixed << std::setprecision(3) << confidence;
-                        cv::putText(frameCpy,
-                                    (static_cast<size_t>(label) < labels.size() ?
-                                    labels[label] : std::string("label #") + std::to_string(label)) + conf.str(),
-                                    cv::Point2f(xmin, ymin - 5), cv::FONT_HERSHEY_COMPLEX_SMALL, 1,
-                                    cv::Scalar(0, 0, 255));
-                        cv::rectangle(frameCpy, cv::Point2f(xmin, ymin), cv::Point2f(xmax, ymax), cv::Scalar(0, 0, 255));
-                    }
+                detectionSet.frameId = frameCpyId;
+                detectionSet.timestampNs = resultTimestampNs(frameCpyNs);
+                detectionSet.objects.clear();
+                detector.decode(width, height, detectionSet);
+                if (gate && !thumbnailCpy.empty())
+                    gate->commit(thumbnailCpy, frameCpyId);
+                if (tracker)
+                {
+                    tracker->update(detectionSet.objects, detectionSet.timestampNs);
+                    detectionSet.objects.clear();
+                    tracker->getObjects(detectionSet.objects);
+                    framesSinceDetection = 0;
                 }
-
+                worldModel.publishDetections(detectorId, detectionSet);
+                framesOut.add();
+                if (driveLog)
+                    driveLog->logDetections(detectorId, detectionSet);
+                if (stage >= 0)
+                    stageScheduler.finish(stage, std::chrono::duration<float, std::milli>(
+                                                 std::chrono::steady_clock::now() - workStart).count());
+
+                drawDetections(frameCpy, detectionSet, detector);
             }
+        }
 
-        }        
+        if (step >= 0)
+            lockStep.finish(step, frameCpyId);
 
         t1 = std::chrono::high_resolution_clock::now();
         ocv_render_time = std::chrono::duration_cast<ms>(t1 - t0).count();
 
         imShowMtx.lock();
-        cv::imshow("Cars results", frameCpy);
+        cv::imshow(windowName, frameCpy);
         const int key = cv::waitKey(1);
+        imShowMtx.unlock();
         if (27 == key)  // Esc
             break;
-        imShowMtx.unlock();
     }
     // -----------------------------------------------------------------------------------------------------
     auto total_t1 = std::chrono::high_resolution_clock::now();
     ms total = std::chrono::duration_cast<ms>(total_t1 - total_t0);
-    std::cout << "Total Inference time: " << total.count() << std::endl;
+    slog::info << "Total Inference time: " << total.count() << slog::endl;
     }
     catch (const std::exception& error) {
-        std::cerr << "[ ERROR ] " << error.what() << std::endl;
+        slog::err << error.what() << slog::endl;
         return;
     }
     catch (...) {
-        std::cerr << "[ ERROR ] Unknown/internal exception happened." << std::endl;
+        slog::err << "Unknown/internal exception happened." << slog::endl;
         return;
     }
 
@@ -349,268 +756,135 @@ void detectCars()
     return;
 }
 
-void detectTraffic()
+void detectCars()
 {
-    cv::Mat frameCpy(height, width, CV_8UC3);
-
-    std::string networkPath = "../../../models/traffic_signs/FP16/mobilenet_iter_17000.xml";
-    constexpr float confidenceThreshold = 0.8f;
-
-    try {
-    // --------------------------- 1. Load Plugin for inference engine -------------------------------------
-    slog::info << "Loading plugin" << slog::endl;
-    InferencePlugin plugin = PluginDispatcher().getPluginByDevice(deviceName);
-    printPluginVersion(plugin, std::cout);
-
-    // --------------------------- 2. Read IR Generated by ModelOptimizer (.xml and .bin files) ------------
-    slog::info << "Loading network files" << slog::endl;
-    CNNNetReader netReader;
-    /** Read network model **/
-    netReader.ReadNetwork(networkPath);
-    /** Set batch size to 1 **/
-    slog::info << "Batch size is forced to  1." << slog::endl;
-    netReader.getNetwork().setBatchSize(1);
-    /** Extract model name and load it's weights **/
-    std::string binFileName = fileNameNoExt(networkPath) + ".bin";
-    netReader.ReadWeights(binFileName);
-    /** Read labels (if any)**/
-    std::string labelFileName = fileNameNoExt(networkPath) + ".labels";
-    std::vector<std::string> labels;
-    std::ifstream inputFile(labelFileName);
-    std::copy(std::istream_iterator<std::string>(inputFile),
-              std::istream_iterator<std::string>(),
-              std::back_inserter(labels));
-    // -----------------------------------------------------------------------------------------------------
-
-    /** SSD-based network should have one input and one output **/
-    // --------------------------- 3. Configure input & output ---------------------------------------------
-    // --------------------------- Prepare input blobs -----------------------------------------------------
-    slog::info << "Checking that the inputs are as the app expects" << slog::endl;
-    InputsDataMap inputInfo(netReader.getNetwork().getInputsInfo());
-    if (inputInfo.size() != 1) {
-        throw std::logic_error("This app accepts networks having only one input");
-    }
-    InputInfo::Ptr& input = inputInfo.begin()->second;
-    auto inputName = inputInfo.begin()->first;
-    input->setPrecision(Precision::U8);
-    input->getInputData()->setLayout(Layout::NCHW);
-    // --------------------------- Prepare output blobs -----------------------------------------------------
-    slog::info << "Checking that the outputs are as the app expects" << slog::endl;
-    OutputsDataMap outputInfo(netReader.getNetwork().getOutputsInfo());
-    if (outputInfo.size() != 1) {
-        throw std::logic_error("This app accepts networks having only one output");
-    }
-    DataPtr& output = outputInfo.begin()->second;
-    auto outputName = outputInfo.begin()->first;
-    const int num_classes = netReader.getNetwork().getLayerByName(outputName.c_str())->GetParamAsInt("num_classes");
-    if (static_cast<int>(labels.size()) != num_classes) {
-        if (static_cast<int>(labels.size()) == (num_classes - 1))  // if network assumes default "background" class, having no label
-            labels.insert(labels.begin(), "fake");
-        else
-            labels.clear();
-    }
-    const SizeVector outputDims = output->getTensorDesc().getDims();
-    const int maxProposalCount = outputDims[2];
-    const int objectSize = outputDims[3];
-    if (objectSize != 7) {
-        throw std::logic_error("Output should have 7 as a last dimension");
-    }
-    if (outputDims.size() != 4) {
-        throw std::logic_error("Incorrect output dimensions for SSD");
-    }
-    output->setPrecision(Precision::FP32);
-    output->setLayout(Layout::NCHW);
-    // -----------------------------------------------------------------------------------------------------
-
-    // --------------------------- 4. Loading model to the plugin ------------------------------------------
-    slog::info << "Loading model to the plugin" << slog::endl;
-    ExecutableNetwork network = plugin.LoadNetwork(netReader.getNetwork(), {});
-    // -----------------------------------------------------------------------------------------------------
-
-    // --------------------------- 5. Create infer request -------------------------------------------------
-    InferRequest::Ptr async_infer_request_curr = network.CreateInferRequestPtr();
-    // -----------------------------------------------------------------------------------------------------
+    SSDParams params;
+    params.model = FLAGS_cars_model;
+    params.device = FLAGS_cars_device;
+    params.threshold = FLAGS_cars_threshold;
+    params.nthreads = FLAGS_cars_nthreads;
+    params.nmsIou = FLAGS_cars_nms_iou;
+    params.regions = parseRegions(FLAGS_cars_regions);
+    params.perfCounts = FLAGS_perf_counts_enable;
+    runDetector(params, DetectorId::Cars, "cars", "Cars results", carsStage, carsStep);
+}
 
-    // --------------------------- 6. Do inference ---------------------------------------------------------
-    slog::info << "Start inference " << slog::endl;
+void detectTraffic()
+{
+    SSDParams params;
+    params.model = FLAGS_traffic_model;
+    params.device = FLAGS_traffic_device;
+    params.threshold = FLAGS_traffic_threshold;
+    params.nthreads = FLAGS_traffic_nthreads;
+    params.nmsIou = FLAGS_traffic_nms_iou;
+    params.regions = parseRegions(FLAGS_traffic_regions);
+    params.perfCounts = FLAGS_perf_counts_enable;
+    runDetector(params, DetectorId::Traffic, "traffic", "Traffic results", trafficStage, trafficStep);
+}
 
-    typedef std::chrono::duration<double, std::ratio<1, 1000>> ms;
-    auto total_t0 = std::chrono::high_resolution_clock::now();
-    auto wallclock = std::chrono::high_resolution_clock::now();
-    double ocv_decode_time = 0, ocv_render_time = 0;
+void planBehaviour()
+{
+    PlannerParams params;
+    params.cruiseSpeed = FLAGS_planner_cruise_speed;
+    params.slowSpeed = FLAGS_planner_slow_speed;
+    params.onFrames = FLAGS_planner_on_frames;
+    params.offFrames = FLAGS_planner_off_frames;
+    params.stopHoldFrames = FLAGS_planner_stop_hold_frames;
+    BehaviourPlanner planner(params, width, height);
+    WorldSnapshot world;
+    uint64_t lastFrameId = 0;
+    DriveState lastState = planner.getState();
+
+    slog::RateLimit budgetReport(std::chrono::seconds(1));
+    slog::RateLimit frameReport(std::chrono::seconds(1));
+
+    Counter& framesIn = metrics.counter("autopilot_stage_frames_in_total", "Frames taken by a stage", "stage=\"planner\"");
+    Histogram& latency = metrics.histogram("autopilot_stage_latency_ms", "Time a stage spent on a frame",
+                                           latencyBoundsMs, "stage=\"planner\"");
 
-    std::cout << "To close the application, press 'CTRL+C' or any key with focus on the output window" << std::endl;
-    while (true) 
+    while(true)
     {
-        auto t0 = std::chrono::high_resolution_clock::now();
-        auto t1 = std::chrono::high_resolution_clock::now();
-
-        frameMtx.lock();
-        frameCpy = frame.clone();
-        frameMtx.unlock();
-
-        if(!frameCpy.empty())
+        if (!worldModel.waitForFrame(lastFrameId, world, std::chrono::milliseconds(CONTROL_DEADLINE_MS)))
         {
-            frameToBlob(frameCpy, async_infer_request_curr, inputName);
-            t1 = std::chrono::high_resolution_clock::now();
-            ocv_decode_time = std::chrono::duration_cast<ms>(t1 - t0).count();
-            t0 = std::chrono::high_resolution_clock::now();
-            async_infer_request_curr->StartAsync();
-
-            if (OK == async_infer_request_curr->Wait(IInferRequest::WaitMode::RESULT_READY)) 
-            {
-                t1 = std::chrono::high_resolution_clock::now();
-                ms detection = std::chrono::duration_cast<ms>(t1 - t0);
-
-                t0 = std::chrono::high_resolution_clock::now();
-                ms wall = std::chrono::duration_cast<ms>(t0 - wallclock);
-                wallclock = t0;
-
-                t0 = std::chrono::high_resolution_clock::now();
-                std::ostringstream out;
-                out << "OpenCV cap/render time: " << std::fixed << std::setprecision(2)
-                    << (ocv_decode_time + ocv_render_time) << " ms";
-                cv::putText(frameCpy, out.str(), cv::Point2f(0, 25), cv::FONT_HERSHEY_PLAIN, 1.5, cv::Scalar(0, 255, 0));
-                out.str("");
-                out << "Wallclock time ";
-                out << std::fixed << std::setprecision(2) << wall.count() << " ms (" << 1000.f / wall.count() << " fps)";
-                cv::putText(frameCpy, out.str(), cv::Point2f(0, 50), cv::FONT_HERSHEY_PLAIN, 1.5, cv::Scalar(0, 0, 255));
-                out.str("");
-                out << "Detection time  : " << std::fixed << std::setprecision(2) << detection.count()
-                    << " ms ("
-                    << 1000.f / detection.count() << " fps)";
-                cv::putText(frameCpy, out.str(), cv::Point2f(0, 75), cv::FONT_HERSHEY_PLAIN, 1.5,
-                            cv::Scalar(255, 0, 0));
-
-                // ---------------------------Process output blobs--------------------------------------------------
-                // Processing results of the CURRENT request
-                const float *detections = async_infer_request_curr->GetBlob(outputName)->buffer().as<PrecisionTrait<Precision::FP32>::value_type*>();
-                for (int i = 0; i < maxProposalCount; i++) {
-                    float image_id = detections[i * objectSize + 0];
-                    if (image_id < 0) {
-                        break;
-                    }
-
-                    float confidence = detections[i * objectSize + 2];
-                    auto label = static_cast<int>(detections[i * objectSize + 1]);
-                    float xmin = detections[i * objectSize + 3] * width;
-                    float ymin = detections[i * objectSize + 4] * height;
-                    float xmax = detections[i * objectSize + 5] * width;
-                    float ymax = detections[i * objectSize + 6] * height;
-
-                    if (confidence > confidenceThreshold) {
-                        /** Drawing only objects when > confidence_threshold probability **/
-                        std::ostringstream conf;
-                        conf << ":" << std::fixed << std::setprecision(3) << confidence;
-                        cv::putText(frameCpy,
-                                    (static_cast<size_t>(label) < labels.size() ?
-                                    labels[label] : std::string("label #") + std::to_string(label)) + conf.str(),
-                                    cv::Point2f(xmin, ymin - 5), cv::FONT_HERSHEY_COMPLEX_SMALL, 1,
-                                    cv::Scalar(0, 0, 255));
-                        cv::rectangle(frameCpy, cv::Point2f(xmin, ymin), cv::Point2f(xmax, ymax), cv::Scalar(0, 0, 255));
-                    }
-                }
-
-            }
-
-        }        
-
-        t1 = std::chrono::high_resolution_clock::now();
-        ocv_render_time = std::chrono::duration_cast<ms>(t1 - t0).count();
+            // No new frames, leave the command alone and let the actuator deadline stop the car
+            slog::warn << slog::every(frameReport) << __func__ << " no frame for "
+                       << CONTROL_DEADLINE_MS << " ms" << slog::endl;
+            continue;
+        }
+        lastFrameId = world.frameId;
+        framesIn.add();
 
-        imShowMtx.lock();
-        cv::imshow("Traffic results", frameCpy);
-        const int key = cv::waitKey(1);
-        if (27 == key)  // Esc
-            break;
-        imShowMtx.unlock();
-    }
-    // -----------------------------------------------------------------------------------------------------
-    auto total_t1 = std::chrono::high_resolution_clock::now();
-    ms total = std::chrono::duration_cast<ms>(total_t1 - total_t0);
-    std::cout << "Total Inference time: " << total.count() << std::endl;
-    }
-    catch (const std::exception& error) {
-        std::cerr << "[ ERROR ] " << error.what() << std::endl;
-        return;
-    }
-    catch (...) {
-        std::cerr << "[ ERROR ] Unknown/internal exception happened." << std::endl;
-        return;
+        auto t0 = std::chrono::steady_clock::now();
+        PlannerDecision decision = planner.step(world);
+        controlChannel.update([&](ControlState& state)
+        {
+            state.speed = decision.speed;
+            state.stopOn = decision.stopOn;
+            if (decision.steerValid)
+                state.steer = decision.steer;
+        });
+        if (plannerStep >= 0)
+            lockStep.finish(plannerStep, world.frameId);
+        auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - t0).count();
+        latency.observe(elapsedUs / 1000.0);
+
+        if (elapsedUs > params.budgetUs)
+            slog::warn << slog::every(budgetReport) << __func__ << " step took " << elapsedUs
+                       << " us, budget " << params.budgetUs << " us" << slog::endl;
+
+        if (decision.state != lastState)
+        {
+            slog::info << __func__ << " frame " << world.frameId << " " << driveStateName(lastState)
+                       << " -> " << driveStateName(decision.state) << " speed " << decision.speed
+                       << " limit " << planner.getSpeedLimit() << slog::endl;
+            lastState = decision.state;
+        }
     }
-
-    slog::info << "Execution successful" << slog::endl;
-
-    return;
 }
 
 void arduinoI2C()
 {
-    DeltaTimer timer;
-    timer.resetDeltaTimer();
+    slog::RateLimit staleReport(std::chrono::seconds(1));
 
-    std::cout << __func__ << " I2C: Connecting\n"  << std::endl;
+    Counter& writes = metrics.counter("autopilot_vehicle_writes_total", "Commands written to the vehicle link");
+    Counter& writeErrors = metrics.counter("autopilot_vehicle_write_errors_total", "Commands the vehicle link failed to write");
+    Counter& staleCommands = metrics.counter("autopilot_vehicle_stale_total", "Fail safe stops sent on a stale control state");
 
-    if ((I2CFileStream = open(devName, O_RDWR)) < 0)
+    // Sleeps until the next 1/-actuator_rate_hz deadline or until a new command is published
+    actuatorLoop->run([&]()
     {
-        std::cerr << __func__ << " I2C: Failed to access " << devName << std::endl;
-        exit(1);
-    }
-
-    std::cout << " I2C: acquiring buss to " << std::hex << ADDRESS << std::endl;
+        ControlState state = controlChannel.read();
+        VehicleCommand command = state.toCommand();
 
-    if (ioctl(I2CFileStream, I2C_SLAVE, ADDRESS) < 0)
-    {
-        std::cerr << __func__ << " I2C: Failed to acquire bus access/talk to slave "
-                  << std::hex << ADDRESS << std::endl;
-        exit(1);
-    }
-
-    uint8_t cmd[6] = {0, 0, 0, 0, 0, 0};
-
-    while(1)
-    {
-        if(timer.getDeltaTimeMs() >= 50)
+        if (state.isStale(ControlChannel::nowNs(), CONTROL_DEADLINE_MS * 1000000ULL))
         {
-            timer.resetDeltaTimer();
-
-            cmd[0] = SPEED_VALUE_FLAG;
-            cmd[1] = speed >> 8;
-            cmd[2] = speed;
-            cmd[3] = DIR_VALUE_FLAG;
-            cmd[4] = steer;
-
-            if(lightsOn){
-                setBit(cmd[5], 0);
-            } else {
-                clearBit(cmd[5], 0);
-            }
-
-            if(stopOn){
-                setBit(cmd[5], 1);
-            } else {
-                clearBit(cmd[5], 1);
-            }
-
-            #if ARDUINO_DEBUG
-            std::cout << __func__ << " Sending " <<
-                    std::hex << (short)cmd[0] << " | " <<
-                    std::dec << (short)((cmd[1] << 8)  + cmd[2]) << " | " <<
-                    std::hex << (short)cmd[3] << " | " <<
-                    std::dec << (int)cmd[4] << " | " <<
-                    std::hex << (short)cmd[5] << std::endl;
-            #endif
-
-            uint16_t numBytes = write(I2CFileStream, cmd, 6);
-
-            #if ARDUINO_DEBUG
-            if (numBytes == 6)
-                cout << __func__ << " succeeded" << endl;
-            #else
-            unused(numBytes);
-            #endif
+            // Nobody is steering, fail safe
+            command.speed = 0;
+            command.stopOn = true;
+            staleCommands.add();
+            slog::warn << slog::every(staleReport) << __func__ << " control state version "
+                       << state.version << " is stale, stopping" << slog::endl;
         }
-    }
+
+        #if ARDUINO_DEBUG
+        slog::info << __func__ << " Sending " <<
+                command.speed << " | " <<
+                (int)command.steer << " | " <<
+                command.lightsOn << " | " <<
+                command.stopOn << slog::endl;
+        #endif
+
+        if (driveLog)
+            driveLog->logCommand(ControlChannel::nowNs(), command, state.version);
+        const bool sent = vehicleLink->send(command);
+        writes.add();
+        if (!sent)
+            writeErrors.add();
+        if (actuatorStep >= 0)
+            lockStep.finish(actuatorStep, state.version);
+        return sent;
+    });
     return;
 }
 
@@ -625,5 +899,23 @@ int8_t constrainValue(int8_t val, int8_t a, int8_t b)
 
 void exitRoutine (void)
 {
-    close(I2CFileStream);
+    if (metricsServer)
+        metricsServer->close();
+    if (actuatorLoop)
+        actuatorLoop->logJitterStats();
+    slog::info << "Thread CPU time:\n" << threadLauncher.cpuTimeReport() << slog::endl;
+    if (FLAGS_scheduler_enable)
+        slog::info << "Stage scheduler:\n" << stageScheduler.summary() << slog::endl;
+    if (driveLog)
+    {
+        driveLog->close();
+        slog::info << "Drive log " << driveLog->getPath() << ": " << driveLog->getQueued() << " records, "
+                   << driveLog->getDropped() << " dropped, " << driveLog->getBytes() << " bytes" << slog::endl;
+    }
+    if (videoSink)
+    {
+        videoSink->close();
+        slog::info << "Video " << videoSink->getPath() << ": " << videoSink->getEncoded() << " of "
+                   << videoSink->getSubmitted() << " frames encoded, " << videoSink->getDropped() << " dropped" << slog::endl;
+    }
 }
\ No newline at end of file
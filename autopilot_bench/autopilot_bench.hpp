@@ -0,0 +1,45 @@
+/*
+ * autopilot_bench.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <gflags/gflags.h>
+#include <iostream>
+#include "../autopilot/include/AutoPilotFlags.h"
+
+/// @brief message for the number of frames
+static const char frames_message[] = "Optional. Stop after this many frames (0 - whole input).";
+
+/// @brief message for warm-up frames
+static const char warmup_message[] = "Optional. Frames processed before measurements start.";
+
+/// @brief message for the queue depth
+static const char queue_depth_message[] = "Optional. Frames buffered in front of each stage.";
+
+/// @brief message for the report file
+static const char report_message[] = "Optional. Path of the JSON report (default - standard output).";
+
+DEFINE_uint32(frames, 0, frames_message);
+DEFINE_uint32(warmup, 10, warmup_message);
+DEFINE_uint32(queue_depth, 4, queue_depth_message);
+DEFINE_string(report, "", report_message);
+
+/**
+* @brief This function show a help message
+*/
+static void showBenchUsage() {
+    std::cout << std::endl;
+    std::cout << "autopilot_bench [OPTION]" << std::endl;
+    std::cout << "Runs the selected stages over a video file or an image directory as fast as possible." << std::endl;
+    std::cout << "Accepts every autopilot option, models run on CPU unless -cars_device/-traffic_device say otherwise." << std::endl;
+    std::cout << std::endl;
+    std::cout << "    -frames                        " << frames_message << std::endl;
+    std::cout << "    -warmup                        " << warmup_message << std::endl;
+    std::cout << "    -queue_depth                   " << queue_depth_message << std::endl;
+    std::cout << "    -report \"<path>\"               " << report_message << std::endl;
+    showUsage();
+}
@@ -0,0 +1,574 @@
+/*
+ * main.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ *
+ * Offline benchmark: runs the AutoPilot stages over a recorded input without frame
+ * dropping and reports throughput, stage latencies, CPU use and peak RSS as JSON.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <time.h>
+#include <samples/slog.hpp>
+#include "autopilot_bench.hpp"
+#include "../autopilot/include/ConfigFile.h"
+#include "../autopilot/include/ConfigFile.cpp"
+#include "../autopilot/include/BoundedQueue.h"
+#include "../autopilot/include/Percentile.h"
+#include "../autopilot/include/Detection.h"
+#include "../autopilot/include/Detection.cpp"
+#include "../autopilot/include/WorldModel.h"
+#include "../autopilot/include/WorldModel.cpp"
+#include "../autopilot/include/BehaviourPlanner.h"
+#include "../autopilot/include/BehaviourPlanner.cpp"
+#include "../autopilot/include/DetectionDecoder.h"
+#include "../autopilot/include/DetectionDecoder.cpp"
+#include "../autopilot/include/SSDDetector.h"
+#include "../autopilot/include/SSDDetector.cpp"
+#include "../autopilot/include/FrameSource.h"
+#include "../autopilot/include/FrameSource.cpp"
+#include "../autopilot/include/LaneDetector.hpp"
+#include "../autopilot/include/LaneDetector.cpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs(Clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+static double timespecMs(const timespec& ts)
+{
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static double threadCpuMs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return timespecMs(ts);
+}
+
+static std::string jsonString(const std::string& text)
+{
+    std::string quoted = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+/*
+ * Latency samples of one stage, each instance is written by a single thread
+ */
+class LatencyStats
+{
+private:
+    std::vector<double> samples;
+public:
+    void add(double ms)
+    {
+        samples.push_back(ms);
+    }
+
+    void writeJson(std::ostream& out) const
+    {
+        std::vector<double> sorted(samples);
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&](double p) {
+            return sorted.empty() ? 0 : nearestRank(sorted, p / 100);
+        };
+        double sum = 0;
+        for (double sample : sorted)
+            sum += sample;
+
+        out << "{\"count\": " << sorted.size()
+            << ", \"mean_ms\": " << (sorted.empty() ? 0 : sum / sorted.size())
+            << ", \"p50_ms\": " << percentile(50)
+            << ", \"p90_ms\": " << percentile(90)
+            << ", \"p99_ms\": " << percentile(99)
+            << ", \"max_ms\": " << (sorted.empty() ? 0 : sorted.back()) << "}";
+    }
+};
+
+struct ThreadUsage
+{
+    std::string name;
+    double cpuMs;
+    double wallMs;
+};
+
+class ThreadUsageLog
+{
+private:
+    std::mutex mtx;
+    std::vector<ThreadUsage> threads;
+public:
+    void add(const ThreadUsage& usage)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        threads.push_back(usage);
+    }
+
+    std::vector<ThreadUsage> get()
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return threads;
+    }
+};
+
+/*
+ * CPU and wall time of the calling thread from construction to destruction
+ */
+class ThreadMeter
+{
+private:
+    ThreadUsageLog& log;
+    std::string name;
+    double cpuStart;
+    Clock::time_point wallStart;
+public:
+    ThreadMeter(ThreadUsageLog& log, const std::string& name):
+        log(log),
+        name(name),
+        cpuStart(threadCpuMs()),
+        wallStart(Clock::now())
+    {
+    }
+
+    ~ThreadMeter()
+    {
+        log.add({name, threadCpuMs() - cpuStart, elapsedMs(wallStart)});
+    }
+};
+
+struct FramePacket
+{
+    uint64_t id;
+    Clock::time_point captured;
+    cv::Mat frame;
+};
+typedef std::shared_ptr<const FramePacket> FramePtr;
+
+struct StageOutput
+{
+    uint64_t frameId = 0;
+    Clock::time_point captured;
+    LaneState lane;
+    DetectionSet detections;
+};
+
+enum class StageKind
+{
+    Lanes,
+    Cars,
+    Traffic
+};
+
+struct Stage
+{
+    StageKind kind;
+    std::string name;
+    BoundedQueue<FramePtr> input;
+    BoundedQueue<StageOutput> output;
+    // Set by the stage thread when it gave up, the report would be partial
+    std::atomic<bool> failed;
+
+    Stage(StageKind kind, const std::string& name, size_t depth):
+        kind(kind),
+        name(name),
+        input(depth),
+        output(depth),
+        failed(false)
+    {
+    }
+
+    void abort()
+    {
+        input.close();
+        output.close();
+    }
+};
+
+std::map<std::string, LatencyStats> latencies;
+ThreadUsageLog threadUsage;
+
+static bool measured(uint64_t frameId)
+{
+    return frameId > FLAGS_warmup;
+}
+
+void captureFrames(FrameSource& source, std::vector<std::unique_ptr<Stage>>& stages)
+{
+    ThreadMeter meter(threadUsage, "capture");
+    LatencyStats& captureStats = latencies.at("capture");
+
+    for (uint64_t id = 1; FLAGS_frames == 0 || id <= FLAGS_frames; ++id)
+    {
+        std::shared_ptr<FramePacket> packet(new FramePacket());
+        packet->id = id;
+        packet->captured = Clock::now();
+        if (!source.read(packet->frame))
+            break;
+        if (measured(id))
+            captureStats.add(elapsedMs(packet->captured));
+
+        bool delivered = true;
+        for (auto& stage : stages)
+            delivered = stage->input.push(packet) && delivered;
+        if (!delivered)
+            break;
+    }
+
+    for (auto& stage : stages)
+        stage->input.close();
+}
+
+void runLanes(Stage& stage, size_t width, size_t height)
+{
+    ThreadMeter meter(threadUsage, stage.name);
+    LatencyStats& laneStats = latencies.at(stage.name);
+
+    LaneParams params;
+    params.lineThreshold = FLAGS_lanes_line_threshold;
+    params.maxIterations = FLAGS_lanes_max_iterations;
+    params.histHeight = FLAGS_lanes_hist_height;
+    params.slices = FLAGS_lanes_slices;
+    params.quadRatio = FLAGS_lanes_quad_ratio;
+    LaneDetector laneDetector(FLAGS_lanes_resize, width, height, params);
+
+    FramePtr packet;
+    while (stage.input.pop(packet))
+    {
+        auto t0 = Clock::now();
+        cv::Mat frame = packet->frame;
+        laneDetector.runCurvePipeline(frame);
+
+        StageOutput output;
+        output.frameId = packet->id;
+        output.captured = packet->captured;
+        output.lane.steeringAngle = laneDetector.getSteeringAngle();
+        output.lane.valid = laneDetector.lanesFound();
+        output.lane.frameId = packet->id;
+        if (measured(packet->id))
+            laneStats.add(elapsedMs(t0));
+
+        if (!stage.output.push(std::move(output)))
+            break;
+    }
+    stage.output.close();
+}
+
+void runDetector(Stage& stage, const SSDParams& params, size_t width, size_t height)
+{
+    ThreadMeter meter(threadUsage, stage.name);
+    LatencyStats& totalStats = latencies.at(stage.name);
+    LatencyStats& preprocessStats = latencies.at(stage.name + ".preprocess");
+    LatencyStats& inferStats = latencies.at(stage.name + ".infer");
+    LatencyStats& decodeStats = latencies.at(stage.name + ".decode");
+
+    try {
+        SSDDetector detector(params);
+
+        FramePtr packet;
+        while (stage.input.pop(packet))
+        {
+            auto t0 = Clock::now();
+            detector.preprocess(packet->frame);
+            auto t1 = Clock::now();
+            if (!detector.infer())
+                throw std::logic_error(stage.name + " inference failed");
+            auto t2 = Clock::now();
+
+            StageOutput output;
+            output.frameId = packet->id;
+            output.captured = packet->captured;
+            output.detections.frameId = packet->id;
+            detector.decode(width, height, output.detections);
+
+            if (measured(packet->id))
+            {
+                typedef std::chrono::duration<double, std::milli> ms;
+                preprocessStats.add(std::chrono::duration_cast<ms>(t1 - t0).count());
+                inferStats.add(std::chrono::duration_cast<ms>(t2 - t1).count());
+                decodeStats.add(elapsedMs(t2));
+                totalStats.add(elapsedMs(t0));
+            }
+
+            if (!stage.output.push(std::move(output)))
+                break;
+        }
+    }
+    catch (const std::exception& error) {
+        slog::err << stage.name << ": " << error.what() << slog::endl;
+        stage.failed = true;
+        stage.abort();
+        return;
+    }
+    stage.output.close();
+}
+
+void writeReport(std::ostream& out, const FrameSource& source, uint64_t frames, double wallMs,
+                 double processCpuMs, long peakRssKb)
+{
+    out << std::fixed << std::setprecision(3);
+    out << "{" << std::endl;
+    out << "  \"input\": " << jsonString(source.name()) << "," << std::endl;
+    out << "  \"resolution\": [" << source.width() << ", " << source.height() << "]," << std::endl;
+    out << "  \"stages\": [";
+    const char* separator = "";
+    if (FLAGS_lanes_enable) { out << separator << "\"lanes\""; separator = ", "; }
+    if (FLAGS_cars_enable) { out << separator << "\"cars\""; separator = ", "; }
+    if (FLAGS_traffic_enable) { out << separator << "\"traffic\""; separator = ", "; }
+    if (FLAGS_planner_enable) { out << separator << "\"planner\""; }
+    out << "]," << std::endl;
+    out << "  \"devices\": {\"cars\": " << jsonString(FLAGS_cars_device)
+        << ", \"traffic\": " << jsonString(FLAGS_traffic_device) << "}," << std::endl;
+    out << "  \"warmup_frames\": " << FLAGS_warmup << "," << std::endl;
+    out << "  \"frames\": " << frames << "," << std::endl;
+    out << "  \"wall_ms\": " << wallMs << "," << std::endl;
+    out << "  \"throughput_fps\": " << (wallMs > 0 ? frames * 1000 / wallMs : 0) << "," << std::endl;
+
+    out << "  \"latency\": {" << std::endl;
+    separator = "";
+    for (auto& stats : latencies)
+    {
+        out << separator << "    " << jsonString(stats.first) << ": ";
+        stats.second.writeJson(out);
+        separator = ",\n";
+    }
+    out << std::endl << "  }," << std::endl;
+
+    out << "  \"threads\": [" << std::endl;
+    separator = "";
+    for (auto& usage : threadUsage.get())
+    {
+        out << separator << "    {\"name\": " << jsonString(usage.name)
+            << ", \"cpu_ms\": " << usage.cpuMs
+            << ", \"wall_ms\": " << usage.wallMs
+            << ", \"utilization\": " << (usage.wallMs > 0 ? usage.cpuMs / usage.wallMs : 0) << "}";
+        separator = ",\n";
+    }
+    out << std::endl << "  ]," << std::endl;
+
+    // Inference plugins run their own worker threads, only the process total accounts for them
+    out << "  \"process\": {\"cpu_ms\": " << processCpuMs
+        << ", \"utilization\": " << (wallMs > 0 ? processCpuMs / wallMs : 0)
+        << ", \"peak_rss_kb\": " << peakRssKb << "}" << std::endl;
+    out << "}" << std::endl;
+}
+
+bool ParseAndCheckCommandLine(int argc, char *argv[]) {
+    // The benchmark runs every stage on the CPU plugin unless told otherwise
+    gflags::SetCommandLineOptionWithMode("cars_device", "CPU", gflags::SET_FLAGS_DEFAULT);
+    gflags::SetCommandLineOptionWithMode("traffic_device", "CPU", gflags::SET_FLAGS_DEFAULT);
+    gflags::SetCommandLineOptionWithMode("lanes_enable", "true", gflags::SET_FLAGS_DEFAULT);
+
+    gflags::ParseCommandLineNonHelpFlags(&argc, &argv, true);
+    if (FLAGS_h) {
+        showBenchUsage();
+        return false;
+    }
+
+    if (!FLAGS_config.empty()) {
+        loadConfigFile(FLAGS_config);
+    }
+
+    if (FLAGS_i == "cam") {
+        throw std::logic_error("Parameter -i should be a video file or an image directory");
+    }
+    if (!FLAGS_lanes_enable && !FLAGS_cars_enable && !FLAGS_traffic_enable) {
+        throw std::logic_error("Enable at least one of -lanes_enable, -cars_enable, -traffic_enable");
+    }
+    if (FLAGS_queue_depth == 0) {
+        throw std::logic_error("Parameter -queue_depth should be greater than 0");
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    try {
+        if (!ParseAndCheckCommandLine(argc, argv)) {
+            return 0;
+        }
+
+        ImageDecodeParams decode;
+        decode.threads = FLAGS_input_decode_threads;
+        decode.prefetch = FLAGS_input_prefetch;
+        decode.minSize = cv::Size(FLAGS_input_min_width, FLAGS_input_min_height);
+        std::unique_ptr<FrameSource> source = createFrameSource(FLAGS_i, decode);
+        const size_t width = source->width();
+        const size_t height = source->height();
+
+        std::vector<std::unique_ptr<Stage>> stages;
+        if (FLAGS_lanes_enable)
+            stages.emplace_back(new Stage(StageKind::Lanes, "lanes", FLAGS_queue_depth));
+        if (FLAGS_cars_enable)
+            stages.emplace_back(new Stage(StageKind::Cars, "cars", FLAGS_queue_depth));
+        if (FLAGS_traffic_enable)
+            stages.emplace_back(new Stage(StageKind::Traffic, "traffic", FLAGS_queue_depth));
+
+        // Create every recorder before the threads start, the map is only read afterwards
+        latencies["capture"];
+        LatencyStats& endToEndStats = latencies["end_to_end"];
+        LatencyStats plannerDisabled;
+        LatencyStats& plannerStats = FLAGS_planner_enable ? latencies["planner"] : plannerDisabled;
+        for (auto& stage : stages)
+        {
+            latencies[stage->name];
+            if (stage->kind != StageKind::Lanes)
+            {
+                latencies[stage->name + ".preprocess"];
+                latencies[stage->name + ".infer"];
+                latencies[stage->name + ".decode"];
+            }
+        }
+
+        std::vector<std::thread> threads;
+        for (auto& stage : stages)
+        {
+            SSDParams params;
+            switch (stage->kind)
+            {
+            case StageKind::Lanes:
+                threads.emplace_back(runLanes, std::ref(*stage), width, height);
+                continue;
+            case StageKind::Cars:
+                params.model = FLAGS_cars_model;
+                params.device = FLAGS_cars_device;
+                params.threshold = FLAGS_cars_threshold;
+                params.nthreads = FLAGS_cars_nthreads;
+                params.nmsIou = FLAGS_cars_nms_iou;
+                params.regions = parseRegions(FLAGS_cars_regions);
+                break;
+            case StageKind::Traffic:
+                params.model = FLAGS_traffic_model;
+                params.device = FLAGS_traffic_device;
+                params.threshold = FLAGS_traffic_threshold;
+                params.nthreads = FLAGS_traffic_nthreads;
+                params.nmsIou = FLAGS_traffic_nms_iou;
+                params.regions = parseRegions(FLAGS_traffic_regions);
+                break;
+            }
+            threads.emplace_back(runDetector, std::ref(*stage), params, width, height);
+        }
+        threads.emplace_back(captureFrames, std::ref(*source), std::ref(stages));
+
+        // ---------------------------Join the stages and plan, in frame order--------------------------------
+        PlannerParams plannerParams;
+        plannerParams.cruiseSpeed = FLAGS_planner_cruise_speed;
+        plannerParams.slowSpeed = FLAGS_planner_slow_speed;
+        plannerParams.onFrames = FLAGS_planner_on_frames;
+        plannerParams.offFrames = FLAGS_planner_off_frames;
+        plannerParams.stopHoldFrames = FLAGS_planner_stop_hold_frames;
+        BehaviourPlanner planner(plannerParams, width, height);
+
+        WorldSnapshot world;
+        uint64_t frames = 0;
+        Clock::time_point measureStart = Clock::now();
+        rusage usageStart;
+        getrusage(RUSAGE_SELF, &usageStart);
+
+        {
+            ThreadMeter meter(threadUsage, "main");
+            while (true)
+            {
+                StageOutput output;
+                Clock::time_point captured;
+                bool complete = true;
+                for (auto& stage : stages)
+                {
+                    if (!stage->output.pop(output))
+                    {
+                        complete = false;
+                        break;
+                    }
+                    world.frameId = output.frameId;
+                    captured = output.captured;
+                    if (stage->kind == StageKind::Lanes)
+                        world.lane = output.lane;
+                    else
+                        world.detections[(size_t)(stage->kind == StageKind::Cars ? DetectorId::Cars : DetectorId::Traffic)] =
+                            std::move(output.detections);
+                }
+                if (!complete)
+                    break;
+
+                if (FLAGS_planner_enable)
+                {
+                    auto t0 = Clock::now();
+                    planner.step(world);
+                    if (measured(world.frameId))
+                        plannerStats.add(elapsedMs(t0));
+                }
+
+                if (!measured(world.frameId))
+                {
+                    // Measurements start once the last warm-up frame is through
+                    measureStart = Clock::now();
+                    getrusage(RUSAGE_SELF, &usageStart);
+                    continue;
+                }
+                endToEndStats.add(elapsedMs(captured));
+                ++frames;
+            }
+        }
+        double wallMs = elapsedMs(measureStart);
+
+        for (auto& stage : stages)
+            stage->abort();
+        for (auto& thread : threads)
+            thread.join();
+        for (auto& stage : stages)
+            if (stage->failed)
+                throw std::logic_error("Stage " + stage->name + " failed, no report written");
+
+        rusage usageEnd;
+        getrusage(RUSAGE_SELF, &usageEnd);
+        double processCpuMs = (usageEnd.ru_utime.tv_sec - usageStart.ru_utime.tv_sec) * 1e3 +
+                              (usageEnd.ru_utime.tv_usec - usageStart.ru_utime.tv_usec) / 1e3 +
+                              (usageEnd.ru_stime.tv_sec - usageStart.ru_stime.tv_sec) * 1e3 +
+                              (usageEnd.ru_stime.tv_usec - usageStart.ru_stime.tv_usec) / 1e3;
+
+        if (frames == 0)
+            slog::warn << "No frames measured, the input is not longer than -warmup" << slog::endl;
+
+        if (FLAGS_report.empty()) {
+            writeReport(std::cout, *source, frames, wallMs, processCpuMs, usageEnd.ru_maxrss);
+        } else {
+            std::ofstream report(FLAGS_report);
+            if (!report)
+                throw std::logic_error("Cannot write " + FLAGS_report);
+            writeReport(report, *source, frames, wallMs, processCpuMs, usageEnd.ru_maxrss);
+            slog::info << "Report written to " << FLAGS_report << slog::endl;
+        }
+    }
+    catch (const std::exception& error) {
+        slog::err << error.what() << slog::endl;
+        slog::flush();
+        return 1;
+    }
+    catch (...) {
+        slog::err << "Unknown/internal exception happened." << slog::endl;
+        slog::flush();
+        return 1;
+    }
+
+    slog::flush();
+    return 0;
+}
@@ -0,0 +1,64 @@
+/*
+ * autopilot_eval.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <gflags/gflags.h>
+#include <iostream>
+#include "../autopilot/include/AutoPilotFlags.h"
+
+/// @brief message for the evaluated detector
+static const char detector_message[] = "Optional. Detector to evaluate: \"cars\" or \"traffic\".";
+
+/// @brief message for the annotations
+static const char annotations_message[] = "Optional. A CSV file (image,label,xmin,ymin,xmax,ymax[,difficult]) "
+"or a directory of Pascal VOC .xml files (default - the VOC files next to the images).";
+
+/// @brief message for the IoU threshold
+static const char iou_message[] = "Optional. Minimum intersection over union for a detection to match an object.";
+
+/// @brief message for the confidence floor
+static const char min_confidence_message[] = "Optional. Detections below this confidence are dropped before matching "
+"(replaces -cars_threshold/-traffic_threshold, which would cut the precision-recall curve short).";
+
+/// @brief message for the input scale
+static const char input_scale_message[] = "Optional. Scale applied to every image before inference, "
+"to see what a lower capture resolution costs.";
+
+/// @brief message for frame skipping
+static const char frame_skip_message[] = "Optional. Run inference on every (N+1)-th image only and reuse its detections "
+"for the next N, as a pipeline that skips frames would. Meaningful for image sequences.";
+
+/// @brief message for the report file
+static const char report_message[] = "Optional. Path of the JSON report (default - standard output).";
+
+DEFINE_string(detector, "cars", detector_message);
+DEFINE_string(annotations, "", annotations_message);
+DEFINE_double(iou, 0.5, iou_message);
+DEFINE_double(min_confidence, 0.01, min_confidence_message);
+DEFINE_double(input_scale, 1.0, input_scale_message);
+DEFINE_uint32(frame_skip, 0, frame_skip_message);
+DEFINE_string(report, "", report_message);
+
+/**
+* @brief This function show a help message
+*/
+static void showEvalUsage() {
+    std::cout << std::endl;
+    std::cout << "autopilot_eval [OPTION]" << std::endl;
+    std::cout << "Runs one detector over an annotated image directory and reports AP per class, mAP and throughput." << std::endl;
+    std::cout << "Accepts every autopilot option, models run on CPU unless -cars_device/-traffic_device say otherwise." << std::endl;
+    std::cout << std::endl;
+    std::cout << "    -detector \"<name>\"             " << detector_message << std::endl;
+    std::cout << "    -annotations \"<path>\"          " << annotations_message << std::endl;
+    std::cout << "    -iou                           " << iou_message << std::endl;
+    std::cout << "    -min_confidence                " << min_confidence_message << std::endl;
+    std::cout << "    -input_scale                   " << input_scale_message << std::endl;
+    std::cout << "    -frame_skip                    " << frame_skip_message << std::endl;
+    std::cout << "    -report \"<path>\"               " << report_message << std::endl;
+    showUsage();
+}
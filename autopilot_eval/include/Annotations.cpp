@@ -0,0 +1,149 @@
+/*
+ * Annotations.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "Annotations.h"
+
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+std::string imageKey(const std::string& path)
+{
+	size_t slash = path.find_last_of('/');
+	std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+	size_t dot = name.rfind('.');
+	return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+static std::string trim(const std::string& text)
+{
+	const char* blanks = " \t\r\n";
+	size_t begin = text.find_first_not_of(blanks);
+	if (begin == std::string::npos)
+		return "";
+	return text.substr(begin, text.find_last_not_of(blanks) - begin + 1);
+}
+
+// Text of the first <tag> between from and to, "" if there is none
+static std::string tagValue(const std::string& xml, const std::string& tag, size_t from, size_t to)
+{
+	const std::string open = "<" + tag + ">", close = "</" + tag + ">";
+	size_t begin = xml.find(open, from);
+	if (begin == std::string::npos || begin >= to)
+		return "";
+	begin += open.size();
+	size_t end = xml.find(close, begin);
+	if (end == std::string::npos || end > to)
+		return "";
+	return trim(xml.substr(begin, end - begin));
+}
+
+static float toFloat(const std::string& text, const std::string& where)
+{
+	try {
+		return std::stof(text);
+	}
+	catch (const std::exception&) {
+		throw std::logic_error(where + ": \"" + text + "\" is not a number");
+	}
+}
+
+static std::vector<GroundTruthObject> readVocFile(const std::string& path)
+{
+	std::ifstream file(path);
+	if (!file)
+		throw std::logic_error("Cannot open " + path);
+	std::stringstream content;
+	content << file.rdbuf();
+	const std::string xml = content.str();
+
+	std::vector<GroundTruthObject> objects;
+	for (size_t begin = xml.find("<object>"); begin != std::string::npos; begin = xml.find("<object>", begin + 1))
+	{
+		size_t end = xml.find("</object>", begin);
+		if (end == std::string::npos)
+			throw std::logic_error(path + ": unterminated <object>");
+
+		GroundTruthObject object;
+		object.label = tagValue(xml, "name", begin, end);
+		object.xmin = toFloat(tagValue(xml, "xmin", begin, end), path);
+		object.ymin = toFloat(tagValue(xml, "ymin", begin, end), path);
+		object.xmax = toFloat(tagValue(xml, "xmax", begin, end), path);
+		object.ymax = toFloat(tagValue(xml, "ymax", begin, end), path);
+		object.difficult = tagValue(xml, "difficult", begin, end) == "1";
+		objects.push_back(object);
+	}
+	return objects;
+}
+
+Annotations readVocAnnotations(const std::string& directory)
+{
+	DIR *dp = opendir(directory.c_str());
+	if (dp == nullptr)
+		throw std::logic_error("Cannot open annotations directory " + directory);
+
+	Annotations annotations;
+	struct dirent *ep;
+	while (nullptr != (ep = readdir(dp)))
+	{
+		std::string fileName = ep->d_name;
+		if (fileName.size() < 4 || fileName.compare(fileName.size() - 4, 4, ".xml") != 0)
+			continue;
+		annotations[imageKey(fileName)] = readVocFile(directory + "/" + fileName);
+	}
+	closedir(dp);
+	return annotations;
+}
+
+Annotations readCsvAnnotations(const std::string& path)
+{
+	std::ifstream file(path);
+	if (!file)
+		throw std::logic_error("Cannot open " + path);
+
+	Annotations annotations;
+	std::string line;
+	for (size_t lineNum = 1; std::getline(file, line); ++lineNum)
+	{
+		line = trim(line);
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		std::vector<std::string> fields;
+		std::stringstream stream(line);
+		std::string field;
+		while (std::getline(stream, field, ','))
+			fields.push_back(trim(field));
+
+		if (lineNum == 1 && fields[0] == "image")
+			continue;
+
+		const std::string where = path + ":" + std::to_string(lineNum);
+		std::vector<GroundTruthObject>& objects = annotations[imageKey(fields[0])];
+		if (fields.size() == 1 || (fields.size() > 1 && fields[1].empty()))
+			continue;
+		if (fields.size() < 6)
+			throw std::logic_error(where + ": expected image,label,xmin,ymin,xmax,ymax[,difficult]");
+
+		GroundTruthObject object;
+		object.label = fields[1];
+		object.xmin = toFloat(fields[2], where);
+		object.ymin = toFloat(fields[3], where);
+		object.xmax = toFloat(fields[4], where);
+		object.ymax = toFloat(fields[5], where);
+		object.difficult = fields.size() > 6 && fields[6] == "1";
+		objects.push_back(object);
+	}
+	return annotations;
+}
+
+Annotations readAnnotations(const std::string& path)
+{
+	if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0)
+		return readCsvAnnotations(path);
+	return readVocAnnotations(path);
+}
@@ -0,0 +1,42 @@
+/*
+ * Annotations.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+struct GroundTruthObject
+{
+	std::string label;
+	float xmin, ymin, xmax, ymax;    // pixels
+	bool difficult;
+};
+
+/*
+ * Ground truth per image, keyed by the image file name without directory and extension
+ */
+typedef std::map<std::string, std::vector<GroundTruthObject>> Annotations;
+
+/*
+ * A directory of Pascal VOC .xml files, one per image
+ */
+Annotations readVocAnnotations(const std::string& directory);
+
+/*
+ * One object per line: image,label,xmin,ymin,xmax,ymax[,difficult]. An image with only
+ * "image" on its line has no objects. A first line starting with "image" is a header.
+ */
+Annotations readCsvAnnotations(const std::string& path);
+
+/*
+ * .csv files are read as CSV, anything else as a VOC directory. Throws std::logic_error.
+ */
+Annotations readAnnotations(const std::string& path);
+
+std::string imageKey(const std::string& path);
@@ -0,0 +1,288 @@
+/*
+ * main.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ *
+ * Accuracy check: runs one detector over an annotated image directory and reports the
+ * average precision per class, the mAP and the throughput as JSON, so that a speed
+ * optimization can be shown not to cost detection quality.
+ */
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <opencv2/imgcodecs/imgcodecs.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <samples/common.hpp>
+#include <samples/args_helper.hpp>
+#include <samples/slog.hpp>
+#include "autopilot_eval.hpp"
+#include "include/Annotations.h"
+#include "include/Annotations.cpp"
+#include "../autopilot/include/ConfigFile.h"
+#include "../autopilot/include/ConfigFile.cpp"
+#include "../autopilot/include/Detection.h"
+#include "../autopilot/include/Detection.cpp"
+#include "../autopilot/include/DetectionDecoder.h"
+#include "../autopilot/include/DetectionDecoder.cpp"
+#include "../autopilot/include/SSDDetector.h"
+#include "../autopilot/include/SSDDetector.cpp"
+#include "../autopilot/include/FrameSource.h"
+#include "../autopilot/include/FrameSource.cpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs(Clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+static std::string jsonString(const std::string& text)
+{
+    std::string quoted = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+struct EvalCounters
+{
+    size_t images = 0;            // evaluated
+    size_t inferred = 0;          // evaluated and run through the network, the rest reused detections
+    size_t unannotated = 0;       // skipped, no ground truth
+    size_t unknownObjects = 0;    // ground truth with a label the model does not have
+    double preprocessMs = 0, inferMs = 0, decodeMs = 0;
+    std::map<int, size_t> groundTruth;    // non-difficult objects per label
+    std::map<int, size_t> detections;     // per label
+};
+
+static void writeReport(std::ostream& out, const SSDDetector& detector, const EvalCounters& counters,
+                        const std::map<int, double>& averagePrecision)
+{
+    std::set<int> labels;
+    for (auto& entry : counters.groundTruth)
+        labels.insert(entry.first);
+    for (auto& entry : counters.detections)
+        labels.insert(entry.first);
+
+    // Classes without ground truth have no recall to speak of and stay out of the mAP
+    double apSum = 0;
+    size_t apClasses = 0;
+
+    out << std::fixed << std::setprecision(4);
+    out << "{" << std::endl;
+    out << "  \"detector\": " << jsonString(FLAGS_detector)
+        << ", \"model\": " << jsonString(FLAGS_detector == "cars" ? FLAGS_cars_model : FLAGS_traffic_model)
+        << ", \"device\": " << jsonString(detector.getDevice()) << "," << std::endl;
+    out << "  \"settings\": {\"iou\": " << FLAGS_iou << ", \"min_confidence\": " << FLAGS_min_confidence
+        << ", \"input_scale\": " << FLAGS_input_scale << ", \"frame_skip\": " << FLAGS_frame_skip << "}," << std::endl;
+    out << "  \"images\": {\"evaluated\": " << counters.images << ", \"inferred\": " << counters.inferred
+        << ", \"unannotated\": " << counters.unannotated
+        << ", \"unknown_objects\": " << counters.unknownObjects << "}," << std::endl;
+    out << "  \"classes\": {";
+    const char* separator = "";
+    for (int label : labels)
+    {
+        auto gt = counters.groundTruth.find(label);
+        auto det = counters.detections.find(label);
+        auto ap = averagePrecision.find(label);
+        const size_t gtCount = gt == counters.groundTruth.end() ? 0 : gt->second;
+        const double apValue = ap == averagePrecision.end() ? 0 : ap->second;
+
+        out << separator << std::endl << "    " << jsonString(detector.labelName(label))
+            << ": {\"ground_truth\": " << gtCount
+            << ", \"detections\": " << (det == counters.detections.end() ? 0 : det->second);
+        if (gtCount > 0)
+        {
+            out << ", \"ap\": " << apValue;
+            apSum += apValue;
+            ++apClasses;
+        }
+        out << "}";
+        separator = ",";
+    }
+    out << std::endl << "  }," << std::endl;
+    out << "  \"map\": " << (apClasses > 0 ? apSum / apClasses : 0) << "," << std::endl;
+
+    const double inferenceMs = counters.preprocessMs + counters.inferMs + counters.decodeMs;
+    const double inferred = counters.inferred > 0 ? counters.inferred : 1;
+    out << "  \"throughput\": {\"preprocess_ms\": " << counters.preprocessMs / inferred
+        << ", \"infer_ms\": " << counters.inferMs / inferred
+        << ", \"decode_ms\": " << counters.decodeMs / inferred
+        << ", \"inference_fps\": " << (inferenceMs > 0 ? counters.inferred * 1e3 / inferenceMs : 0)
+        << ", \"effective_fps\": " << (inferenceMs > 0 ? counters.images * 1e3 / inferenceMs : 0) << "}" << std::endl;
+    out << "}" << std::endl;
+}
+
+bool ParseAndCheckCommandLine(int argc, char *argv[]) {
+    // The evaluation runs on the CPU plugin unless told otherwise
+    gflags::SetCommandLineOptionWithMode("cars_device", "CPU", gflags::SET_FLAGS_DEFAULT);
+    gflags::SetCommandLineOptionWithMode("traffic_device", "CPU", gflags::SET_FLAGS_DEFAULT);
+
+    gflags::ParseCommandLineNonHelpFlags(&argc, &argv, true);
+    if (FLAGS_h) {
+        showEvalUsage();
+        return false;
+    }
+
+    if (!FLAGS_config.empty()) {
+        loadConfigFile(FLAGS_config);
+    }
+
+    if (FLAGS_i == "cam") {
+        throw std::logic_error("Parameter -i should be an image directory");
+    }
+    if (FLAGS_detector != "cars" && FLAGS_detector != "traffic") {
+        throw std::logic_error("Parameter -detector should be \"cars\" or \"traffic\"");
+    }
+    if (FLAGS_iou <= 0 || FLAGS_iou > 1) {
+        throw std::logic_error("Parameter -iou should be in (0, 1]");
+    }
+    if (FLAGS_input_scale <= 0 || FLAGS_input_scale > 1) {
+        throw std::logic_error("Parameter -input_scale should be in (0, 1]");
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    try {
+        if (!ParseAndCheckCommandLine(argc, argv)) {
+            return 0;
+        }
+
+        Annotations annotations = readAnnotations(FLAGS_annotations.empty() ? FLAGS_i : FLAGS_annotations);
+        slog::info << "Annotations for " << annotations.size() << " images" << slog::endl;
+
+        std::vector<std::string> files;
+        readInputFilesArguments(files, FLAGS_i);
+        std::sort(files.begin(), files.end());
+
+        SSDParams params;
+        params.model = FLAGS_detector == "cars" ? FLAGS_cars_model : FLAGS_traffic_model;
+        params.device = FLAGS_detector == "cars" ? FLAGS_cars_device : FLAGS_traffic_device;
+        params.nthreads = FLAGS_detector == "cars" ? FLAGS_cars_nthreads : FLAGS_traffic_nthreads;
+        params.nmsIou = FLAGS_detector == "cars" ? FLAGS_cars_nms_iou : FLAGS_traffic_nms_iou;
+        params.regions = parseRegions(FLAGS_detector == "cars" ? FLAGS_cars_regions : FLAGS_traffic_regions);
+        params.threshold = FLAGS_min_confidence;
+        SSDDetector detector(params);
+
+        AveragePrecisionCalculator calculator(FLAGS_iou);
+        EvalCounters counters;
+        DetectionSet detections;
+        std::set<std::string> unknownLabels;
+
+        std::vector<std::string> annotated;
+        for (const std::string& file : files)
+        {
+            // VOC annotations usually sit next to the images
+            if (file.size() >= 4 && file.compare(file.size() - 4, 4, ".xml") == 0)
+                continue;
+            if (annotations.count(imageKey(file)) == 0)
+                ++counters.unannotated;
+            else
+                annotated.push_back(file);
+        }
+        if (annotated.empty())
+            throw std::logic_error("None of the images in " + FLAGS_i + " is annotated");
+
+        // Boxes are compared at the annotated size, so images are always decoded at full size
+        ImageDecodeParams decode;
+        decode.threads = FLAGS_input_decode_threads;
+        decode.prefetch = FLAGS_input_prefetch;
+        ImageDirectorySource source(FLAGS_i, annotated, decode);
+
+        cv::Mat image;
+        while (source.read(image))
+        {
+            const std::string& file = source.lastFile();
+            auto annotation = annotations.find(imageKey(file));
+
+            if (counters.images % (FLAGS_frame_skip + 1) == 0)
+            {
+                const cv::Size annotatedSize = image.size();
+                if (FLAGS_input_scale < 1)
+                    cv::resize(image, image, cv::Size(), FLAGS_input_scale, FLAGS_input_scale, cv::INTER_AREA);
+
+                auto t0 = Clock::now();
+                detector.preprocess(image);
+                counters.preprocessMs += elapsedMs(t0);
+
+                t0 = Clock::now();
+                if (!detector.infer())
+                    throw std::logic_error("Inference failed on " + file);
+                counters.inferMs += elapsedMs(t0);
+
+                // SSD boxes are relative, decoding at the annotated size undoes -input_scale
+                t0 = Clock::now();
+                detections.objects.clear();
+                detector.decode(annotatedSize.width, annotatedSize.height, detections);
+                counters.decodeMs += elapsedMs(t0);
+                ++counters.inferred;
+            }
+            ++counters.images;
+
+            std::list<DetectedObject> detected, desired;
+            for (const Detection& object : detections.objects)
+            {
+                detected.emplace_back(object.label, object.xmin, object.ymin, object.xmax, object.ymax, object.confidence);
+                ++counters.detections[object.label];
+            }
+            for (const GroundTruthObject& object : annotation->second)
+            {
+                int label = detector.labelId(object.label);
+                if (label < 0)
+                {
+                    if (unknownLabels.insert(object.label).second)
+                        slog::warn << "The model has no label \"" << object.label << "\", such objects are ignored" << slog::endl;
+                    ++counters.unknownObjects;
+                    continue;
+                }
+                desired.emplace_back(label, object.xmin, object.ymin, object.xmax, object.ymax, 1.0f, object.difficult);
+                if (!object.difficult)
+                    ++counters.groundTruth[label];
+            }
+            calculator.consumeImage(ImageDescription(detected), ImageDescription(desired));
+        }
+
+        if (counters.images == 0)
+            throw std::logic_error("None of the images in " + FLAGS_i + " is annotated");
+        if (counters.unannotated > 0)
+            slog::warn << counters.unannotated << " images without annotations were skipped" << slog::endl;
+
+        std::map<int, double> averagePrecision = calculator.calculateAveragePrecisionPerClass();
+        if (FLAGS_report.empty()) {
+            writeReport(std::cout, detector, counters, averagePrecision);
+        } else {
+            std::ofstream report(FLAGS_report);
+            if (!report)
+                throw std::logic_error("Cannot write " + FLAGS_report);
+            writeReport(report, detector, counters, averagePrecision);
+            slog::info << "Report written to " << FLAGS_report << slog::endl;
+        }
+    }
+    catch (const std::exception& error) {
+        slog::err << error.what() << slog::endl;
+        slog::flush();
+        return 1;
+    }
+    catch (...) {
+        slog::err << "Unknown/internal exception happened." << slog::endl;
+        slog::flush();
+        return 1;
+    }
+
+    slog::flush();
+    return 0;
+}
@@ -12,19 +12,22 @@
 #include <string>
 #include <format_reader.h>
 
+#include "mnist_dataset.h"
 #include "register.h"
 
 namespace FormatReader {
 /**
  * \class MnistUbyte
- * \brief Reader for mnist db files
+ * \brief Reader for the first image of a mnist db file, see MnistDataset for all of them
  */
 class MnistUbyte : public Reader {
 private:
-    int reverseInt(int i);
-
     static Register<MnistUbyte> reg;
 
+    MnistDataset _dataset;
+    /// \brief first image of _dataset
+    ImageView _view;
+
 public:
     /**
      * \brief Constructor of Mnist reader
@@ -35,6 +38,13 @@ public:
     virtual ~MnistUbyte() {
     }
 
+    /**
+     * \brief Accepts files starting with the idx3-ubyte magic number
+     */
+    static bool probe(const unsigned char *header, size_t size, const std::string &extension);
+
+    static ReaderCapabilities capabilities();
+
     /**
      * \brief Get size
      * @return size
@@ -47,12 +57,10 @@ public:
         delete this;
     }
 
-    std::shared_ptr<unsigned char> getData(size_t width, size_t height) override {
-        if ((width * height != 0) && (_width * _height != width * height)) {
-            std::cout << "[ WARNING ] Image won't be resized! Please use OpenCV.\n";
-            return nullptr;
-        }
-        return _data;
+    std::shared_ptr<unsigned char> getData(size_t width, size_t height) override;
+
+    ImageView view() const override {
+        return _view;
     }
 };
 }  // namespace FormatReader
@@ -3,7 +3,7 @@
 //
 
 #include "bmp.h"
-#include <fstream>
+#include <cstring>
 #include <iostream>
 
 using namespace std;
@@ -14,28 +14,34 @@ BitMap::BitMap(const string &filename) {
     BmpHeader header;
     BmpInfoHeader infoHeader;
 
-    ifstream input(filename, ios::binary);
-    if (!input) {
+    _file = make_shared<MappedFile>(filename);
+    if (!_file->valid()) {
         return;
     }
+    const unsigned char *base = _file->data();
 
-    input.read(reinterpret_cast<char *>(&header.type), 2);
+    // The 14 byte file header is packed, BmpHeader is not
+    if (!_file->contains(0, 14 + sizeof(BmpInfoHeader))) {
+        std::cerr << "[BMP] file is too short\n";
+        return;
+    }
+    memcpy(&header.type, base, 2);
 
     if (header.type != 'M'*256+'B') {
         std::cerr << "[BMP] file is not bmp type\n";
         return;
     }
 
-    input.read(reinterpret_cast<char *>(&header.size), 4);
-    input.read(reinterpret_cast<char *>(&header.reserved), 4);
-    input.read(reinterpret_cast<char *>(&header.offset), 4);
+    memcpy(&header.size, base + 2, 4);
+    memcpy(&header.reserved, base + 6, 4);
+    memcpy(&header.offset, base + 10, 4);
 
-    input.read(reinterpret_cast<char *>(&infoHeader), sizeof(BmpInfoHeader));
+    memcpy(&infoHeader, base + 14, sizeof(BmpInfoHeader));
 
 
     bool rowsReversed = infoHeader.height < 0;
-    _width = infoHeader.width;
-    _height = abs(infoHeader.height);
+    size_t width = infoHeader.width;
+    size_t height = abs(infoHeader.height);
 
     if (infoHeader.bits != 24) {
         cerr << "[BMP] 24bpp only supported. But input has:" << infoHeader.bits << "\n";
@@ -44,20 +50,47 @@ BitMap::BitMap(const string &filename) {
 
     if (infoHeader.compression != 0) {
         cerr << "[BMP] compression not supported\n";
+        return;
     }
 
-    int padSize = _width & 3;
-    char pad[3];
-    size_t size = _width * _height * 3;
+    // rows are padded to 4 bytes
+    const size_t rowSize = (width * 3 + 3) & ~static_cast<size_t>(3);
+    if (infoHeader.width <= 0 || height == 0 || !_file->contains(header.offset, rowSize * height)) {
+        cerr << "[BMP] pixel data is truncated\n";
+        return;
+    }
 
-    _data.reset(new unsigned char[size], std::default_delete<unsigned char[]>());
+    _width = width;
+    _height = height;
 
-    input.seekg(header.offset, ios::beg);
+    // bottom-up rows are viewed from the last one in the file with a negative stride
+    _view.width = _width;
+    _view.height = _height;
+    _view.channels = 3;
+    _view.stride = rowsReversed ? rowSize : -static_cast<ptrdiff_t>(rowSize);
+    _view.data = base + header.offset + (rowsReversed ? 0 : rowSize * (_height - 1));
+}
 
-    // reading by rows in invert vertically
-    for (uint32_t i = 0; i < _height; i++) {
-        uint32_t storeAt = rowsReversed ? i : (uint32_t)_height - 1 - i;
-        input.read(reinterpret_cast<char *>(_data.get()) + _width * 3 * storeAt, _width * 3);
-        input.read(pad, padSize);
+bool BitMap::probe(const unsigned char *header, size_t size, const std::string &) {
+    return size >= 2 && header[0] == 'B' && header[1] == 'M';
+}
+
+ReaderCapabilities BitMap::capabilities() {
+    ReaderCapabilities capabilities;
+    capabilities.name = "BitMap";
+    capabilities.mapped = true;
+    return capabilities;
+}
+
+std::shared_ptr<unsigned char> BitMap::getData(size_t width, size_t height) {
+    if ((width * height != 0) && (_width * _height != width * height)) {
+        std::cout << "[ WARNING ] Image won't be resized! Please use OpenCV.\n";
+        return nullptr;
+    }
+    // Packed on first use only, view() and readInto() do not need the copy
+    if (!_data && !_view.empty()) {
+        _data.reset(new unsigned char[size()], std::default_delete<unsigned char[]>());
+        _view.copyTo(_data.get());
     }
+    return _data;
 }
@@ -12,6 +12,7 @@
 #include <string>
 #include <format_reader.h>
 
+#include "mapped_file.h"
 #include "register.h"
 
 namespace FormatReader {
@@ -23,6 +24,10 @@ class BitMap : public Reader {
 private:
     static Register<BitMap> reg;
 
+    std::shared_ptr<MappedFile> _file;
+    /// \brief pixels inside _file, bottom-up files have a negative stride
+    ImageView _view;
+
     typedef struct {
         unsigned short type   = 0u;              /* Magic identifier            */
         unsigned int size     = 0u;              /* File size in bytes          */
@@ -52,6 +57,13 @@ public:
     virtual ~BitMap() {
     }
 
+    /**
+     * \brief Accepts files starting with "BM"
+     */
+    static bool probe(const unsigned char *header, size_t size, const std::string &extension);
+
+    static ReaderCapabilities capabilities();
+
     /**
      * \brief Get size
      * @return size
@@ -64,12 +76,10 @@ public:
         delete this;
     }
 
-    std::shared_ptr<unsigned char> getData(size_t width, size_t height) override {
-        if ((width * height != 0) && (_width * _height != width * height)) {
-            std::cout << "[ WARNING ] Image won't be resized! Please use OpenCV.\n";
-            return nullptr;
-        }
-        return _data;
+    std::shared_ptr<unsigned char> getData(size_t width, size_t height) override;
+
+    ImageView view() const override {
+        return _view;
     }
 };
 }  // namespace FormatReader
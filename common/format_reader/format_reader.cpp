@@ -2,6 +2,9 @@
 // SPDX-License-Identifier: Apache-2.0
 //
 
+#include <algorithm>
+#include <cctype>
+#include <fstream>
 #include <iostream>
 #include <format_reader.h>
 #include "bmp.h"
@@ -10,7 +13,7 @@
 
 using namespace FormatReader;
 
-std::vector<Registry::CreatorFunction> Registry::_data;
+std::vector<Registry::Entry> Registry::_data;
 
 Register<MnistUbyte> MnistUbyte::reg;
 #ifdef USE_OPENCV
@@ -19,17 +22,58 @@ Register<OCVReader> OCVReader::reg;
 Register<BitMap> BitMap::reg;
 #endif
 
+namespace {
+/**
+ * \brief First bytes and lower case extension of a file, read once for all probes
+ */
+struct FileStart {
+    unsigned char header[Registry::probeSize] = {};
+    size_t size = 0;
+    std::string extension;
+
+    explicit FileStart(const char *filename) {
+        std::ifstream file(filename, std::ios::binary);
+        file.read(reinterpret_cast<char *>(header), sizeof(header));
+        size = static_cast<size_t>(std::max<std::streamsize>(file.gcount(), 0));
+
+        std::string name(filename);
+        size_t dot = name.find_last_of('.');
+        if (dot != std::string::npos && name.find_first_of("/\\", dot) == std::string::npos) {
+            extension = name.substr(dot + 1);
+            std::transform(extension.begin(), extension.end(), extension.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        }
+    }
+};
+}  // namespace
+
 Reader *Registry::CreateReader(const char *filename) {
-    for (auto maker : _data) {
-        Reader *ol = maker(filename);
+    FileStart start(filename);
+    if (start.size == 0) return nullptr;
+    // Only readers whose probe accepts the file are constructed, the first that reads it wins
+    for (const auto &entry : _data) {
+        if (!entry.probe(start.header, start.size, start.extension)) continue;
+        Reader *ol = entry.create(filename);
         if (ol != nullptr && ol->size() != 0) return ol;
         if (ol != nullptr) ol->Release();
     }
     return nullptr;
 }
 
-void Registry::RegisterReader(CreatorFunction f) {
-    _data.push_back(f);
+bool Registry::Probe(const char *filename, ReaderCapabilities &capabilities) {
+    FileStart start(filename);
+    if (start.size == 0) return false;
+    for (const auto &entry : _data) {
+        if (entry.probe(start.header, start.size, start.extension)) {
+            capabilities = entry.capabilities;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Registry::RegisterReader(const ReaderCapabilities &capabilities, ProbeFunction probe, CreatorFunction f) {
+    _data.push_back(Entry{capabilities, probe, f});
 }
 
 FORMAT_READER_API(Reader*) CreateFormatReader(const char *filename) {
@@ -8,6 +8,8 @@
  */
 #pragma once
 
+#include <cstddef>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
@@ -31,6 +33,39 @@
 
 
 namespace FormatReader {
+/**
+ * \brief Read-only view of interleaved 8-bit image rows, valid as long as the reader lives
+ */
+struct ImageView {
+    /// \brief first byte of the top row, nullptr if the reader has no view
+    const unsigned char *data = nullptr;
+    size_t width = 0;
+    size_t height = 0;
+    size_t channels = 0;
+    /// \brief bytes from a row to the one below it, negative for images stored bottom-up
+    std::ptrdiff_t stride = 0;
+
+    bool empty() const { return data == nullptr; }
+
+    const unsigned char *row(size_t y) const {
+        return data + static_cast<std::ptrdiff_t>(y) * stride;
+    }
+
+    /**
+     * \brief Copies the rows, tightly packed, to dst of width * height * channels bytes
+     */
+    void copyTo(unsigned char *dst) const {
+        const size_t rowSize = width * channels;
+        if (stride == static_cast<std::ptrdiff_t>(rowSize)) {
+            std::memcpy(dst, data, rowSize * height);
+            return;
+        }
+        for (size_t y = 0; y < height; ++y) {
+            std::memcpy(dst + y * rowSize, row(y), rowSize);
+        }
+    }
+};
+
 /**
  * \class FormatReader
  * \brief This is an abstract class for reading input data
@@ -64,6 +99,27 @@ public:
      */
     virtual std::shared_ptr<unsigned char> getData(size_t width = 0, size_t height = 0) = 0;
 
+    /**
+     * \brief View of the pixels in place, without a copy
+     * @return empty view if the reader cannot expose its layout directly
+     */
+    virtual ImageView view() const { return ImageView(); }
+
+    /**
+     * \brief Decodes the image, tightly packed, into caller supplied memory of width * height * channels bytes
+     * @param dst - destination buffer
+     * @param width, height - size to resize to, 0 keeps the image size
+     * @return false if the reader cannot produce that size
+     */
+    virtual bool readInto(unsigned char *dst, size_t width = 0, size_t height = 0) {
+        ImageView image = view();
+        if (image.empty() || (width * height != 0 && (width != image.width || height != image.height))) {
+            return false;
+        }
+        image.copyTo(dst);
+        return true;
+    }
+
     /**
      * \brief Get size
      * @return size
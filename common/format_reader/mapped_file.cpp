@@ -0,0 +1,76 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "mapped_file.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace FormatReader;
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file || file.tellg() <= 0) {
+        return;
+    }
+    _buffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    if (!file.read(reinterpret_cast<char *>(_buffer.data()), _buffer.size())) {
+        return;
+    }
+    _base = _buffer.data();
+    _size = _buffer.size();
+}
+
+MappedFile::~MappedFile() {
+}
+
+void MappedFile::prefetch(size_t, size_t) const {
+}
+#else
+MappedFile::MappedFile(const std::string &filename) {
+    int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void *base = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base != MAP_FAILED) {
+            // Images are parsed front to back once
+            madvise(base, info.st_size, MADV_SEQUENTIAL);
+            _base = static_cast<const unsigned char *>(base);
+            _size = info.st_size;
+        }
+    }
+    // The mapping keeps its own reference to the file
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (_base != nullptr) {
+        munmap(const_cast<unsigned char *>(_base), _size);
+    }
+}
+
+void MappedFile::prefetch(size_t offset, size_t length) const {
+    if (_base == nullptr || offset >= _size) {
+        return;
+    }
+    // madvise wants a page aligned start
+    const size_t page = sysconf(_SC_PAGESIZE);
+    const size_t begin = offset / page * page;
+    const size_t end = offset + std::min(length, _size - offset);
+    madvise(const_cast<unsigned char *>(_base) + begin, end - begin, MADV_WILLNEED);
+}
+#endif
@@ -0,0 +1,63 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+/**
+ * \brief Read-only memory mapping of a file
+ * \file mapped_file.h
+ */
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace FormatReader {
+/**
+ * \class MappedFile
+ * \brief Maps a whole file read-only, the readers parse and view it in place instead of copying it
+ */
+class MappedFile {
+private:
+    const unsigned char *_base = nullptr;
+    size_t _size = 0;
+#ifdef _WIN32
+    std::vector<unsigned char> _buffer;
+#endif
+
+public:
+    /**
+     * \brief Maps the file, valid() is false if it cannot be opened or is empty
+     * @param filename - path to the file
+     */
+    explicit MappedFile(const std::string &filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool valid() const { return _base != nullptr; }
+
+    /**
+     * \brief First byte of the file
+     */
+    const unsigned char *data() const { return _base; }
+
+    /**
+     * \brief File size in bytes
+     */
+    size_t size() const { return _size; }
+
+    /**
+     * \brief Checks that [offset, offset + length) lies inside the file
+     */
+    bool contains(size_t offset, size_t length) const {
+        return offset <= _size && length <= _size - offset;
+    }
+
+    /**
+     * \brief Asks the kernel to read [offset, offset + length) ahead, returns immediately
+     */
+    void prefetch(size_t offset, size_t length) const;
+};
+}  // namespace FormatReader
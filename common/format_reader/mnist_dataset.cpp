@@ -0,0 +1,98 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "mnist_dataset.h"
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+using namespace FormatReader;
+
+MnistDataset::MnistDataset(const std::string &imagesFile, const std::string &labelsFile) {
+    auto images = std::make_shared<MappedFile>(imagesFile);
+    if (!images->valid() || !images->contains(0, imagesHeaderSize) ||
+        readBigEndian32(images->data()) != imagesMagic) {
+        return;
+    }
+    const size_t count = readBigEndian32(images->data() + 4);
+    const size_t height = readBigEndian32(images->data() + 8);
+    const size_t width = readBigEndian32(images->data() + 12);
+    const size_t available = images->size() - imagesHeaderSize;
+    if (count == 0 || width == 0 || height == 0 || width * height > available || count > available / (width * height)) {
+        std::cerr << "[MNIST] " << imagesFile << " is truncated\n";
+        return;
+    }
+
+    if (!labelsFile.empty()) {
+        auto labels = std::make_shared<MappedFile>(labelsFile);
+        if (!labels->valid() || !labels->contains(0, labelsHeaderSize) ||
+            readBigEndian32(labels->data()) != labelsMagic ||
+            readBigEndian32(labels->data() + 4) != count || !labels->contains(labelsHeaderSize, count)) {
+            std::cerr << "[MNIST] " << labelsFile << " does not hold a label for each of the " << count << " images\n";
+            return;
+        }
+        _labels = labels;
+    }
+
+    _images = images;
+    _count = count;
+    _width = width;
+    _height = height;
+}
+
+ImageView MnistDataset::image(size_t i) const {
+    ImageView view;
+    if (i < _count) {
+        view.data = _images->data() + imagesHeaderSize + i * imageSize();
+        view.width = _width;
+        view.height = _height;
+        view.channels = 1;
+        view.stride = _width;
+    }
+    return view;
+}
+
+int MnistDataset::label(size_t i) const {
+    return _labels && i < _count ? _labels->data()[labelsHeaderSize + i] : -1;
+}
+
+void MnistDataset::checkBatch(size_t first, size_t count) const {
+    if (first > _count || count > _count - first) {
+        throw std::out_of_range("[MNIST] batch of " + std::to_string(count) + " images from " + std::to_string(first) +
+                                " is outside the " + std::to_string(_count) + " images of the dataset");
+    }
+}
+
+void MnistDataset::readBatch(size_t first, size_t count, unsigned char *dst) const {
+    checkBatch(first, count);
+    // images are stored back to back, a batch is one contiguous copy
+    std::memcpy(dst, image(first).data, count * imageSize());
+}
+
+void MnistDataset::readBatch(size_t first, size_t count, float *dst, float scale) const {
+    checkBatch(first, count);
+    const unsigned char *src = image(first).data;
+    const size_t size = count * imageSize();
+    for (size_t i = 0; i < size; ++i) {
+        dst[i] = src[i] * scale;
+    }
+}
+
+void MnistDataset::prefetch(size_t first, size_t count) const {
+    if (first < _count) {
+        _images->prefetch(imagesHeaderSize + first * imageSize(), count * imageSize());
+    }
+}
+
+MnistBatchIterator::MnistBatchIterator(const MnistDataset &dataset, size_t batchSize):
+    _dataset(dataset), _batchSize(batchSize) {
+    _dataset.prefetch(0, _batchSize);
+}
+
+void MnistBatchIterator::rewind() {
+    _position = 0;
+    _lastCount = 0;
+    _dataset.prefetch(0, _batchSize);
+}
@@ -0,0 +1,139 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+/**
+ * \brief Random access reader of whole MNIST style ubyte datasets
+ * \file mnist_dataset.h
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <format_reader.h>
+
+#include "mapped_file.h"
+
+namespace FormatReader {
+/**
+ * \brief Big endian 32 bit integer as stored in ubyte headers
+ */
+inline uint32_t readBigEndian32(const unsigned char *bytes) {
+    return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+           (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+}
+
+/**
+ * \class MnistDataset
+ * \brief Maps an idx3-ubyte image file (and optionally its idx1-ubyte label file) and views
+ * every image in place
+ */
+class MnistDataset {
+private:
+    std::shared_ptr<MappedFile> _images;
+    std::shared_ptr<MappedFile> _labels;
+    size_t _count = 0;
+    size_t _width = 0;
+    size_t _height = 0;
+
+    /// \brief throws std::out_of_range unless images [first, first + count) exist
+    void checkBatch(size_t first, size_t count) const;
+
+public:
+    /// \brief image file magic number
+    static const uint32_t imagesMagic = 2051;
+    /// \brief label file magic number
+    static const uint32_t labelsMagic = 2049;
+    /// \brief bytes before the first image
+    static const size_t imagesHeaderSize = 16;
+    /// \brief bytes before the first label
+    static const size_t labelsHeaderSize = 8;
+
+    /**
+     * \brief Maps the dataset, valid() is false if the image file is missing or malformed
+     * @param imagesFile - path to the idx3-ubyte images
+     * @param labelsFile - path to the idx1-ubyte labels, empty if there are none
+     */
+    explicit MnistDataset(const std::string &imagesFile, const std::string &labelsFile = "");
+
+    bool valid() const { return _count != 0; }
+    bool hasLabels() const { return _labels != nullptr; }
+
+    /// \brief number of images
+    size_t count() const { return _count; }
+    size_t width() const { return _width; }
+    size_t height() const { return _height; }
+
+    /// \brief bytes of one image
+    size_t imageSize() const { return _width * _height; }
+
+    /**
+     * \brief View of image i inside the mapping, no copy
+     */
+    ImageView image(size_t i) const;
+
+    /**
+     * \brief Label of image i, -1 without a label file
+     */
+    int label(size_t i) const;
+
+    /**
+     * \brief Copies images [first, first + count) back to back to dst, e.g. the buffer of a
+     * U8 NCHW input blob with N = count, C = 1
+     * @throw std::out_of_range if the batch reaches past the last image
+     */
+    void readBatch(size_t first, size_t count, unsigned char *dst) const;
+
+    /**
+     * \brief Same for an FP32 blob, every pixel multiplied by scale
+     */
+    void readBatch(size_t first, size_t count, float *dst, float scale = 1.0f) const;
+
+    /**
+     * \brief Asks the kernel to read images [first, first + count) ahead
+     */
+    void prefetch(size_t first, size_t count) const;
+};
+
+/**
+ * \class MnistBatchIterator
+ * \brief Walks a dataset in batches; while the caller infers one batch the pages of the next
+ * one are already being read in
+ */
+class MnistBatchIterator {
+private:
+    const MnistDataset &_dataset;
+    size_t _batchSize;
+    size_t _position = 0;
+    size_t _lastCount = 0;
+
+public:
+    MnistBatchIterator(const MnistDataset &dataset, size_t batchSize);
+
+    /**
+     * \brief Copies the next batch to dst, which holds batchSize images
+     * @return number of images copied, less than batchSize for the last batch, 0 at the end
+     */
+    template <typename T>
+    size_t next(T *dst) {
+        _lastCount = std::min(_batchSize, _dataset.count() - _position);
+        if (_lastCount == 0) {
+            return 0;
+        }
+        _dataset.readBatch(_position, _lastCount, dst);
+        _position += _lastCount;
+        _dataset.prefetch(_position, _batchSize);
+        return _lastCount;
+    }
+
+    /// \brief index of the first image of the last batch
+    size_t first() const { return _position - _lastCount; }
+
+    /// \brief images left
+    size_t remaining() const { return _dataset.count() - _position; }
+
+    void rewind();
+};
+}  // namespace FormatReader
@@ -4,6 +4,8 @@
 
 #ifdef USE_OPENCV
 #include "opencv_wraper.h"
+#include "mapped_file.h"
+#include <cstring>
 #include <fstream>
 #include <iostream>
 
@@ -15,8 +17,14 @@ using namespace std;
 using namespace FormatReader;
 
 OCVReader::OCVReader(const string &filename) {
-    img = cv::imread(filename);
     _size = 0;
+    // Decoded straight from the mapping, no intermediate read buffer
+    MappedFile file(filename);
+    if (!file.valid()) {
+        return;
+    }
+    img = cv::imdecode(cv::Mat(1, static_cast<int>(file.size()), CV_8UC1, const_cast<unsigned char *>(file.data())),
+                       cv::IMREAD_COLOR);
 
     if (img.empty()) {
         return;
@@ -27,22 +35,91 @@ OCVReader::OCVReader(const string &filename) {
     _height = img.size().height;
 }
 
-std::shared_ptr<unsigned char> OCVReader::getData(size_t width = 0, size_t height = 0) {
-    cv::Mat resized(img);
-    if (width != 0 && height != 0) {
-        size_t iw = img.size().width;
-        size_t ih = img.size().height;
-        if (width != iw || height != ih) {
-            slog::warn << "Image is resized from (" << iw << ", " << ih << ") to (" << width << ", " << height << ")" << slog::endl;
+bool OCVReader::probe(const unsigned char *header, size_t size, const std::string &extension) {
+    static const struct {
+        const char *bytes;
+        size_t offset;
+        size_t length;
+    } signatures[] = {
+        {"\xFF\xD8\xFF", 0, 3},           // JPEG
+        {"\x89PNG", 0, 4},                 // PNG
+        {"BM", 0, 2},                      // BMP
+        {"II*\0", 0, 4},                   // TIFF, little endian
+        {"MM\0*", 0, 4},                   // TIFF, big endian
+        {"WEBP", 8, 4},                    // WebP, after "RIFF" and the chunk size
+        {"\0\0\0\x0CjP  ", 0, 8},          // JPEG 2000
+        {"\x76\x2F\x31\x01", 0, 4},        // OpenEXR
+        {"#?RADIANCE", 0, 10},             // Radiance HDR
+        {"\x59\xA6\x6A\x95", 0, 4},        // Sun raster
+    };
+    for (const auto &signature : signatures) {
+        if (size >= signature.offset + signature.length &&
+            memcmp(header + signature.offset, signature.bytes, signature.length) == 0) {
+            return true;
+        }
+    }
+    // PBM, PGM, PPM and PAM: "P1" .. "P7"
+    if (size >= 2 && header[0] == 'P' && header[1] >= '1' && header[1] <= '7') {
+        return true;
+    }
+    // Formats without a fixed signature go by name
+    static const char *extensions[] = {"jpg", "jpeg", "jpe", "png", "bmp", "dib", "tif", "tiff", "webp", "pbm", "pgm",
+                                       "ppm", "pxm", "pnm", "pam", "sr", "ras", "jp2", "exr", "hdr", "pic"};
+    for (const char *known : extensions) {
+        if (extension == known) {
+            return true;
         }
-        cv::resize(img, resized, cv::Size(width, height));
     }
+    return false;
+}
 
-    size_t size = resized.size().width * resized.size().height * resized.channels();
-    _data.reset(new unsigned char[size], std::default_delete<unsigned char[]>());
-    for (size_t id = 0; id < size; ++id) {
-        _data.get()[id] = resized.data[id];
+ReaderCapabilities OCVReader::capabilities() {
+    ReaderCapabilities capabilities;
+    capabilities.name = "OCVReader";
+    // decodes the mapping into its own image, view() shows a decoded copy of the pixels
+    capabilities.mapped = false;
+    capabilities.resize = true;
+    return capabilities;
+}
+
+std::shared_ptr<unsigned char> OCVReader::getData(size_t width = 0, size_t height = 0) {
+    if (width == 0 || height == 0) {
+        width = img.size().width;
+        height = img.size().height;
+    }
+    _data.reset(new unsigned char[width * height * img.channels()], std::default_delete<unsigned char[]>());
+    if (!readInto(_data.get(), width, height)) {
+        _data.reset();
     }
     return _data;
 }
+
+ImageView OCVReader::view() const {
+    ImageView view;
+    if (!img.empty()) {
+        view.data = img.data;
+        view.width = img.cols;
+        view.height = img.rows;
+        view.channels = img.channels();
+        view.stride = img.step;
+    }
+    return view;
+}
+
+bool OCVReader::readInto(unsigned char *dst, size_t width, size_t height) {
+    if (img.empty()) {
+        return false;
+    }
+    size_t iw = img.size().width;
+    size_t ih = img.size().height;
+    if (width == 0 || height == 0 || (width == iw && height == ih)) {
+        view().copyTo(dst);
+        return true;
+    }
+    slog::warn << "Image is resized from (" << iw << ", " << ih << ") to (" << width << ", " << height << ")" << slog::endl;
+    // dst already has the right size and type, resize writes into it without reallocating
+    cv::Mat resized(static_cast<int>(height), static_cast<int>(width), img.type(), dst);
+    cv::resize(img, resized, resized.size());
+    return true;
+}
 #endif
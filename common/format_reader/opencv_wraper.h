@@ -38,6 +38,13 @@ public:
     virtual ~OCVReader() {
     }
 
+    /**
+     * \brief Accepts the signatures of the formats OpenCV decodes, or their extensions
+     */
+    static bool probe(const unsigned char *header, size_t size, const std::string &extension);
+
+    static ReaderCapabilities capabilities();
+
     /**
     * \brief Get size
     * @return size
@@ -51,6 +58,10 @@ public:
     }
 
     std::shared_ptr<unsigned char> getData(size_t width, size_t height) override;
+
+    ImageView view() const override;
+
+    bool readInto(unsigned char *dst, size_t width = 0, size_t height = 0) override;
 };
 }  // namespace FormatReader
 #endif
\ No newline at end of file
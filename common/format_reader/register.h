@@ -8,19 +8,50 @@
 #pragma once
 
 #include <format_reader.h>
+#include <cstddef>
 #include <functional>
 #include <vector>
 #include <string>
 
 namespace FormatReader {
+/**
+ * \brief What a reader can do, declared when it is registered
+ */
+struct ReaderCapabilities {
+    /// \brief reader name for messages
+    const char *name = "";
+    /// \brief the file is read through a mapping and view() exposes the pixels without a copy
+    bool mapped = false;
+    /// \brief getData() and readInto() produce any requested size
+    bool resize = false;
+};
+
 /**
  * \class Registry
  * \brief Create reader from fabric
  */
 class Registry {
-private:
+public:
+    /// \brief bytes of the file start handed to the probes
+    static const size_t probeSize = 16;
+
+    /**
+     * \brief Cheap check whether a reader handles a file, without opening it again
+     * @param header - first bytes of the file, up to probeSize
+     * @param size - number of bytes in header
+     * @param extension - lower case file extension without the dot
+     */
+    typedef std::function<bool(const unsigned char *header, size_t size, const std::string &extension)> ProbeFunction;
     typedef std::function<Reader *(const std::string &filename)> CreatorFunction;
-    static std::vector<CreatorFunction> _data;
+
+private:
+    struct Entry {
+        ReaderCapabilities capabilities;
+        ProbeFunction probe;
+        CreatorFunction create;
+    };
+    static std::vector<Entry> _data;
+
 public:
     /**
      * \brief Create reader
@@ -29,16 +60,26 @@ public:
      */
     static Reader *CreateReader(const char *filename);
 
+    /**
+     * \brief Finds the reader for a file by its first bytes and extension, nothing is decoded
+     * @param filename - path to input data
+     * @param capabilities - set to those of the reader that would be created
+     * @return false if no registered reader handles the file
+     */
+    static bool Probe(const char *filename, ReaderCapabilities &capabilities);
+
     /**
      * \brief Registers reader in fabric
+     * @param capabilities - what the reader can do
+     * @param probe - decides from the file start whether the reader is tried
      * @param f - a creation function
      */
-    static void RegisterReader(CreatorFunction f);
+    static void RegisterReader(const ReaderCapabilities &capabilities, ProbeFunction probe, CreatorFunction f);
 };
 
 /**
  * \class Register
- * \brief Registers reader in fabric
+ * \brief Registers reader in fabric, To provides static probe() and capabilities()
  */
 template<typename To>
 class Register {
@@ -48,7 +89,7 @@ public:
      * @return Register object
      */
     Register() {
-        Registry::RegisterReader([](const std::string &filename) -> Reader * {
+        Registry::RegisterReader(To::capabilities(), To::probe, [](const std::string &filename) -> Reader * {
             return new To(filename);
         });
     }
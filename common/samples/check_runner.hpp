@@ -0,0 +1,87 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+/**
+ * @brief a header file with the case runner shared by the *_check tools
+ * @file check_runner.hpp
+ */
+
+#pragma once
+
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <gflags/gflags.h>
+
+#include <samples/slog.hpp>
+
+/// @brief message for help argument
+static const char help_message[] = "Print a usage message.";
+
+/// @brief message for the case filter
+static const char filter_message[] = "Optional. Run only cases whose name contains this text.";
+
+DEFINE_bool(h, false, help_message);
+DEFINE_string(filter, "", filter_message);
+
+/**
+ * @brief One named check, run() returns what went wrong, empty when the case passed
+ */
+struct CheckCase {
+    std::string name;
+    std::function<std::string()> run;
+};
+
+/**
+ * @brief Runs the cases whose name contains -filter and prints a PASS/FAIL line for each
+ * @param argc, argv - command line, the tool defines its own flags next to -h and -filter
+ * @param tool - name printed by -h
+ * @param cases - cases in the order they run
+ * @param showOptions - prints the usage lines of the tool's own flags, may be empty
+ * @return exit code: 1 if a case failed, threw or no case matches -filter
+ */
+inline int runChecks(int argc, char *argv[], const std::string &tool, const std::vector<CheckCase> &cases,
+                     const std::function<void()> &showOptions = std::function<void()>()) {
+    gflags::ParseCommandLineNonHelpFlags(&argc, &argv, true);
+    if (FLAGS_h) {
+        std::cout << std::endl;
+        std::cout << tool << " [OPTION]" << std::endl;
+        std::cout << "Options:" << std::endl;
+        std::cout << std::endl;
+        std::cout << "    -h                        " << help_message << std::endl;
+        std::cout << "    -filter \"<text>\"          " << filter_message << std::endl;
+        if (showOptions)
+            showOptions();
+        return 0;
+    }
+
+    int ran = 0, failed = 0;
+    for (const CheckCase &testCase : cases) {
+        if (testCase.name.find(FLAGS_filter) == std::string::npos)
+            continue;
+        ++ran;
+        std::string error;
+        try {
+            error = testCase.run();
+        }
+        catch (const std::exception &e) {
+            error = std::string("exception: ") + e.what();
+        }
+        if (!error.empty()) {
+            ++failed;
+            slog::warn << testCase.name << ": " << error << slog::endl;
+        }
+        std::cout << std::left << std::setw(24) << testCase.name << (error.empty() ? "PASS" : "FAIL") << std::endl;
+    }
+
+    if (ran == 0)
+        slog::warn << "No case matches \"" << FLAGS_filter << "\"" << slog::endl;
+    else
+        slog::info << ran - failed << " of " << ran << " cases passed" << slog::endl;
+    slog::flush();
+    return ran != 0 && failed == 0 ? 0 : 1;
+}
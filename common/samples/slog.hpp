@@ -5,11 +5,36 @@
 /**
  * @brief a header file with logging facility for common samples
  * @file log.hpp
+ *
+ * Log lines are not formatted by the calling thread. Every argument streamed into a LogStream is
+ * encoded as a tagged binary value into a per-thread staging buffer; slog::endl commits the record
+ * into the thread's single-producer/single-consumer ring. A background flusher thread drains all
+ * rings, orders the records by timestamp, formats them and writes whole lines to the console.
+ * Producers never block and never touch std::cout: if a ring is full the record is dropped and
+ * counted.
+ *
+ * Stream manipulators (std::hex, std::setprecision, std::setw, ...) are applied to a per-line
+ * std::ostringstream on the producer; whenever its format differs from the one last recorded, a
+ * Format argument carries it to the flusher, which then formats the following values the same way.
  */
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 namespace slog {
 
@@ -21,25 +46,710 @@ class LogStreamEndLine { };
 
 static constexpr LogStreamEndLine endl;
 
+/**
+ * @brief Severity of a log record. Records below the active level are discarded by the producer.
+ */
+enum class Level : uint8_t {
+    Info = 0,
+    Warning = 1,
+    Error = 2,
+    None = 3
+};
+
+/**
+ * @class RateLimit
+ * @brief Limits a call site to at most one log line per interval. Meant to be kept alive next to
+ *        the loop that logs, e.g. a per-frame FPS report.
+ */
+class RateLimit {
+    int64_t _intervalNs;
+    std::atomic<int64_t> _nextNs;
+    std::atomic<uint64_t> _suppressed;
+
+public:
+    explicit RateLimit(std::chrono::nanoseconds interval)
+            : _intervalNs(interval.count()), _nextNs(0), _suppressed(0) { }
+
+    /**
+     * @brief Checks whether a line may be emitted now
+     * @return true once per interval, false otherwise
+     */
+    bool allow() {
+        const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t next = _nextNs.load(std::memory_order_relaxed);
+        if (now >= next && _nextNs.compare_exchange_strong(next, now + _intervalNs, std::memory_order_relaxed)) {
+            return true;
+        }
+        _suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /**
+     * @brief Number of lines swallowed by this limit so far
+     */
+    uint64_t suppressed() const {
+        return _suppressed.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Stream marker applying a RateLimit to the current line: slog::info << slog::every(limit) << ...
+ */
+struct LogStreamEvery {
+    RateLimit *limit;
+};
+
+inline LogStreamEvery every(RateLimit &limit) {
+    return LogStreamEvery{&limit};
+}
+
+namespace detail {
+
+enum class ArgType : uint8_t {
+    Bool,
+    Char,
+    Signed,
+    Unsigned,
+    Double,
+    String,
+    Text,       // preformatted by the producer, written as is
+    Format      // stream format state for the arguments that follow
+};
+
+/**
+ * @brief The std::ios_base format state a record carries
+ */
+struct FormatState {
+    uint32_t flags;
+    int64_t precision;
+    int64_t width;
+    char fill;
+
+    static FormatState of(const std::ostream &stream) {
+        return FormatState{static_cast<uint32_t>(stream.flags()), static_cast<int64_t>(stream.precision()),
+                           static_cast<int64_t>(stream.width()), stream.fill()};
+    }
+
+    void applyTo(std::ostream &stream) const {
+        stream.flags(static_cast<std::ios_base::fmtflags>(flags));
+        stream.precision(static_cast<std::streamsize>(precision));
+        stream.width(static_cast<std::streamsize>(width));
+        stream.fill(fill);
+    }
+
+    bool operator!=(const FormatState &other) const {
+        return flags != other.flags || precision != other.precision || width != other.width || fill != other.fill;
+    }
+};
+
+/**
+ * @class Ring
+ * @brief Lock-free byte ring with one producer (the owning thread) and one consumer (the flusher).
+ *        Records are stored as [uint32 size][payload] and may wrap around the end of the buffer.
+ */
+class Ring {
+public:
+    static constexpr size_t capacity = 1u << 16;
+
+    bool push(const char *data, uint32_t size) {
+        const size_t need = sizeof(size) + size;
+        const size_t head = _head.load(std::memory_order_relaxed);
+        const size_t tail = _tail.load(std::memory_order_acquire);
+        if (need > capacity - (head - tail)) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        copyIn(head, &size, sizeof(size));
+        copyIn(head + sizeof(size), data, size);
+        _head.store(head + need, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(std::string &record) {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        const size_t head = _head.load(std::memory_order_acquire);
+        if (tail == head) {
+            return false;
+        }
+        uint32_t size = 0;
+        copyOut(tail, &size, sizeof(size));
+        record.resize(size);
+        copyOut(tail + sizeof(size), &record[0], size);
+        _tail.store(tail + sizeof(size) + size, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return _tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire);
+    }
+
+    uint64_t takeDropped() {
+        return _dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+private:
+    void copyIn(size_t position, const void *src, size_t size) {
+        const size_t offset = position & (capacity - 1);
+        const size_t first = std::min(size, capacity - offset);
+        std::memcpy(_buffer + offset, src, first);
+        std::memcpy(_buffer, static_cast<const char *>(src) + first, size - first);
+    }
+
+    void copyOut(size_t position, void *dst, size_t size) const {
+        const size_t offset = position & (capacity - 1);
+        const size_t first = std::min(size, capacity - offset);
+        std::memcpy(dst, _buffer + offset, first);
+        std::memcpy(static_cast<char *>(dst) + first, _buffer, size - first);
+    }
+
+    // head and tail live on separate cache lines so the producer and the flusher do not false-share
+    std::atomic<size_t> _head{0};
+    char _padHead[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> _tail{0};
+    char _padTail[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<uint64_t> _dropped{0};
+    char _buffer[capacity];
+};
+
+/**
+ * @brief Record header: [uint8 level][int64 timestamp ns][encoded arguments...]
+ */
+static constexpr size_t recordHeaderSize = sizeof(uint8_t) + sizeof(int64_t);
+
+inline void put(std::string &bytes, const void *data, size_t size) {
+    bytes.append(static_cast<const char *>(data), size);
+}
+
+inline void putString(std::string &bytes, const char *str, uint32_t size, ArgType tag = ArgType::String) {
+    const uint8_t type = static_cast<uint8_t>(tag);
+    put(bytes, &type, sizeof(type));
+    put(bytes, &size, sizeof(size));
+    put(bytes, str, size);
+}
+
+inline void encode(std::string &bytes, bool value) {
+    const uint8_t arg[2] = {static_cast<uint8_t>(ArgType::Bool), static_cast<uint8_t>(value)};
+    put(bytes, arg, sizeof(arg));
+}
+
+inline void encode(std::string &bytes, char value) {
+    const uint8_t arg[2] = {static_cast<uint8_t>(ArgType::Char), static_cast<uint8_t>(value)};
+    put(bytes, arg, sizeof(arg));
+}
+
+// std::ostream prints (un)signed char as a character, keep doing so
+inline void encode(std::string &bytes, signed char value) {
+    encode(bytes, static_cast<char>(value));
+}
+
+inline void encode(std::string &bytes, unsigned char value) {
+    encode(bytes, static_cast<char>(value));
+}
+
+template<class T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+encode(std::string &bytes, T value) {
+    const uint8_t type = static_cast<uint8_t>(ArgType::Signed);
+    const int64_t wide = value;
+    put(bytes, &type, sizeof(type));
+    put(bytes, &wide, sizeof(wide));
+}
+
+template<class T>
+typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type
+encode(std::string &bytes, T value) {
+    const uint8_t type = static_cast<uint8_t>(ArgType::Unsigned);
+    const uint64_t wide = value;
+    put(bytes, &type, sizeof(type));
+    put(bytes, &wide, sizeof(wide));
+}
+
+inline void encode(std::string &bytes, double value) {
+    const uint8_t type = static_cast<uint8_t>(ArgType::Double);
+    put(bytes, &type, sizeof(type));
+    put(bytes, &value, sizeof(value));
+}
+
+inline void encode(std::string &bytes, float value) {
+    encode(bytes, static_cast<double>(value));
+}
+
+inline void encode(std::string &bytes, const char *value) {
+    putString(bytes, value, static_cast<uint32_t>(std::strlen(value)));
+}
+
+inline void encode(std::string &bytes, const std::string &value) {
+    putString(bytes, value.data(), static_cast<uint32_t>(value.size()));
+}
+
+inline void encode(std::string &bytes, const FormatState &value) {
+    const uint8_t type = static_cast<uint8_t>(ArgType::Format);
+    put(bytes, &type, sizeof(type));
+    put(bytes, &value.flags, sizeof(value.flags));
+    put(bytes, &value.precision, sizeof(value.precision));
+    put(bytes, &value.width, sizeof(value.width));
+    put(bytes, &value.fill, sizeof(value.fill));
+}
+
+template<class T>
+struct HasBinaryEncoding : std::integral_constant<bool, std::is_arithmetic<T>::value ||
+        std::is_convertible<const T &, const char *>::value || std::is_same<T, std::string>::value> { };
+
+/**
+ * @brief A log line being built by its thread. The stream holds the format state the manipulators set.
+ */
+struct Line {
+    std::string bytes;
+    std::ostringstream stream;
+    FormatState initial;    // of a fresh stream, every line starts from it
+    FormatState recorded;   // as the flusher will see it after the arguments encoded so far
+    bool started = false;
+    bool active = false;
+
+    Line() : initial(FormatState::of(stream)), recorded(initial) {
+        bytes.reserve(256);
+    }
+
+    void start(Level level) {
+        bytes.assign(recordHeaderSize, '\0');
+        bytes[0] = static_cast<char>(level);
+        initial.applyTo(stream);
+        recorded = initial;
+    }
+};
+
+template<class T>
+typename std::enable_if<HasBinaryEncoding<T>::value>::type
+encodeArg(Line &line, const T &value) {
+    const FormatState current = FormatState::of(line.stream);
+    if (current != line.recorded) {
+        encode(line.bytes, current);
+        line.recorded = current;
+    }
+    encode(line.bytes, value);
+    // Like any formatted output, a value consumes the width
+    line.stream.width(0);
+    line.recorded.width = 0;
+}
+
+/**
+ * @brief Types without a binary encoding, manipulators included, are formatted eagerly through the
+ *        line stream; this is the slow path
+ */
+template<class T>
+typename std::enable_if<!HasBinaryEncoding<T>::value>::type
+encodeArg(Line &line, const T &value) {
+    line.stream.str("");
+    line.stream << value;
+    const std::string text = line.stream.str();
+    if (!text.empty()) {
+        putString(line.bytes, text.data(), static_cast<uint32_t>(text.size()), ArgType::Text);
+    }
+}
+
+inline const char *levelName(Level level) {
+    switch (level) {
+    case Level::Warning:
+        return "WARNING";
+    case Level::Error:
+        return "ERROR";
+    default:
+        return "INFO";
+    }
+}
+
+inline const char *levelPrefix(Level level) {
+    switch (level) {
+    case Level::Warning:
+        return "[ WARNING ] ";
+    case Level::Error:
+        return "[ ERROR ] ";
+    default:
+        return "[ INFO ] ";
+    }
+}
+
+/**
+ * @brief Formats one committed record into text. Runs on the flusher thread only.
+ */
+inline void format(const std::string &record, std::string &out) {
+    const char *cursor = record.data() + recordHeaderSize;
+    const char *end = record.data() + record.size();
+    out += levelPrefix(static_cast<Level>(record[0]));
+
+    // Values go through the stream once the record changed the format, the defaults have a fast path
+    std::ostringstream number;
+    bool formatted = false;
+    auto append = [&](const std::ostringstream &stream) { out += stream.str(); };
+    while (cursor < end) {
+        const ArgType type = static_cast<ArgType>(*cursor++);
+        if (formatted) {
+            number.str("");
+        }
+        switch (type) {
+        case ArgType::Bool:
+            if (formatted) {
+                number << static_cast<bool>(*cursor++);
+                append(number);
+            } else {
+                out += (*cursor++) ? "1" : "0";
+            }
+            break;
+        case ArgType::Char:
+            if (formatted) {
+                number << *cursor++;
+                append(number);
+            } else {
+                out += *cursor++;
+            }
+            break;
+        case ArgType::Signed: {
+            int64_t value;
+            std::memcpy(&value, cursor, sizeof(value));
+            cursor += sizeof(value);
+            if (formatted) {
+                number << value;
+                append(number);
+            } else {
+                out += std::to_string(value);
+            }
+            break;
+        }
+        case ArgType::Unsigned: {
+            uint64_t value;
+            std::memcpy(&value, cursor, sizeof(value));
+            cursor += sizeof(value);
+            if (formatted) {
+                number << value;
+                append(number);
+            } else {
+                out += std::to_string(value);
+            }
+            break;
+        }
+        case ArgType::Double: {
+            double value;
+            std::memcpy(&value, cursor, sizeof(value));
+            cursor += sizeof(value);
+            number.str("");
+            number << value;
+            append(number);
+            break;
+        }
+        case ArgType::String: {
+            uint32_t size;
+            std::memcpy(&size, cursor, sizeof(size));
+            cursor += sizeof(size);
+            if (formatted) {
+                number << std::string(cursor, size);
+                append(number);
+            } else {
+                out.append(cursor, size);
+            }
+            cursor += size;
+            break;
+        }
+        case ArgType::Text: {
+            uint32_t size;
+            std::memcpy(&size, cursor, sizeof(size));
+            cursor += sizeof(size);
+            out.append(cursor, size);
+            cursor += size;
+            break;
+        }
+        case ArgType::Format: {
+            FormatState state;
+            std::memcpy(&state.flags, cursor, sizeof(state.flags));
+            cursor += sizeof(state.flags);
+            std::memcpy(&state.precision, cursor, sizeof(state.precision));
+            cursor += sizeof(state.precision);
+            std::memcpy(&state.width, cursor, sizeof(state.width));
+            cursor += sizeof(state.width);
+            state.fill = *cursor++;
+            state.applyTo(number);
+            formatted = true;
+            break;
+        }
+        }
+    }
+    out += '\n';
+}
+
+inline int64_t timestamp(const std::string &record) {
+    int64_t value;
+    std::memcpy(&value, record.data() + sizeof(uint8_t), sizeof(value));
+    return value;
+}
+
+/**
+ * @class AsyncLogger
+ * @brief Owns the per-thread rings and the flusher thread
+ */
+class AsyncLogger {
+public:
+    static AsyncLogger &instance() {
+        // Intentionally leaked: threads may still log while static objects are being destroyed
+        static AsyncLogger *logger = new AsyncLogger();
+        return *logger;
+    }
+
+    Level level() const {
+        return static_cast<Level>(_level.load(std::memory_order_relaxed));
+    }
+
+    void setLevel(Level level) {
+        _level.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+    }
+
+    void setRateLimit(Level level, unsigned linesPerSecond) {
+        std::lock_guard<std::mutex> lock(_drainMutex);
+        _buckets[static_cast<size_t>(level)].rate = linesPerSecond;
+        _buckets[static_cast<size_t>(level)].tokens = linesPerSecond;
+    }
+
+    void setFlushInterval(std::chrono::milliseconds interval) {
+        _flushInterval.store(interval.count(), std::memory_order_relaxed);
+    }
+
+    std::shared_ptr<Ring> registerThread() {
+        std::shared_ptr<Ring> ring = std::make_shared<Ring>();
+        std::lock_guard<std::mutex> lock(_ringsMutex);
+        _rings.push_back(ring);
+        return ring;
+    }
+
+    /**
+     * @brief Publishes a committed record. Falls back to synchronous output after shutdown.
+     */
+    void commit(Ring &ring, const std::string &record, Level level) {
+        if (_stopped.load(std::memory_order_acquire)) {
+            std::string line;
+            format(record, line);
+            write(level, line);
+            return;
+        }
+        ring.push(record.data(), static_cast<uint32_t>(record.size()));
+        // Pairs with the fence in shutdown(): either its final drain sees this record, or this thread
+        // sees the logger stopped and drains the record itself
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_stopped.load(std::memory_order_relaxed)) {
+            drain();
+            return;
+        }
+        if (level == Level::Error) {
+            _wakeup.notify_one();
+        }
+    }
+
+    /**
+     * @brief Drains every ring on the calling thread and flushes the console
+     */
+    void flush() {
+        drain();
+    }
+
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(_wakeupMutex);
+            if (_stopped.exchange(true)) {
+                return;
+            }
+        }
+        _wakeup.notify_one();
+        if (_flusher.joinable()) {
+            _flusher.join();
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        drain();
+    }
+
+private:
+    struct Bucket {
+        unsigned rate = 0;          // lines per second, 0 - unlimited
+        double tokens = 0;
+        uint64_t dropped = 0;
+    };
+
+    AsyncLogger() : _level(static_cast<uint8_t>(Level::Info)), _flushInterval(20), _stopped(false) {
+        _lastRefill = std::chrono::steady_clock::now();
+        _flusher = std::thread(&AsyncLogger::run, this);
+        std::atexit([] { AsyncLogger::instance().shutdown(); });
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(_wakeupMutex);
+        while (!_stopped.load(std::memory_order_acquire)) {
+            _wakeup.wait_for(lock, std::chrono::milliseconds(_flushInterval.load(std::memory_order_relaxed)));
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+    }
+
+    void write(Level level, const std::string &text) {
+        std::ostream &stream = (level == Level::Error) ? std::cerr : std::cout;
+        stream.write(text.data(), text.size());
+        stream.flush();
+    }
+
+    bool admit(Level level) {
+        Bucket &bucket = _buckets[static_cast<size_t>(level)];
+        if (bucket.rate == 0) {
+            return true;
+        }
+        if (bucket.tokens < 1.0) {
+            bucket.dropped++;
+            return false;
+        }
+        bucket.tokens -= 1.0;
+        return true;
+    }
+
+    void refill() {
+        const auto now = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration<double>(now - _lastRefill).count();
+        _lastRefill = now;
+        for (auto &bucket : _buckets) {
+            bucket.tokens = std::min<double>(bucket.rate, bucket.tokens + elapsed * bucket.rate);
+        }
+    }
+
+    void drain() {
+        std::lock_guard<std::mutex> drainLock(_drainMutex);
+        std::vector<std::shared_ptr<Ring>> rings;
+        {
+            std::lock_guard<std::mutex> lock(_ringsMutex);
+            // Rings only referenced from here belong to threads that have exited
+            _rings.erase(std::remove_if(_rings.begin(), _rings.end(), [](const std::shared_ptr<Ring> &ring) {
+                return ring.use_count() == 1 && ring->empty();
+            }), _rings.end());
+            rings = _rings;
+        }
+
+        _records.clear();
+        uint64_t dropped = 0;
+        for (auto &ring : rings) {
+            std::string record;
+            while (ring->pop(record)) {
+                _records.push_back(std::move(record));
+            }
+            dropped += ring->takeDropped();
+        }
+        if (_records.empty() && dropped == 0) {
+            return;
+        }
+
+        // Each ring is ordered already, merge them into one timeline
+        std::stable_sort(_records.begin(), _records.end(), [](const std::string &l, const std::string &r) {
+            return timestamp(l) < timestamp(r);
+        });
+
+        refill();
+        std::string out, errors;
+        for (const auto &record : _records) {
+            const Level level = static_cast<Level>(record[0]);
+            if (!admit(level)) {
+                continue;
+            }
+            format(record, level == Level::Error ? errors : out);
+        }
+        for (size_t i = 0; i < bucketCount; ++i) {
+            if (_buckets[i].dropped != 0) {
+                out += std::string(levelPrefix(Level::Warning)) + std::to_string(_buckets[i].dropped) + " " +
+                       levelName(static_cast<Level>(i)) + " lines rate limited\n";
+                _buckets[i].dropped = 0;
+            }
+        }
+        if (dropped != 0) {
+            out += levelPrefix(Level::Warning) + std::to_string(dropped) + " log records dropped, ring full\n";
+        }
+
+        if (!out.empty()) write(Level::Info, out);
+        if (!errors.empty()) write(Level::Error, errors);
+    }
+
+    std::atomic<uint8_t> _level;
+    std::atomic<int64_t> _flushInterval;
+    std::atomic<bool> _stopped;
+
+    std::mutex _ringsMutex;
+    std::vector<std::shared_ptr<Ring>> _rings;
+
+    std::mutex _drainMutex;
+    std::vector<std::string> _records;
+    static constexpr size_t bucketCount = 3;
+    Bucket _buckets[bucketCount];
+    std::chrono::steady_clock::time_point _lastRefill;
+
+    std::mutex _wakeupMutex;
+    std::condition_variable _wakeup;
+    std::thread _flusher;
+};
+
+/**
+ * @brief Per-thread producer state: the ring plus one line being built per level
+ */
+struct ThreadState {
+    std::shared_ptr<Ring> ring;
+    Line lines[3];
+
+    ThreadState() : ring(AsyncLogger::instance().registerThread()) { }
+};
+
+inline ThreadState &threadState() {
+    static thread_local ThreadState state;
+    return state;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Sets the minimal level that is logged
+ */
+inline void setLevel(Level level) {
+    detail::AsyncLogger::instance().setLevel(level);
+}
+
+/**
+ * @brief Caps the number of lines per second written for a level, excess lines are counted and dropped
+ */
+inline void setRateLimit(Level level, unsigned linesPerSecond) {
+    detail::AsyncLogger::instance().setRateLimit(level, linesPerSecond);
+}
+
+/**
+ * @brief Writes out every pending record before returning
+ */
+inline void flush() {
+    detail::AsyncLogger::instance().flush();
+}
 
 /**
  * @class LogStream
  * @brief The LogStream class implements a stream for sample logging
  */
 class LogStream {
-    std::string _prefix;
-    std::ostream* _log_stream;
-    bool _new_line;
+    Level _level;
+
+    detail::Line &line() {
+        detail::Line &line = detail::threadState().lines[static_cast<size_t>(_level)];
+        if (!line.started) {
+            line.started = true;
+            line.active = _level >= detail::AsyncLogger::instance().level();
+            if (line.active) {
+                line.start(_level);
+            }
+        }
+        return line;
+    }
 
 public:
     /**
      * @brief A constructor. Creates an LogStream object
-     * @param prefix The prefix to print
+     * @param level The severity of the lines written to this stream
      */
-    LogStream(const std::string &prefix, std::ostream& log_stream)
-            : _prefix(prefix), _new_line(true) {
-        _log_stream = &log_stream;
-    }
+    explicit LogStream(Level level) : _level(level) { }
 
     /**
      * @brief A stream output operator to be used within the logger
@@ -47,27 +757,40 @@ public:
      */
     template<class T>
     LogStream &operator<<(const T &arg) {
-        if (_new_line) {
-            (*_log_stream) << "[ " << _prefix << " ] ";
-            _new_line = false;
+        detail::Line &current = line();
+        if (current.active) {
+            detail::encodeArg(current, arg);
         }
+        return *this;
+    }
 
-        (*_log_stream) << arg;
+    // Applies a per call site rate limit to the current line
+    LogStream &operator<<(const LogStreamEvery &every) {
+        detail::Line &current = line();
+        if (current.active && !every.limit->allow()) {
+            current.active = false;
+        }
         return *this;
     }
 
     // Specializing for LogStreamEndLine to support slog::endl
-    LogStream& operator<< (const LogStreamEndLine &/*arg*/) {
-        _new_line = true;
-
-        (*_log_stream) << std::endl;
+    LogStream &operator<<(const LogStreamEndLine &/*arg*/) {
+        detail::Line &current = line();
+        if (current.active) {
+            const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+            std::memcpy(&current.bytes[sizeof(uint8_t)], &now, sizeof(now));
+            detail::AsyncLogger::instance().commit(*detail::threadState().ring, current.bytes, _level);
+        }
+        current.started = false;
+        current.active = false;
         return *this;
     }
 };
 
 
-static LogStream info("INFO", std::cout);
-static LogStream warn("WARNING", std::cout);
-static LogStream err("ERROR", std::cerr);
+static LogStream info(Level::Info);
+static LogStream warn(Level::Warning);
+static LogStream err(Level::Error);
 
 }  // namespace slog
@@ -0,0 +1,23 @@
+/*
+ * decoder_check.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <iostream>
+#include <samples/check_runner.hpp>
+
+/// @brief message for the random blobs
+static const char blobs_message[] = "Optional. Random DetectionOutput blobs compared with the scalar reference.";
+
+DEFINE_uint32(blobs, 2000, blobs_message);
+
+/**
+* @brief Usage lines of the options next to -h and -filter
+*/
+static void showOptions() {
+    std::cout << "    -blobs                    " << blobs_message << std::endl;
+}
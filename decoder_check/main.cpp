@@ -0,0 +1,267 @@
+/*
+ * main.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ *
+ * Check of the SSD post processing: DetectionDecoder against a plain scalar decoder on
+ * random DetectionOutput blobs (every proposal count, end marker position and threshold
+ * edge), the region spec parser and the class aware NMS. Exits with 1 if any case fails.
+ */
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <samples/slog.hpp>
+#include "decoder_check.hpp"
+#include "../autopilot/include/Detection.h"
+#include "../autopilot/include/Detection.cpp"
+#include "../autopilot/include/DetectionDecoder.h"
+#include "../autopilot/include/DetectionDecoder.cpp"
+
+static const std::vector<ObjectClass> classes = {ObjectClass::Unknown, ObjectClass::Pedestrian, ObjectClass::Vehicle};
+
+/*
+ * What DetectionDecoder::decode does, one proposal and one coordinate at a time
+ */
+static std::vector<Detection> referenceDecode(const std::vector<float>& blob, int maxProposalCount, float threshold,
+                                              size_t frameWidth, size_t frameHeight, const std::vector<Region>& regions)
+{
+    std::vector<Detection> objects;
+    for (int i = 0; i < maxProposalCount; ++i)
+    {
+        const float* p = &blob[i * 7];
+        if (p[0] < 0)
+            break;
+        if (!(p[2] > threshold))
+            continue;
+        const size_t item = (size_t)p[0];
+        const Region region = item < regions.size() ? regions[item] : Region{0, 0, 1, 1};
+        Detection object;
+        object.label = (int)p[1];
+        object.objectClass = (size_t)object.label < classes.size() ? classes[object.label] : ObjectClass::Unknown;
+        object.confidence = p[2];
+        object.xmin = frameWidth * (region.x + p[3] * region.width);
+        object.ymin = frameHeight * (region.y + p[4] * region.height);
+        object.xmax = frameWidth * (region.x + p[5] * region.width);
+        object.ymax = frameHeight * (region.y + p[6] * region.height);
+        object.trackId = 0;
+        objects.push_back(object);
+    }
+    return objects;
+}
+
+/*
+ * maxProposalCount proposals of up to 3 batch items, confidences around the threshold and
+ * the end marker (image_id -1) anywhere, or none
+ */
+static std::vector<float> randomBlob(std::mt19937& random, int maxProposalCount, float threshold)
+{
+    std::uniform_real_distribution<float> unit(0, 1);
+    std::vector<float> blob(maxProposalCount * 7);
+    const int end = std::uniform_int_distribution<int>(0, maxProposalCount)(random);
+    for (int i = 0; i < maxProposalCount; ++i)
+    {
+        float* p = &blob[i * 7];
+        p[0] = i < end ? (float)std::uniform_int_distribution<int>(0, 2)(random) : -1;
+        p[1] = (float)std::uniform_int_distribution<int>(0, 4)(random);
+        const int edge = std::uniform_int_distribution<int>(0, 3)(random);
+        p[2] = edge == 0 ? threshold : edge == 1 ? std::nextafter(threshold, 1.0f) : unit(random);
+        p[3] = unit(random);
+        p[4] = unit(random);
+        p[5] = p[3] + (1 - p[3]) * unit(random);
+        p[6] = p[4] + (1 - p[4]) * unit(random);
+    }
+    return blob;
+}
+
+static std::string describe(const Detection& object)
+{
+    std::ostringstream text;
+    text << "{label " << object.label << ", " << objectClassName(object.objectClass) << ", " << object.confidence
+         << ", " << object.xmin << "," << object.ymin << "," << object.xmax << "," << object.ymax << "}";
+    return text.str();
+}
+
+static std::string compare(const std::vector<Detection>& objects, const std::vector<Detection>& expected)
+{
+    if (objects.size() != expected.size())
+        return std::to_string(objects.size()) + " detections, expected " + std::to_string(expected.size());
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        const Detection& a = objects[i];
+        const Detection& b = expected[i];
+        const float tolerance = 1e-3f;
+        if (a.label != b.label || a.objectClass != b.objectClass || a.confidence != b.confidence ||
+            std::fabs(a.xmin - b.xmin) > tolerance || std::fabs(a.ymin - b.ymin) > tolerance ||
+            std::fabs(a.xmax - b.xmax) > tolerance || std::fabs(a.ymax - b.ymax) > tolerance)
+            return "detection " + std::to_string(i) + " is " + describe(a) + ", expected " + describe(b);
+    }
+    return "";
+}
+
+static std::string checkRandomBlobs(const std::vector<Region>& regions)
+{
+    std::mt19937 random(1);
+    for (uint32_t n = 0; n < FLAGS_blobs; ++n)
+    {
+        // Every remainder of the 4 wide loop, and the 100 / 200 of the real models
+        const int maxProposalCount = n % 3 == 0 ? 100 + (int)(n % 2) * 100 : 1 + (int)(n % 17);
+        const float threshold = std::uniform_real_distribution<float>(0.05f, 0.95f)(random);
+        const std::vector<float> blob = randomBlob(random, maxProposalCount, threshold);
+
+        DetectionDecoder decoder(maxProposalCount, threshold, classes);
+        // decode appends, keep something in front
+        std::vector<Detection> objects(1), expected = referenceDecode(blob, maxProposalCount, threshold, 640, 480, regions);
+        decoder.decode(blob.data(), 640, 480, regions, objects);
+        objects.erase(objects.begin());
+        const std::string error = compare(objects, expected);
+        if (!error.empty())
+            return "blob " + std::to_string(n) + " of " + std::to_string(maxProposalCount) + " proposals: " + error;
+    }
+    return "";
+}
+
+static std::string expectRegions(const std::string& spec, const std::vector<Region>& expected)
+{
+    std::vector<Region> regions;
+    try {
+        regions = parseRegions(spec);
+    }
+    catch (const std::logic_error& error) {
+        return "\"" + spec + "\" rejected: " + error.what();
+    }
+    if (regions.size() != expected.size())
+        return "\"" + spec + "\" gives " + std::to_string(regions.size()) + " regions, expected " +
+               std::to_string(expected.size());
+    for (size_t i = 0; i < regions.size(); ++i)
+    {
+        const Region& a = regions[i];
+        const Region& b = expected[i];
+        if (std::fabs(a.x - b.x) > 1e-5f || std::fabs(a.y - b.y) > 1e-5f ||
+            std::fabs(a.width - b.width) > 1e-5f || std::fabs(a.height - b.height) > 1e-5f)
+        {
+            std::ostringstream text;
+            text << "\"" << spec << "\" region " << i << " is " << a.x << "," << a.y << "," << a.width << "," << a.height;
+            return text.str();
+        }
+    }
+    return "";
+}
+
+static std::string expectBadRegions(const std::string& spec)
+{
+    try {
+        parseRegions(spec);
+    }
+    catch (const std::logic_error&) {
+        return "";
+    }
+    return "\"" + spec + "\" accepted";
+}
+
+static Detection box(int label, ObjectClass objectClass, float confidence, float x, float y, float size = 10)
+{
+    return Detection{label, objectClass, confidence, x, y, x + size, y + size, 0};
+}
+
+static std::string expectKept(std::vector<Detection> objects, float iouThreshold, const std::vector<float>& confidences)
+{
+    suppressDuplicates(objects, iouThreshold);
+    std::vector<float> kept;
+    for (const Detection& object : objects)
+        kept.push_back(object.confidence);
+    if (kept == confidences)
+        return "";
+    std::ostringstream text;
+    text << "kept";
+    for (float confidence : kept)
+        text << " " << confidence;
+    text << ", expected";
+    for (float confidence : confidences)
+        text << " " << confidence;
+    return text.str();
+}
+
+static std::vector<CheckCase> cases = {
+    {"filter_reference", [] { return checkRandomBlobs({}); }},
+    {"decode_regions", [] {
+        return checkRandomBlobs({Region{0, 0, 0.5f, 1}, Region{0.5f, 0, 0.5f, 1}, Region{0.25f, 0.25f, 0.5f, 0.5f}});
+    }},
+    {"end_marker_first", [] {
+        std::vector<float> blob(8 * 7, 0.9f);
+        blob[0] = -1;
+        DetectionDecoder decoder(8, 0.5f, classes);
+        const size_t kept = decoder.filter(blob.data()).size();
+        return kept == 0 ? "" : std::to_string(kept) + " proposals kept after the end marker";
+    }},
+    {"unknown_label", [] {
+        const std::vector<float> blob = {0, 9, 0.9f, 0.1f, 0.1f, 0.2f, 0.2f, -1, 0, 0, 0, 0, 0, 0};
+        DetectionDecoder decoder(2, 0.5f, classes);
+        std::vector<Detection> objects;
+        decoder.decode(blob.data(), 100, 100, {}, objects);
+        return objects.size() == 1 && objects[0].label == 9 && objects[0].objectClass == ObjectClass::Unknown ? "" :
+               "label 9 not decoded as Unknown";
+    }},
+    {"regions", [] {
+        std::string error = expectRegions("", {});
+        if (error.empty())
+            error = expectRegions("full", {Region{0, 0, 1, 1}});
+        if (error.empty())
+            error = expectRegions("0.1,0.2,0.3,0.4 full", {Region{0.1f, 0.2f, 0.3f, 0.4f}, Region{0, 0, 1, 1}});
+        if (error.empty())
+            error = expectRegions("grid:2x2", {Region{0, 0, 0.5f, 0.5f}, Region{0.5f, 0, 0.5f, 0.5f},
+                                               Region{0, 0.5f, 0.5f, 0.5f}, Region{0.5f, 0.5f, 0.5f, 0.5f}});
+        if (error.empty())
+            error = expectRegions("grid:3x1:0.5", {Region{0, 0, 0.5f, 1}, Region{0.25f, 0, 0.5f, 1}, Region{0.5f, 0, 0.5f, 1}});
+        return error;
+    }},
+    {"bad_regions", [] {
+        for (const char* spec : {"grid:0x2", "grid:2x0", "grid:2x2:1", "grid:2x2:-0.1", "grid:2x2:abc", "grid:2x2:",
+                                 "grid:2x2x", "grid:2x2:0.5:1", "grid:2", "0.5,0.5,0.6,0.1", "1,2,3", "0.1,0.1,0.2,0.2x",
+                                 "0,0,0,1", "whole"})
+        {
+            const std::string error = expectBadRegions(spec);
+            if (!error.empty())
+                return error;
+        }
+        return std::string();
+    }},
+    {"nms_same_class", [] {
+        // 10 x 10 boxes shifted by 2 overlap by 80 / 120
+        return expectKept({box(1, ObjectClass::Pedestrian, 0.6f, 2, 0), box(1, ObjectClass::Pedestrian, 0.9f, 0, 0),
+                           box(1, ObjectClass::Pedestrian, 0.7f, 50, 50)}, 0.45f, {0.9f, 0.7f});
+    }},
+    {"nms_threshold", [] {
+        // Shifted by 5 they overlap by 50 / 150
+        std::string error = expectKept({box(1, ObjectClass::Pedestrian, 0.9f, 0, 0), box(1, ObjectClass::Pedestrian, 0.6f, 5, 0)},
+                                       0.34f, {0.9f, 0.6f});
+        if (error.empty())
+            error = expectKept({box(1, ObjectClass::Pedestrian, 0.9f, 0, 0), box(1, ObjectClass::Pedestrian, 0.6f, 5, 0)},
+                               0.33f, {0.9f});
+        return error;
+    }},
+    {"nms_classes", [] {
+        // Labels of different models meaning the same class are merged, unknown labels only with themselves
+        std::string error = expectKept({box(1, ObjectClass::Vehicle, 0.9f, 0, 0), box(7, ObjectClass::Vehicle, 0.8f, 0, 0),
+                                        box(2, ObjectClass::Pedestrian, 0.7f, 0, 0)}, 0.5f, {0.9f, 0.7f});
+        if (error.empty())
+            error = expectKept({box(3, ObjectClass::Unknown, 0.9f, 0, 0), box(4, ObjectClass::Unknown, 0.8f, 0, 0),
+                                box(3, ObjectClass::Unknown, 0.7f, 1, 0)}, 0.5f, {0.9f, 0.8f});
+        return error;
+    }},
+    {"nms_chain", [] {
+        // The 0.8 box is suppressed by 0.9, so it does not suppress the 0.7 box that only overlaps it
+        return expectKept({box(1, ObjectClass::Vehicle, 0.9f, 0, 0), box(1, ObjectClass::Vehicle, 0.8f, 3, 0),
+                           box(1, ObjectClass::Vehicle, 0.7f, 6, 0)}, 0.3f, {0.9f, 0.7f});
+    }},
+};
+
+int main(int argc, char *argv[])
+{
+    return runChecks(argc, argv, "decoder_check", cases, showOptions);
+}
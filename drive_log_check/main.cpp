@@ -0,0 +1,238 @@
+/*
+ * main.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ *
+ * Round trip check of the drive log: records written by DriveLogWriter to /tmp are read
+ * back by DriveLogReader field by field, through the index and, for a log cut short, by
+ * scanning the chunks. Also checks seek(), the dropped record count in the index and a
+ * writer whose writes fail. Exits with 1 if any case fails.
+ */
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <opencv2/core/core.hpp>
+#include <samples/check_runner.hpp>
+#include <samples/slog.hpp>
+#include "../autopilot/include/ControlState.h"
+#include "../autopilot/include/ControlState.cpp"
+#include "../autopilot/include/VehicleProtocol.h"
+#include "../autopilot/include/VehicleProtocol.cpp"
+#include "../autopilot/include/Detection.h"
+#include "../autopilot/include/Detection.cpp"
+#include "../autopilot/include/WorldModel.h"
+#include "../autopilot/include/WorldModel.cpp"
+#include "../autopilot/include/DriveLog.h"
+#include "../autopilot/include/DriveLog.cpp"
+
+/*
+ * Log path in /tmp, the file is removed with the object
+ */
+struct TempLog
+{
+    std::string path;
+
+    explicit TempLog(const std::string& name):
+        path("/tmp/drive_log_check_" + std::to_string(getpid()) + "_" + name + ".log")
+    {
+    }
+
+    ~TempLog()
+    {
+        std::remove(path.c_str());
+    }
+};
+
+static const uint64_t msNs = 1000000;
+
+static VehicleCommand command(int16_t speed, int8_t steer)
+{
+    VehicleCommand command;
+    command.speed = speed;
+    command.steer = steer;
+    return command;
+}
+
+/*
+ * Commands 500 ms apart from 500 ms on, version i + 1; a chunk spans at most a second, so
+ * ten of them fill the chunks [0.5 s, 1.5 s] [2 s, 3 s] [3.5 s, 4.5 s] [5 s]
+ */
+static void writeCommands(DriveLogWriter& writer, int count)
+{
+    for (int i = 0; i < count; ++i)
+        writer.logCommand((i + 1) * 500 * msNs, command(i, 0), i + 1);
+}
+
+static std::vector<uint64_t> timestampsOf(DriveLogReader& reader)
+{
+    std::vector<uint64_t> timestamps;
+    DriveLogRecord record;
+    while (reader.next(record))
+        timestamps.push_back(record.timestampNs);
+    return timestamps;
+}
+
+static std::vector<CheckCase> cases = {
+    {"round_trip", [] {
+        TempLog log("round_trip");
+        const cv::Mat frame(24, 32, CV_8UC3, cv::Scalar(40, 120, 200));
+        DetectionSet set;
+        set.frameId = 2;
+        set.timestampNs = 2000;
+        set.objects = {Detection{7, ObjectClass::Vehicle, 0.75f, 1.5f, 2.5f, 30.5f, 40.5f, 3},
+                       Detection{-1, ObjectClass::Unknown, 0.5f, -4, -8, 16, 32, 0}};
+        LaneState lane;
+        lane.steeringAngle = -0.25f;
+        lane.valid = true;
+        lane.frameId = 2;
+        lane.timestampNs = 2100;
+        const std::vector<float> center = {10.5f, 11.25f, 12};
+        VehicleCommand sent = command(-120, 35);
+        sent.lightsOn = true;
+        sent.stopOn = true;
+        {
+            // Small chunks, the records span several of them
+            DriveLogWriter writer(log.path, 95, 64);
+            writer.logSource("clip.mp4");
+            writer.logFrame(1, 1000, frame);
+            writer.logFrameRef(2, 2000, 7);
+            writer.logDetections(DetectorId::Traffic, set);
+            writer.logLane(lane, center);
+            writer.logCommand(3000, sent, 9);
+            writer.close();
+            if (writer.getQueued() != 6 || writer.getDropped() != 0 || writer.hasFailed())
+                return "writer queued " + std::to_string(writer.getQueued()) + ", dropped " +
+                       std::to_string(writer.getDropped()) + (writer.hasFailed() ? ", failed" : "");
+        }
+
+        DriveLogReader reader(log.path);
+        if (!reader.hasIndex() || reader.droppedRecords() != 0 || reader.chunkCount() < 2)
+            return "index of " + std::to_string(reader.chunkCount()) + " chunks, " +
+                   std::to_string(reader.droppedRecords()) + " dropped";
+        DriveLogRecord record;
+        if (!reader.next(record) || DriveLogReader::decodeSource(record) != "clip.mp4")
+            return std::string("source");
+
+        if (!reader.next(record) || record.frameId != 1 || record.timestampNs != 1000)
+            return std::string("frame record");
+        const cv::Mat decoded = DriveLogReader::decodeFrame(record);
+        if (decoded.size() != frame.size() || decoded.type() != frame.type() || cv::norm(decoded, frame, cv::NORM_INF) > 4)
+            return std::string("frame pixels");
+
+        uint64_t index = 0;
+        if (!reader.next(record) || !DriveLogReader::decodeFrameRef(record, index) || index != 7 || record.frameId != 2)
+            return std::string("frame reference");
+
+        DetectorId detector = DetectorId::Cars;
+        DetectionSet objects;
+        if (!reader.next(record) || !DriveLogReader::decodeDetections(record, detector, objects) ||
+            detector != DetectorId::Traffic || objects.frameId != 2 || objects.timestampNs != 2000 ||
+            objects.objects.size() != 2)
+            return std::string("detections");
+        for (size_t i = 0; i < 2; ++i)
+        {
+            const Detection& a = set.objects[i];
+            const Detection& b = objects.objects[i];
+            if (a.label != b.label || a.objectClass != b.objectClass || a.confidence != b.confidence ||
+                a.xmin != b.xmin || a.ymin != b.ymin || a.xmax != b.xmax || a.ymax != b.ymax || a.trackId != b.trackId)
+                return "detection " + std::to_string(i);
+        }
+
+        LaneState readLane;
+        std::vector<float> readCenter;
+        if (!reader.next(record) || !DriveLogReader::decodeLane(record, readLane, readCenter) ||
+            readLane.steeringAngle != lane.steeringAngle || readLane.valid != lane.valid ||
+            readLane.frameId != lane.frameId || readLane.timestampNs != lane.timestampNs || readCenter != center)
+            return std::string("lane");
+
+        VehicleCommand readCommand;
+        uint32_t version = 0;
+        if (!reader.next(record) || !DriveLogReader::decodeCommand(record, readCommand, version) || version != 9 ||
+            record.timestampNs != 3000 || readCommand.speed != sent.speed || readCommand.steer != sent.steer ||
+            readCommand.lightsOn != sent.lightsOn || readCommand.stopOn != sent.stopOn)
+            return std::string("command");
+
+        if (reader.next(record))
+            return std::string("record after the last one");
+        return std::string();
+    }},
+    {"seek", [] {
+        TempLog log("seek");
+        {
+            DriveLogWriter writer(log.path);
+            writeCommands(writer, 10);
+        }
+        DriveLogReader reader(log.path);
+        if (reader.chunkCount() != 4 || reader.firstTimestampNs() != 500 * msNs || reader.lastTimestampNs() != 5000 * msNs)
+            return std::to_string(reader.chunkCount()) + " chunks";
+
+        // The chunk holding 4 s starts at 3.5 s
+        DriveLogRecord record;
+        if (!reader.seek(4000 * msNs) || !reader.next(record) || record.timestampNs != 3500 * msNs)
+            return std::string("seek to 4 s");
+        if (reader.seek(5001 * msNs) || reader.next(record))
+            return std::string("seek past the end");
+        reader.rewind();
+        if (timestampsOf(reader).size() != 10)
+            return std::string("rewind");
+        return std::string();
+    }},
+    {"unclosed", [] {
+        TempLog log("unclosed"), cut("unclosed_cut");
+        {
+            DriveLogWriter writer(log.path);
+            writeCommands(writer, 10);
+        }
+
+        // Without the index and the trailer, and the last chunk one byte short
+        std::ifstream in(log.path, std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        bytes.resize(bytes.size() - 4 * 32 - 24 - 1);
+        std::ofstream(cut.path, std::ios::binary).write(bytes.data(), bytes.size());
+
+        DriveLogReader reader(cut.path);
+        if (reader.hasIndex() || reader.chunkCount() != 3)
+            return "read " + std::string(reader.hasIndex() ? "an index" : "no index") + " and " +
+                   std::to_string(reader.chunkCount()) + " chunks";
+        const std::vector<uint64_t> timestamps = timestampsOf(reader);
+        if (timestamps.size() != 9 || timestamps.back() != 4500 * msNs)
+            return std::to_string(timestamps.size()) + " records read";
+        return std::string();
+    }},
+    {"dropped", [] {
+        TempLog log("dropped");
+        {
+            // Every record finds the queue full
+            DriveLogWriter writer(log.path, 80, 1 << 20, 0);
+            writeCommands(writer, 5);
+            writer.close();
+            if (writer.getDropped() != 5 || writer.getQueued() != 0)
+                return "writer dropped " + std::to_string(writer.getDropped());
+        }
+        DriveLogReader reader(log.path);
+        if (!reader.hasIndex() || reader.droppedRecords() != 5 || !timestampsOf(reader).empty())
+            return "index records " + std::to_string(reader.droppedRecords()) + " dropped";
+        return std::string();
+    }},
+    {"write_failure", [] {
+        // Every write to /dev/full fails with ENOSPC
+        DriveLogWriter writer("/dev/full");
+        writeCommands(writer, 10);
+        writer.close();
+        if (!writer.hasFailed() || writer.getDropped() != 10 || writer.getBytes() != 0)
+            return std::string(writer.hasFailed() ? "failed" : "not failed") + ", " +
+                   std::to_string(writer.getDropped()) + " dropped, " + std::to_string(writer.getBytes()) + " bytes";
+        return std::string();
+    }},
+};
+
+int main(int argc, char *argv[])
+{
+    return runChecks(argc, argv, "drive_log_check", cases);
+}
@@ -0,0 +1,40 @@
+/*
+ * drive_log_diff.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <gflags/gflags.h>
+#include <iostream>
+
+/// @brief message for help argument
+static const char help_message[] = "Print a usage message.";
+
+/// @brief messages for the compared logs
+static const char a_message[] = "Required. Reference drive log, e.g. a replay before a change.";
+static const char b_message[] = "Required. Drive log compared against it, e.g. a replay of the same log after the change.";
+
+/// @brief message for the compared streams
+static const char streams_message[] = "Optional. Streams to compare, separated by ',': lanes, cars, traffic, commands.";
+
+DEFINE_bool(h, false, help_message);
+DEFINE_string(a, "", a_message);
+DEFINE_string(b, "", b_message);
+DEFINE_string(streams, "lanes,cars,traffic,commands", streams_message);
+
+/**
+* @brief This function show a help message
+*/
+static void showUsage() {
+    std::cout << std::endl;
+    std::cout << "drive_log_diff [OPTION]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << std::endl;
+    std::cout << "    -h                        " << help_message << std::endl;
+    std::cout << "    -a \"<path>\"               " << a_message << std::endl;
+    std::cout << "    -b \"<path>\"               " << b_message << std::endl;
+    std::cout << "    -streams \"<list>\"         " << streams_message << std::endl;
+}
@@ -0,0 +1,166 @@
+/*
+ * main.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ *
+ * Compares the outputs recorded in two drive logs bit by bit: the lane geometry and the
+ * detections of every frame and the first command sent for every control version. Meant
+ * for two replays of the same log (autopilot -replay), before and after a change; the
+ * timestamps are ignored, everything else has to match. Exits with 1 on any difference, or
+ * if a log dropped records while it was written.
+ */
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <set>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <samples/slog.hpp>
+#include "drive_log_diff.hpp"
+#include "../autopilot/include/ControlState.h"
+#include "../autopilot/include/ControlState.cpp"
+#include "../autopilot/include/VehicleProtocol.h"
+#include "../autopilot/include/VehicleProtocol.cpp"
+#include "../autopilot/include/Detection.h"
+#include "../autopilot/include/Detection.cpp"
+#include "../autopilot/include/WorldModel.h"
+#include "../autopilot/include/WorldModel.cpp"
+#include "../autopilot/include/DriveLog.h"
+#include "../autopilot/include/DriveLog.cpp"
+
+struct Output
+{
+    uint64_t frameId;
+    std::vector<uint8_t> bits;
+    std::string text;          // shown for the first difference
+};
+
+struct Streams
+{
+    std::vector<Output> lanes;
+    std::vector<Output> detections[(size_t)DetectorId::Count];
+    std::vector<Output> commands;
+};
+
+static Output output(const DriveLogRecord& record, size_t size, const std::string& text)
+{
+    return Output{record.frameId, std::vector<uint8_t>(record.data, record.data + size), text};
+}
+
+static Streams readStreams(const std::string& path)
+{
+    DriveLogReader reader(path);
+    if (!reader.hasIndex())
+        slog::warn << path << " was not closed, comparing up to its last complete chunk" << slog::endl;
+    // A dropped record shifts every later one of its stream, nothing after it would compare
+    else if (reader.droppedRecords() != 0)
+        throw std::logic_error(path + " dropped " + std::to_string(reader.droppedRecords()) +
+                               " records while recording, record it again (-log_frames ref writes less)");
+
+    Streams streams;
+    std::set<uint32_t> versions;
+    DriveLogRecord record;
+    while (reader.next(record))
+    {
+        std::ostringstream text;
+        LaneState lane;
+        std::vector<float> center;
+        DetectorId detector = DetectorId::Cars;
+        DetectionSet set;
+        VehicleCommand command;
+        uint32_t version = 0;
+        if (DriveLogReader::decodeLane(record, lane, center))
+        {
+            text << "steer " << lane.steeringAngle << (lane.valid ? "" : " no lanes");
+            streams.lanes.push_back(output(record, record.size, text.str()));
+        }
+        else if (DriveLogReader::decodeDetections(record, detector, set))
+        {
+            text << set.objects.size() << " objects";
+            streams.detections[(size_t)detector].push_back(output(record, record.size, text.str()));
+        }
+        else if (DriveLogReader::decodeCommand(record, command, version) && versions.insert(version).second)
+        {
+            // The actuator sends a version until the next one, only the first send follows the planner
+            text << "version " << version << " speed " << command.speed << " steer " << (int)command.steer
+                 << (command.stopOn ? " stop" : "") << (command.lightsOn ? " lights" : "");
+            streams.commands.push_back(output(record, 4, text.str()));
+        }
+    }
+    return streams;
+}
+
+/*
+ * Prints one result line, returns true if both streams are the same
+ */
+static bool compare(std::ostream& results, const std::string& name, const std::vector<Output>& a,
+                    const std::vector<Output>& b)
+{
+    size_t differing = 0, first = std::min(a.size(), b.size());
+    for (size_t i = 0; i < std::min(a.size(), b.size()); ++i)
+    {
+        if (a[i].bits == b[i].bits)
+            continue;
+        if (differing++ == 0)
+            first = i;
+    }
+    const bool same = differing == 0 && a.size() == b.size();
+
+    results << std::left << std::setw(12) << name << std::right << std::setw(10) << a.size() << std::setw(10)
+            << b.size() << std::setw(12) << differing << (same ? "  SAME" : "  DIFFERENT") << std::endl;
+    if (!same && first < a.size() && first < b.size())
+        results << "    first at " << first << ": frame " << a[first].frameId << " " << a[first].text
+                << " | frame " << b[first].frameId << " " << b[first].text << std::endl;
+    else if (!same)
+        results << "    " << (a.size() > b.size() ? "-b" : "-a") << " ends after " << first << " records" << std::endl;
+    return same;
+}
+
+int main(int argc, char *argv[])
+{
+    gflags::ParseCommandLineNonHelpFlags(&argc, &argv, true);
+    if (FLAGS_h) {
+        showUsage();
+        return 0;
+    }
+    if (FLAGS_a.empty() || FLAGS_b.empty()) {
+        slog::err << "Parameters -a and -b are required" << slog::endl;
+        showUsage();
+        return 1;
+    }
+
+    Streams a, b;
+    try {
+        a = readStreams(FLAGS_a);
+        b = readStreams(FLAGS_b);
+    }
+    catch (const std::exception& error) {
+        slog::err << error.what() << slog::endl;
+        slog::flush();
+        return 1;
+    }
+
+    std::ostream& results = std::cout;
+    results << std::left << std::setw(12) << "stream" << std::right << std::setw(10) << "a" << std::setw(10) << "b"
+            << std::setw(12) << "differing" << "  result" << std::endl;
+
+    const std::string streams = "," + FLAGS_streams + ",";
+    auto wanted = [&](const std::string& name) { return streams.find("," + name + ",") != std::string::npos; };
+    bool same = true;
+    if (wanted("lanes"))
+        same &= compare(results, "lanes", a.lanes, b.lanes);
+    if (wanted("cars"))
+        same &= compare(results, "cars", a.detections[(size_t)DetectorId::Cars], b.detections[(size_t)DetectorId::Cars]);
+    if (wanted("traffic"))
+        same &= compare(results, "traffic", a.detections[(size_t)DetectorId::Traffic],
+                        b.detections[(size_t)DetectorId::Traffic]);
+    if (wanted("commands"))
+        same &= compare(results, "commands", a.commands, b.commands);
+
+    slog::info << (same ? "The logs match" : "The logs differ") << slog::endl;
+    slog::flush();
+    return same ? 0 : 1;
+}
@@ -0,0 +1,372 @@
+/*
+ * main.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ *
+ * Check of the format readers on small files written to /tmp: the in place view() of a
+ * mapped BMP in both row orders, readInto() and getData() producing the same packed pixels,
+ * readInto() refusing a size the reader cannot produce, readers picked by the file contents
+ * whatever the extension, and MnistDataset images, labels and batches. Exits with 1 if any case fails.
+ */
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <samples/check_runner.hpp>
+#include <samples/slog.hpp>
+#include "../common/format_reader/mapped_file.cpp"
+#include "../common/format_reader/bmp.cpp"
+#include "../common/format_reader/mnist_dataset.cpp"
+#include "../common/format_reader/MnistUbyte.cpp"
+#include "../common/format_reader/format_reader.cpp"
+
+using namespace FormatReader;
+
+/*
+ * File in /tmp, removed with the object
+ */
+struct TempFile
+{
+    std::string path;
+
+    TempFile(const std::string& name, const std::vector<unsigned char>& bytes):
+        path("/tmp/format_reader_check_" + std::to_string(getpid()) + "_" + name)
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+
+    ~TempFile()
+    {
+        std::remove(path.c_str());
+    }
+};
+
+typedef std::unique_ptr<Reader, void (*)(Reader*)> ReaderPtr;
+
+static ReaderPtr open(const TempFile& file)
+{
+    return ReaderPtr(Registry::CreateReader(file.path.c_str()), [](Reader* reader) {
+        if (reader != nullptr)
+            reader->Release();
+    });
+}
+
+static void put32(std::vector<unsigned char>& bytes, size_t offset, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+        bytes[offset + i] = (value >> (8 * i)) & 0xFF;
+}
+
+static void put16(std::vector<unsigned char>& bytes, size_t offset, uint16_t value)
+{
+    bytes[offset] = value & 0xFF;
+    bytes[offset + 1] = value >> 8;
+}
+
+static const size_t bmpWidth = 3, bmpHeight = 2;
+
+// Distinct value of every pixel byte, in top-down order
+static unsigned char pixel(size_t x, size_t y, size_t c)
+{
+    return static_cast<unsigned char>(1 + y * 30 + x * 3 + c);
+}
+
+static std::vector<unsigned char> expectedPixels()
+{
+    std::vector<unsigned char> pixels;
+    for (size_t y = 0; y < bmpHeight; ++y)
+        for (size_t x = 0; x < bmpWidth; ++x)
+            for (size_t c = 0; c < 3; ++c)
+                pixels.push_back(pixel(x, y, c));
+    return pixels;
+}
+
+/*
+ * 24 bit BMP of bmpWidth x bmpHeight, rows padded from 9 to 12 bytes and stored bottom-up
+ * unless topDown
+ */
+static std::vector<unsigned char> bmp(bool topDown)
+{
+    const size_t rowSize = 12, offset = 14 + 40;
+    std::vector<unsigned char> bytes(offset + rowSize * bmpHeight, 0);
+    bytes[0] = 'B';
+    bytes[1] = 'M';
+    put32(bytes, 2, bytes.size());
+    put32(bytes, 10, offset);
+    put32(bytes, 14, 40);
+    put32(bytes, 18, bmpWidth);
+    put32(bytes, 22, topDown ? -static_cast<int32_t>(bmpHeight) : bmpHeight);
+    put16(bytes, 26, 1);
+    put16(bytes, 28, 24);
+    for (size_t y = 0; y < bmpHeight; ++y)
+    {
+        const size_t fileRow = topDown ? y : bmpHeight - 1 - y;
+        for (size_t x = 0; x < bmpWidth; ++x)
+            for (size_t c = 0; c < 3; ++c)
+                bytes[offset + fileRow * rowSize + x * 3 + c] = pixel(x, y, c);
+    }
+    return bytes;
+}
+
+static void putBigEndian32(std::vector<unsigned char>& bytes, uint32_t value)
+{
+    for (int i = 3; i >= 0; --i)
+        bytes.push_back((value >> (8 * i)) & 0xFF);
+}
+
+static const size_t mnistCount = 5, mnistWidth = 3, mnistHeight = 2, mnistImageSize = mnistWidth * mnistHeight;
+
+static unsigned char mnistPixel(size_t image, size_t i)
+{
+    return static_cast<unsigned char>(1 + image * 10 + i);
+}
+
+/*
+ * idx3-ubyte file of mnistCount images, the last missingBytes pixel bytes cut off
+ */
+static std::vector<unsigned char> mnistImages(size_t missingBytes = 0)
+{
+    std::vector<unsigned char> bytes;
+    putBigEndian32(bytes, MnistDataset::imagesMagic);
+    putBigEndian32(bytes, mnistCount);
+    putBigEndian32(bytes, mnistHeight);
+    putBigEndian32(bytes, mnistWidth);
+    for (size_t image = 0; image < mnistCount; ++image)
+        for (size_t i = 0; i < mnistImageSize; ++i)
+            bytes.push_back(mnistPixel(image, i));
+    bytes.resize(bytes.size() - missingBytes);
+    return bytes;
+}
+
+/*
+ * idx1-ubyte file labelling image i with 9 - i
+ */
+static std::vector<unsigned char> mnistLabels(size_t count = mnistCount)
+{
+    std::vector<unsigned char> bytes;
+    putBigEndian32(bytes, MnistDataset::labelsMagic);
+    putBigEndian32(bytes, count);
+    for (size_t image = 0; image < count; ++image)
+        bytes.push_back(static_cast<unsigned char>(9 - image));
+    return bytes;
+}
+
+// Empty when images [first, first + count) are back to back in batch
+template <typename T>
+static std::string checkBatch(const T* batch, size_t first, size_t count, T scale)
+{
+    for (size_t image = 0; image < count; ++image)
+        for (size_t i = 0; i < mnistImageSize; ++i)
+            if (batch[image * mnistImageSize + i] != static_cast<T>(mnistPixel(first + image, i) * scale))
+                return "image " + std::to_string(first + image) + " byte " + std::to_string(i) + " differs";
+    return std::string();
+}
+
+static std::string checkView(bool topDown)
+{
+    TempFile file(topDown ? "top_down.bmp" : "bottom_up.bmp", bmp(topDown));
+    ReaderPtr reader = open(file);
+    if (!reader)
+        return "not read";
+    const ImageView view = reader->view();
+    if (view.empty() || view.width != bmpWidth || view.height != bmpHeight || view.channels != 3)
+        return "view " + std::to_string(view.width) + "x" + std::to_string(view.height) + "x" +
+               std::to_string(view.channels);
+    if (topDown ? view.stride != 12 : view.stride != -12)
+        return "stride " + std::to_string(view.stride);
+    for (size_t y = 0; y < bmpHeight; ++y)
+        for (size_t x = 0; x < bmpWidth; ++x)
+            for (size_t c = 0; c < 3; ++c)
+                if (view.row(y)[x * 3 + c] != pixel(x, y, c))
+                    return "pixel " + std::to_string(x) + "," + std::to_string(y) + " channel " + std::to_string(c) +
+                           " is " + std::to_string(view.row(y)[x * 3 + c]);
+    return std::string();
+}
+
+static std::vector<CheckCase> cases = {
+    {"bmp_view_bottom_up", [] {
+        return checkView(false);
+    }},
+    {"bmp_view_top_down", [] {
+        return checkView(true);
+    }},
+    {"bmp_read_into", [] {
+        const std::vector<unsigned char> expected = expectedPixels();
+        for (bool topDown : {false, true})
+        {
+            TempFile file("read_into.bmp", bmp(topDown));
+            ReaderPtr reader = open(file);
+            if (!reader)
+                return std::string("not read");
+            std::vector<unsigned char> pixels(expected.size(), 0);
+            if (!reader->readInto(pixels.data()) || pixels != expected)
+                return std::string(topDown ? "top-down" : "bottom-up") + " readInto differs";
+            pixels.assign(expected.size(), 0);
+            if (!reader->readInto(pixels.data(), bmpWidth, bmpHeight) || pixels != expected)
+                return std::string(topDown ? "top-down" : "bottom-up") + " readInto at the image size differs";
+            std::shared_ptr<unsigned char> data = reader->getData();
+            if (!data || reader->size() != expected.size() ||
+                std::memcmp(data.get(), expected.data(), expected.size()) != 0)
+                return std::string(topDown ? "top-down" : "bottom-up") + " getData differs";
+        }
+        return std::string();
+    }},
+    {"bmp_read_into_resize", [] {
+        TempFile file("resize.bmp", bmp(false));
+        ReaderPtr reader = open(file);
+        if (!reader)
+            return std::string("not read");
+        // Without OpenCV the readers cannot resize, dst must stay untouched
+        std::vector<unsigned char> pixels(4 * 4 * 3, 0);
+        if (reader->readInto(pixels.data(), 4, 4))
+            return std::string("readInto accepted 4x4");
+        for (unsigned char value : pixels)
+            if (value != 0)
+                return std::string("readInto wrote to dst");
+        return std::string();
+    }},
+    {"bmp_capabilities", [] {
+        TempFile file("capabilities.bmp", bmp(false));
+        ReaderCapabilities capabilities;
+        if (!Registry::Probe(file.path.c_str(), capabilities))
+            return std::string("not probed");
+        if (std::string(capabilities.name) != "BitMap" || !capabilities.mapped || capabilities.resize)
+            return std::string("capabilities of ") + capabilities.name;
+        return std::string();
+    }},
+    {"probe_by_contents", [] {
+        // The magic bytes decide, a misleading extension does not
+        TempFile bitmap("bitmap.jpg", bmp(false)), mnist("mnist.bin", mnistImages());
+        TempFile text("text.bmp", std::vector<unsigned char>{'P', '3', '\n', '1', ' ', '1', '\n'});
+        const struct
+        {
+            const TempFile& file;
+            const char* reader;
+        } expected[] = {{bitmap, "BitMap"}, {mnist, "MnistUbyte"}, {text, ""}};
+        for (const auto& entry : expected)
+        {
+            ReaderCapabilities capabilities;
+            const bool probed = Registry::Probe(entry.file.path.c_str(), capabilities);
+            if (probed ? std::string(capabilities.name) != entry.reader : *entry.reader != 0)
+                return entry.file.path + " probed as " + (probed ? capabilities.name : "nothing");
+            ReaderPtr reader = open(entry.file);
+            if (static_cast<bool>(reader) != probed || (reader && reader->view().empty()))
+                return entry.file.path + (reader ? " read" : " not read");
+        }
+        return std::string();
+    }},
+    {"mnist_dataset", [] {
+        TempFile images("dataset-images-idx3-ubyte", mnistImages()), labels("dataset-labels-idx1-ubyte", mnistLabels());
+        MnistDataset dataset(images.path, labels.path);
+        if (!dataset.valid() || !dataset.hasLabels() || dataset.count() != mnistCount ||
+            dataset.width() != mnistWidth || dataset.height() != mnistHeight)
+            return std::string("dataset of ") + std::to_string(dataset.count()) + " images " +
+                   std::to_string(dataset.width()) + "x" + std::to_string(dataset.height());
+        for (size_t image = 0; image < mnistCount; ++image)
+        {
+            const ImageView view = dataset.image(image);
+            if (view.empty() || view.channels != 1 || view.stride != static_cast<std::ptrdiff_t>(mnistWidth))
+                return "view of image " + std::to_string(image);
+            for (size_t y = 0; y < mnistHeight; ++y)
+                for (size_t x = 0; x < mnistWidth; ++x)
+                    if (view.row(y)[x] != mnistPixel(image, y * mnistWidth + x))
+                        return "image " + std::to_string(image) + " pixel " + std::to_string(x) + "," + std::to_string(y);
+            if (dataset.label(image) != static_cast<int>(9 - image))
+                return "label of image " + std::to_string(image) + " is " + std::to_string(dataset.label(image));
+        }
+        if (!dataset.image(mnistCount).empty() || dataset.label(mnistCount) != -1)
+            return std::string("image past the end");
+        return std::string();
+    }},
+    {"mnist_malformed", [] {
+        TempFile images("malformed-images-idx3-ubyte", mnistImages()), truncated("truncated-images-idx3-ubyte", mnistImages(1));
+        TempFile labels("malformed-labels-idx1-ubyte", mnistLabels(mnistCount - 1));
+        if (MnistDataset(truncated.path).valid())
+            return std::string("truncated image file accepted");
+        if (MnistDataset(images.path, labels.path).valid())
+            return std::string("label file of a different count accepted");
+        if (MnistDataset(labels.path).valid())
+            return std::string("label file accepted as images");
+        if (!MnistDataset(images.path).valid() || MnistDataset(images.path).hasLabels())
+            return std::string("image file without labels not read");
+        return std::string();
+    }},
+    {"mnist_read_batch", [] {
+        TempFile images("batch-images-idx3-ubyte", mnistImages());
+        MnistDataset dataset(images.path);
+        std::vector<unsigned char> bytes(mnistCount * mnistImageSize, 0);
+        dataset.readBatch(1, 3, bytes.data());
+        std::string error = checkBatch<unsigned char>(bytes.data(), 1, 3, 1);
+        if (!error.empty())
+            return "u8 " + error;
+        std::vector<float> floats(mnistCount * mnistImageSize, 0);
+        dataset.readBatch(0, mnistCount, floats.data(), 0.5f);
+        error = checkBatch<float>(floats.data(), 0, mnistCount, 0.5f);
+        if (!error.empty())
+            return "fp32 " + error;
+
+        // Batches reaching past the last image throw instead of reading past the mapping
+        const size_t outside[][2] = {{4, 2}, {mnistCount + 1, 0}, {1, static_cast<size_t>(-1)}};
+        for (const auto& batch : outside)
+        {
+            try
+            {
+                dataset.readBatch(batch[0], batch[1], bytes.data());
+                return "batch of " + std::to_string(batch[1]) + " from " + std::to_string(batch[0]) + " read";
+            }
+            catch (const std::out_of_range&)
+            {
+            }
+        }
+        try
+        {
+            dataset.readBatch(mnistCount, 0, bytes.data());
+        }
+        catch (const std::out_of_range& e)
+        {
+            return std::string("empty batch at the end: ") + e.what();
+        }
+        return std::string();
+    }},
+    {"mnist_batch_iterator", [] {
+        TempFile images("iterator-images-idx3-ubyte", mnistImages());
+        MnistDataset dataset(images.path);
+        MnistBatchIterator batches(dataset, 2);
+        std::vector<unsigned char> batch(2 * mnistImageSize, 0);
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            const size_t expected[] = {2, 2, 1, 0};
+            size_t first = 0;
+            for (size_t count : expected)
+            {
+                const size_t copied = batches.next(batch.data());
+                if (copied != count)
+                    return "pass " + std::to_string(pass) + ": batch at " + std::to_string(first) + " copied " +
+                           std::to_string(copied) + " images";
+                if (count == 0)
+                    break;
+                const std::string error = checkBatch<unsigned char>(batch.data(), first, count, 1);
+                if (batches.first() != first || !error.empty())
+                    return "pass " + std::to_string(pass) + ": batch at " + std::to_string(batches.first()) + " " + error;
+                first += count;
+                if (batches.remaining() != mnistCount - first)
+                    return "pass " + std::to_string(pass) + ": " + std::to_string(batches.remaining()) + " images remaining";
+            }
+            batches.rewind();
+        }
+        return std::string();
+    }},
+};
+
+int main(int argc, char *argv[])
+{
+    return runChecks(argc, argv, "format_reader_check", cases);
+}
@@ -0,0 +1,344 @@
+/*
+ * Benchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <memory>
+#include <new>
+#include <opencv2/core/core.hpp>
+
+namespace
+{
+std::atomic<uint64_t> allocCount(0);
+std::atomic<uint64_t> allocBytes(0);
+
+void* countedAlloc(size_t size)
+{
+	allocCount.fetch_add(1, std::memory_order_relaxed);
+	allocBytes.fetch_add(size, std::memory_order_relaxed);
+	return malloc(size ? size : 1);
+}
+
+#if CV_VERSION_MAJOR < 4
+typedef int AccessFlag;
+#else
+typedef cv::AccessFlag AccessFlag;
+#endif
+
+/*
+ * cv::Mat buffers come from cv::fastMalloc, not operator new. Installed as the default
+ * allocator, this counts them and leaves the work to the standard allocator.
+ */
+class CountingMatAllocator : public cv::MatAllocator
+{
+public:
+	cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+		AccessFlag flags, cv::UMatUsageFlags usageFlags) const override
+	{
+		cv::UMatData* u = cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+		// A Mat over user data allocates nothing but its header
+		if (u && !data)
+		{
+			allocCount.fetch_add(1, std::memory_order_relaxed);
+			allocBytes.fetch_add(u->size, std::memory_order_relaxed);
+		}
+		return u;
+	}
+
+	bool allocate(cv::UMatData* data, AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override
+	{
+		return cv::Mat::getStdAllocator()->allocate(data, accessFlags, usageFlags);
+	}
+
+	void deallocate(cv::UMatData* data) const override
+	{
+		cv::Mat::getStdAllocator()->deallocate(data);
+	}
+};
+
+std::vector<std::unique_ptr<bench::Benchmark>>& registry()
+{
+	static std::vector<std::unique_ptr<bench::Benchmark>> benchmarks;
+	return benchmarks;
+}
+} // namespace
+
+void* operator new(size_t size)
+{
+	void* memory = countedAlloc(size);
+	if (!memory)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return countedAlloc(size);
+}
+
+// Not inlined into callers, GCC would pair the free() with their operator new and warn
+__attribute__((noinline)) void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void* memory) noexcept
+{
+	free(memory);
+}
+
+namespace bench
+{
+
+State::State(const std::vector<int64_t>& args, uint64_t maxIterations):
+	args(args),
+	maxIterations(maxIterations),
+	iterations(0),
+	running(false),
+	finished(false),
+	elapsedNs(0),
+	allocsAtResume(0),
+	bytesAtResume(0),
+	allocs(0),
+	bytes(0),
+	itemsProcessed(0)
+{
+}
+
+bool State::keepRunning()
+{
+	if (iterations == 0 && !running && !finished)
+		resumeTiming();
+
+	if (iterations < maxIterations)
+	{
+		++iterations;
+		return true;
+	}
+
+	pauseTiming();
+	finished = true;
+	return false;
+}
+
+void State::pauseTiming()
+{
+	if (!running)
+		return;
+	elapsedNs += std::chrono::duration<double, std::nano>(Clock::now() - resumedAt).count();
+	allocs += allocCount.load(std::memory_order_relaxed) - allocsAtResume;
+	bytes += allocBytes.load(std::memory_order_relaxed) - bytesAtResume;
+	running = false;
+}
+
+void State::resumeTiming()
+{
+	if (running)
+		return;
+	running = true;
+	allocsAtResume = allocCount.load(std::memory_order_relaxed);
+	bytesAtResume = allocBytes.load(std::memory_order_relaxed);
+	resumedAt = Clock::now();
+}
+
+int64_t State::range(size_t index) const
+{
+	return index < args.size() ? args[index] : 0;
+}
+
+void State::setItemsProcessed(int64_t items)
+{
+	itemsProcessed = items;
+}
+
+void State::setLabel(const std::string& text)
+{
+	label = text;
+}
+
+uint64_t State::getIterations() const
+{
+	return iterations;
+}
+
+double State::getElapsedNs() const
+{
+	return elapsedNs;
+}
+
+uint64_t State::getAllocs() const
+{
+	return allocs;
+}
+
+uint64_t State::getBytes() const
+{
+	return bytes;
+}
+
+int64_t State::getItemsProcessed() const
+{
+	return itemsProcessed;
+}
+
+const std::string& State::getLabel() const
+{
+	return label;
+}
+
+Benchmark::Benchmark(const std::string& name, Function function):
+	name(name),
+	function(function)
+{
+}
+
+Benchmark* Benchmark::args(const std::vector<int64_t>& values)
+{
+	argSets.push_back(values);
+	return this;
+}
+
+const std::string& Benchmark::getName() const
+{
+	return name;
+}
+
+Function Benchmark::getFunction() const
+{
+	return function;
+}
+
+const std::vector<std::vector<int64_t>>& Benchmark::getArgSets() const
+{
+	return argSets;
+}
+
+Benchmark* registerBenchmark(const char* name, Function function)
+{
+	registry().emplace_back(new Benchmark(name, function));
+	return registry().back().get();
+}
+
+static std::string fullName(const Benchmark& benchmark, const std::vector<int64_t>& args)
+{
+	std::string name = benchmark.getName();
+	for (int64_t arg : args)
+		name += "/" + std::to_string(arg);
+	return name;
+}
+
+static std::string jsonString(const std::string& text)
+{
+	std::string quoted = "\"";
+	for (char c : text)
+	{
+		if (c == '"' || c == '\\')
+			quoted += '\\';
+		quoted += c;
+	}
+	return quoted + "\"";
+}
+
+int runBenchmarks(const std::string& filter, double minTimeSec, bool json, std::ostream& out)
+{
+	const double minTimeNs = minTimeSec * 1e9;
+	const uint64_t iterationLimit = 1000000000;
+	int ran = 0;
+
+	static CountingMatAllocator matAllocator;
+	cv::MatAllocator* previousAllocator = cv::Mat::getDefaultAllocator();
+	cv::Mat::setDefaultAllocator(&matAllocator);
+
+	if (json)
+		out << "{" << std::endl << "  \"benchmarks\": [" << std::endl;
+	else
+		out << std::left << std::setw(44) << "Benchmark" << std::right
+		    << std::setw(16) << "Time/iter" << std::setw(12) << "Iterations"
+		    << std::setw(14) << "Allocs/iter" << std::setw(14) << "Bytes/iter"
+		    << std::setw(14) << "Items/s" << "  Label" << std::endl
+		    << std::string(128, '-') << std::endl;
+
+	for (auto& benchmark : registry())
+	{
+		std::vector<std::vector<int64_t>> argSets = benchmark->getArgSets();
+		if (argSets.empty())
+			argSets.push_back(std::vector<int64_t>());
+
+		for (auto& args : argSets)
+		{
+			const std::string name = fullName(*benchmark, args);
+			if (name.find(filter) == std::string::npos)
+				continue;
+
+			// Grow the iteration count until one run lasts minTimeSec
+			uint64_t iterations = 1;
+			while (true)
+			{
+				State state(args, iterations);
+				benchmark->getFunction()(state);
+
+				double elapsed = state.getElapsedNs();
+				if (elapsed < minTimeNs && iterations < iterationLimit && state.getIterations() == iterations)
+				{
+					double multiplier = elapsed > 0 ? minTimeNs * 1.4 / elapsed : 10;
+					iterations = std::min(iterationLimit,
+						(uint64_t)(iterations * std::max(2.0, std::min(10.0, multiplier))));
+					continue;
+				}
+
+				const double n = std::max<uint64_t>(1, state.getIterations());
+				const double nsPerIter = elapsed / n;
+				const double itemsPerSec = elapsed > 0 ? state.getItemsProcessed() * 1e9 / elapsed : 0;
+
+				if (json)
+				{
+					out << (ran ? ",\n" : "") << std::fixed << std::setprecision(3)
+					    << "    {\"name\": " << jsonString(name)
+					    << ", \"iterations\": " << state.getIterations()
+					    << ", \"ns_per_iter\": " << nsPerIter
+					    << ", \"allocs_per_iter\": " << state.getAllocs() / n
+					    << ", \"bytes_per_iter\": " << state.getBytes() / n
+					    << ", \"items_per_second\": " << itemsPerSec
+					    << ", \"label\": " << jsonString(state.getLabel()) << "}";
+				}
+				else
+				{
+					out << std::left << std::setw(44) << name << std::right << std::fixed
+					    << std::setprecision(0) << std::setw(13) << nsPerIter << " ns"
+					    << std::setw(12) << state.getIterations()
+					    << std::setprecision(1) << std::setw(14) << state.getAllocs() / n
+					    << std::setprecision(0) << std::setw(14) << state.getBytes() / n
+					    << std::setw(14) << itemsPerSec
+					    << "  " << state.getLabel() << std::endl;
+				}
+				++ran;
+				break;
+			}
+		}
+	}
+
+	if (json)
+		out << std::endl << "  ]" << std::endl << "}" << std::endl;
+
+	cv::Mat::setDefaultAllocator(previousAllocator);
+	return ran;
+}
+
+} // namespace bench
@@ -0,0 +1,106 @@
+/*
+ * Benchmark.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ *
+ * Minimal Google Benchmark style harness. Besides time per iteration it counts the heap
+ * allocations made inside the timed region, operator new is replaced and a counting
+ * cv::MatAllocator is installed for that.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+
+class State
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	std::vector<int64_t> args;
+	uint64_t maxIterations;
+	uint64_t iterations;
+	bool running;
+	bool finished;
+	Clock::time_point resumedAt;
+	double elapsedNs;
+	uint64_t allocsAtResume, bytesAtResume;
+	uint64_t allocs, bytes;
+	int64_t itemsProcessed;
+	std::string label;
+public:
+	State(const std::vector<int64_t>& args, uint64_t maxIterations);
+
+	/*
+	 * while (state.keepRunning()) { ...timed code... }
+	 */
+	bool keepRunning();
+
+	/*
+	 * Excludes setup done inside the loop from time and allocation counts
+	 */
+	void pauseTiming();
+	void resumeTiming();
+
+	int64_t range(size_t index) const;
+	void setItemsProcessed(int64_t items);
+	void setLabel(const std::string& text);
+
+	uint64_t getIterations() const;
+	double getElapsedNs() const;
+	uint64_t getAllocs() const;
+	uint64_t getBytes() const;
+	int64_t getItemsProcessed() const;
+	const std::string& getLabel() const;
+};
+
+typedef void (*Function)(State&);
+
+class Benchmark
+{
+private:
+	std::string name;
+	Function function;
+	std::vector<std::vector<int64_t>> argSets;
+public:
+	Benchmark(const std::string& name, Function function);
+
+	Benchmark* args(const std::vector<int64_t>& values);
+
+	const std::string& getName() const;
+	Function getFunction() const;
+	const std::vector<std::vector<int64_t>>& getArgSets() const;
+};
+
+Benchmark* registerBenchmark(const char* name, Function function);
+
+/*
+ * Runs the benchmarks whose "name/arg/arg" contains filter, each one long enough to
+ * take minTimeSec, and prints the results as a table or as JSON
+ */
+int runBenchmarks(const std::string& filter, double minTimeSec, bool json, std::ostream& out);
+
+/*
+ * Keeps the compiler from optimizing away a computed value
+ */
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} // namespace bench
+
+#define BENCHMARK_CONCAT(a, b) a##b
+#define BENCHMARK_NAME(line) BENCHMARK_CONCAT(benchmark_, line)
+#define BENCHMARK(function) \
+	static bench::Benchmark* BENCHMARK_NAME(__LINE__) __attribute__((unused)) = \
+		bench::registerBenchmark(#function, function)
@@ -0,0 +1,42 @@
+/*
+ * lane_bench.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <gflags/gflags.h>
+#include <iostream>
+
+/// @brief message for help argument
+static const char help_message[] = "Print a usage message.";
+
+/// @brief message for the benchmark filter
+static const char filter_message[] = "Optional. Run only benchmarks whose name/args contain this text.";
+
+/// @brief message for the minimum time
+static const char min_time_message[] = "Optional. Minimum seconds each benchmark runs for.";
+
+/// @brief message for the output format
+static const char format_message[] = "Optional. Output format, \"console\" or \"json\".";
+
+DEFINE_bool(h, false, help_message);
+DEFINE_string(filter, "", filter_message);
+DEFINE_double(min_time, 0.5, min_time_message);
+DEFINE_string(format, "console", format_message);
+
+/**
+* @brief This function show a help message
+*/
+static void showUsage() {
+    std::cout << std::endl;
+    std::cout << "lane_bench [OPTION]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << std::endl;
+    std::cout << "    -h                        " << help_message << std::endl;
+    std::cout << "    -filter \"<text>\"          " << filter_message << std::endl;
+    std::cout << "    -min_time                 " << min_time_message << std::endl;
+    std::cout << "    -format \"<format>\"        " << format_message << std::endl;
+}
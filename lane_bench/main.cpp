@@ -0,0 +1,229 @@
+/*
+ * main.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ *
+ * Microbenchmarks of the lane detection kernels on synthetic roads and point clouds.
+ * Image benchmarks take {width, height}, RANSAC takes {points, outlier %}.
+ */
+#include <random>
+#include <samples/slog.hpp>
+#include "lane_bench.hpp"
+#include "include/Benchmark.h"
+#include "include/Benchmark.cpp"
+#include "../autopilot/include/SyntheticRoad.h"
+#include "../autopilot/include/SyntheticRoad.cpp"
+#include "../autopilot/include/LaneDetector.hpp"
+#include "../autopilot/include/LaneDetector.cpp"
+
+static cv::Mat road(bench::State& state)
+{
+    RoadParams params;
+    params.width = state.range(0);
+    params.height = state.range(1);
+    params.curvature = 0.1f;
+    params.noise = 8;
+    return renderRoad(params);
+}
+
+// What calcHistogram and calcLanePoints see: the thresholded bird's eye view
+static cv::Mat birdsEye(LaneDetector& laneDetector, const cv::Mat& image)
+{
+    cv::Mat warped = image.clone();
+    laneDetector.transformPerspective(warped);
+    laneDetector.convertToGrayscale(warped);
+    return warped;
+}
+
+static void BM_ConvertToGrayscale(bench::State& state)
+{
+    cv::Mat image = road(state), work;
+    LaneDetector laneDetector(1, image.cols, image.rows);
+    while (state.keepRunning())
+    {
+        state.pauseTiming();
+        image.copyTo(work);
+        state.resumeTiming();
+        laneDetector.convertToGrayscale(work);
+    }
+    state.setItemsProcessed(state.getIterations() * image.total());
+}
+BENCHMARK(BM_ConvertToGrayscale)->args({320, 240})->args({640, 480})->args({1280, 720});
+
+static void BM_TransformPerspective(bench::State& state)
+{
+    cv::Mat image = road(state), work;
+    LaneDetector laneDetector(1, image.cols, image.rows);
+    while (state.keepRunning())
+    {
+        state.pauseTiming();
+        image.copyTo(work);
+        state.resumeTiming();
+        laneDetector.transformPerspective(work);
+    }
+    state.setItemsProcessed(state.getIterations() * image.total());
+}
+BENCHMARK(BM_TransformPerspective)->args({320, 240})->args({640, 480})->args({1280, 720});
+
+static void BM_CalcHistogram(bench::State& state)
+{
+    cv::Mat image = road(state);
+    LaneDetector laneDetector(1, image.cols, image.rows);
+    cv::Mat binary = birdsEye(laneDetector, image);
+    while (state.keepRunning())
+        bench::doNotOptimize(laneDetector.calcHistogram(binary));
+    state.setItemsProcessed(state.getIterations() * binary.total());
+}
+BENCHMARK(BM_CalcHistogram)->args({320, 240})->args({640, 480})->args({1280, 720});
+
+static void BM_CalcLanePoints(bench::State& state)
+{
+    cv::Mat image = road(state);
+    LaneDetector laneDetector(1, image.cols, image.rows);
+    cv::Mat binary = birdsEye(laneDetector, image);
+    size_t points = 0;
+    while (state.keepRunning())
+        points = laneDetector.calcLanePoints(binary)[0].size();
+    state.setLabel("left inliers " + std::to_string(points));
+}
+BENCHMARK(BM_CalcLanePoints)->args({320, 240})->args({640, 480})->args({1280, 720});
+
+static void BM_FitLanePoints(bench::State& state)
+{
+    cv::Mat image = road(state);
+    LaneDetector laneDetector(1, image.cols, image.rows);
+    cv::Mat binary = birdsEye(laneDetector, image);
+    std::vector<std::vector<uint16_t>> points = laneDetector.calcLanePoints(binary);
+    for (auto& coordinates : points)
+    {
+        if (coordinates.size() < 3)
+        {
+            state.setLabel("skipped, no lane found");
+            return;
+        }
+    }
+    while (state.keepRunning())
+        bench::doNotOptimize(laneDetector.fitLanePoints(points, binary));
+}
+BENCHMARK(BM_FitLanePoints)->args({320, 240})->args({640, 480})->args({1280, 720});
+
+static void BM_CalcSteeringAngle(bench::State& state)
+{
+    cv::Mat image = road(state);
+    LaneDetector laneDetector(1, image.cols, image.rows);
+    cv::Mat binary = birdsEye(laneDetector, image);
+    std::vector<std::vector<uint16_t>> points = laneDetector.calcLanePoints(binary);
+    for (auto& coordinates : points)
+    {
+        if (coordinates.size() < 3)
+        {
+            state.setLabel("skipped, no lane found");
+            return;
+        }
+    }
+    if (!laneDetector.fitLanePoints(points, binary))
+    {
+        state.setLabel("skipped, fit failed");
+        return;
+    }
+    while (state.keepRunning())
+        laneDetector.calcSteeringAngle(image, true, false);
+    state.setLabel("angle " + std::to_string(laneDetector.getSteeringAngle()));
+}
+BENCHMARK(BM_CalcSteeringAngle)->args({320, 240})->args({640, 480})->args({1280, 720});
+
+static void BM_RunCurvePipeline(bench::State& state)
+{
+    cv::Mat image = road(state);
+    LaneDetector laneDetector(1, image.cols, image.rows);
+    while (state.keepRunning())
+        bench::doNotOptimize(laneDetector.runCurvePipeline(image));
+    state.setItemsProcessed(state.getIterations());
+}
+BENCHMARK(BM_RunCurvePipeline)->args({320, 240})->args({640, 480})->args({1280, 720});
+
+// Points on y = 0.5x + 10 with unit noise, outliers spread over the whole frame
+static void linePoints(size_t count, int outlierPercent, std::vector<float>& x, std::vector<float>& y)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> uniformX(0, 640), uniformY(0, 480), percent(0, 100);
+    std::normal_distribution<float> noise(0, 1);
+    x.clear();
+    y.clear();
+    for (size_t i = 0; i < count; ++i)
+    {
+        float px = uniformX(rng);
+        x.push_back(px);
+        y.push_back(percent(rng) < outlierPercent ? uniformY(rng) : 0.5f * px + 10 + noise(rng));
+    }
+}
+
+static void BM_Polyfit(bench::State& state)
+{
+    std::vector<float> x, y;
+    linePoints(state.range(0), 0, x, y);
+    const int degree = state.range(1);
+    while (state.keepRunning())
+        bench::doNotOptimize(polyfit(x, y, degree));
+    state.setItemsProcessed(state.getIterations() * x.size());
+}
+BENCHMARK(BM_Polyfit)->args({10, 1})->args({10, 2})->args({100, 2})->args({1000, 2});
+
+static void BM_Polyval(bench::State& state)
+{
+    std::vector<float> x, y;
+    linePoints(state.range(0), 0, x, y);
+    std::vector<float> coefficients = polyfit(x, y, 2);
+    while (state.keepRunning())
+        bench::doNotOptimize(polyval(coefficients, x));
+    state.setItemsProcessed(state.getIterations() * x.size());
+}
+BENCHMARK(BM_Polyval)->args({100})->args({1000});
+
+static void BM_RansacEstimate(bench::State& state)
+{
+    std::vector<float> x, y;
+    linePoints(state.range(0), state.range(1), x, y);
+    std::vector<std::shared_ptr<GRANSAC::AbstractParameter>> points;
+    for (size_t i = 0; i < x.size(); ++i)
+        points.push_back(std::make_shared<Point2D>(x[i], y[i]));
+
+    LaneParams params;
+    static GRANSAC::RANSAC<Line2DModel, 2> ransac;
+    ransac.Initialize(3, params.maxIterations);
+    size_t inliers = 0;
+    while (state.keepRunning())
+    {
+        ransac.Estimate(points);
+        inliers = ransac.GetBestInliers().size();
+    }
+    state.setItemsProcessed(state.getIterations() * points.size());
+    state.setLabel("inliers " + std::to_string(inliers));
+}
+BENCHMARK(BM_RansacEstimate)->args({10, 0})->args({10, 30})->args({100, 0})->args({100, 30})
+    ->args({100, 60})->args({1000, 30});
+
+int main(int argc, char *argv[])
+{
+    gflags::ParseCommandLineNonHelpFlags(&argc, &argv, true);
+    if (FLAGS_h) {
+        showUsage();
+        return 0;
+    }
+    if (FLAGS_format != "console" && FLAGS_format != "json") {
+        slog::err << "Parameter -format should be console or json" << slog::endl;
+        slog::flush();
+        return 1;
+    }
+
+    // Results own stdout, whatever the kernels print goes to stderr
+    std::ostream results(std::cout.rdbuf());
+    std::cout.rdbuf(std::cerr.rdbuf());
+
+    int ran = bench::runBenchmarks(FLAGS_filter, FLAGS_min_time, FLAGS_format == "json", results);
+    if (ran == 0)
+        slog::warn << "No benchmark matches \"" << FLAGS_filter << "\"" << slog::endl;
+    slog::flush();
+    return 0;
+}
@@ -0,0 +1,47 @@
+/*
+ * lane_check.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <gflags/gflags.h>
+#include <iostream>
+
+/// @brief message for help argument
+static const char help_message[] = "Print a usage message.";
+
+/// @brief message for the case filter
+static const char filter_message[] = "Optional. Run only cases whose name contains this text.";
+
+/// @brief message for the steering tolerance
+static const char steer_tolerance_message[] = "Optional. Largest accepted steering angle error in degrees.";
+
+/// @brief message for the lane center tolerance
+static const char center_tolerance_message[] = "Optional. Largest accepted lane center error, fraction of the frame width.";
+
+/// @brief message for the dump directory
+static const char dump_message[] = "Optional. Directory where the input frames of failed cases are written.";
+
+DEFINE_bool(h, false, help_message);
+DEFINE_string(filter, "", filter_message);
+DEFINE_double(steer_tolerance, 2.0, steer_tolerance_message);
+DEFINE_double(center_tolerance, 0.03, center_tolerance_message);
+DEFINE_string(dump, "", dump_message);
+
+/**
+* @brief This function show a help message
+*/
+static void showUsage() {
+    std::cout << std::endl;
+    std::cout << "lane_check [OPTION]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << std::endl;
+    std::cout << "    -h                        " << help_message << std::endl;
+    std::cout << "    -filter \"<text>\"          " << filter_message << std::endl;
+    std::cout << "    -steer_tolerance          " << steer_tolerance_message << std::endl;
+    std::cout << "    -center_tolerance         " << center_tolerance_message << std::endl;
+    std::cout << "    -dump \"<path>\"            " << dump_message << std::endl;
+}
@@ -0,0 +1,190 @@
+/*
+ * main.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ *
+ * Golden output check of the lane detector: renders synthetic roads whose lane center is
+ * known, runs runLightCurvePipeline on them and compares the fitted lane center and the
+ * steering angle against the ground truth. Exits with 1 if any case is off by more than
+ * the tolerances, so lane kernel optimizations can be checked before they are merged.
+ */
+#include <cmath>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <opencv2/imgcodecs/imgcodecs.hpp>
+#include <samples/slog.hpp>
+#include "lane_check.hpp"
+#include "../autopilot/include/SyntheticRoad.h"
+#include "../autopilot/include/SyntheticRoad.cpp"
+#include "../autopilot/include/LaneDetector.hpp"
+#include "../autopilot/include/LaneDetector.cpp"
+
+struct Case
+{
+    std::string name;
+    RoadParams road;
+    float resize;
+    int frames;              // the road is rendered again for every frame, the detector keeps its state
+    float curvatureStep;     // added to road.curvature after every frame
+};
+
+struct FrameResult
+{
+    bool lanesFound;
+    float steerError;        // degrees
+    float centerError;       // largest lane center error between the steering rows, fraction of the width
+};
+
+static std::vector<Case> cases;
+
+static RoadParams& add(const std::string& name, float resize = 1, int frames = 3, float curvatureStep = 0)
+{
+    cases.push_back(Case{name, RoadParams(), resize, frames, curvatureStep});
+    return cases.back().road;
+}
+
+static void addGoldenCases()
+{
+    add("straight");
+    add("offset_left").offset = -0.05f;
+    add("offset_right").offset = 0.05f;
+    add("curve_left").curvature = -0.15f;
+    add("curve_right").curvature = 0.15f;
+    RoadParams& curveOffset = add("curve_offset");
+    curveOffset.curvature = 0.1f;
+    curveOffset.offset = -0.04f;
+    RoadParams& noisy = add("noisy");
+    noisy.curvature = 0.1f;
+    noisy.noise = 25;
+    add("dashed").dashLength = 0.08f;
+    RoadParams& occluded = add("occluded");
+    occluded.curvature = -0.1f;
+    occluded.occlusions = 3;
+    occluded.seed = 7;
+    RoadParams& worst = add("dashed_occluded_noisy");
+    worst.curvature = 0.1f;
+    worst.dashLength = 0.08f;
+    worst.occlusions = 2;
+    worst.noise = 20;
+    worst.seed = 3;
+    RoadParams& small = add("qvga");
+    small.width = 320;
+    small.height = 240;
+    small.curvature = 0.1f;
+    RoadParams& hd = add("hd");
+    hd.width = 1280;
+    hd.height = 720;
+    hd.curvature = -0.1f;
+    add("resized", 0.5f).curvature = 0.1f;
+    add("sweep", 1, 21, 0.02f).curvature = -0.2f;
+}
+
+/*
+ * Ground truth lane center in the bird's eye view of a w x h frame. The view stretches the
+ * rows from h / quadRatio down to the bottom over the whole frame and keeps the columns.
+ */
+static float truthCenter(const RoadParams& road, float resize, const LaneParams& lanes, float birdsEyeRow)
+{
+    const float h = (uint16_t)(road.height * resize);
+    const float top = h / lanes.quadRatio;
+    const float cameraRow = top + birdsEyeRow * (h - 1 - top) / (h - 1);
+    return roadCenterAt(road, cameraRow / resize) * resize;
+}
+
+/*
+ * calcSteeringAngle(centerCompensation = true) applied to a lane center
+ */
+template <typename Center>
+static float steeringAngle(uint16_t width, uint16_t height, Center center)
+{
+    const int16_t baseRow = height / 1.05, targetRow = height / 3;
+    const float base = center(baseRow), target = center(targetRow);
+    const float alpha = std::atan((target - base) / (baseRow - targetRow));
+    const float beta = std::atan((base - width / 2) / (baseRow - targetRow));
+    return (alpha + beta) * 180 / std::acos(-1);
+}
+
+static FrameResult checkFrame(LaneDetector& laneDetector, const Case& testCase, const RoadParams& road,
+                              const LaneParams& lanes, const cv::Mat& image)
+{
+    cv::Mat input = image.clone();
+    laneDetector.runLightCurvePipeline(input);
+
+    FrameResult result{laneDetector.lanesFound(), 0, 0};
+    if (!result.lanesFound)
+        return result;
+
+    const uint16_t width = road.width * testCase.resize, height = road.height * testCase.resize;
+    const std::vector<float>& center = laneDetector.getLaneCenter();
+    auto truth = [&](int row) { return truthCenter(road, testCase.resize, lanes, row); };
+
+    result.steerError = laneDetector.getSteeringAngle() - steeringAngle(width, height, truth);
+    for (int row = height / 3; row <= (int)(height / 1.05) && row < (int)center.size(); ++row)
+        result.centerError = std::max(result.centerError, std::fabs(center[row] - truth(row)) / width);
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    gflags::ParseCommandLineNonHelpFlags(&argc, &argv, true);
+    if (FLAGS_h) {
+        showUsage();
+        return 0;
+    }
+
+    // Results own stdout, whatever the kernels print goes to stderr
+    std::ostream results(std::cout.rdbuf());
+    std::cout.rdbuf(std::cerr.rdbuf());
+
+    results << std::left << std::setw(24) << "case" << std::right << std::setw(8) << "frames"
+            << std::setw(14) << "steer err" << std::setw(14) << "center err" << "  result" << std::endl;
+
+    LaneParams lanes;
+    // Same RANSAC samples on every run
+    lanes.seed = 1;
+    int ran = 0, failed = 0;
+    addGoldenCases();
+    for (const Case& testCase : cases)
+    {
+        if (testCase.name.find(FLAGS_filter) == std::string::npos)
+            continue;
+        ++ran;
+
+        LaneDetector laneDetector(testCase.resize, testCase.road.width, testCase.road.height, lanes);
+        RoadParams road = testCase.road;
+        float worstSteer = 0, worstCenter = 0;
+        bool passed = true;
+        for (int frame = 0; frame < testCase.frames; ++frame, road.curvature += testCase.curvatureStep)
+        {
+            cv::Mat image = renderRoad(road);
+            FrameResult result = checkFrame(laneDetector, testCase, road, lanes, image);
+            worstSteer = std::max(worstSteer, std::fabs(result.steerError));
+            worstCenter = std::max(worstCenter, result.centerError);
+
+            bool framePassed = result.lanesFound && std::fabs(result.steerError) <= FLAGS_steer_tolerance &&
+                               result.centerError <= FLAGS_center_tolerance;
+            if (framePassed)
+                continue;
+            passed = false;
+            if (!result.lanesFound)
+                slog::warn << testCase.name << " frame " << frame << ": no lanes found" << slog::endl;
+            if (!FLAGS_dump.empty())
+                cv::imwrite(FLAGS_dump + "/" + testCase.name + "_" + std::to_string(frame) + ".png", image);
+        }
+        if (!passed)
+            ++failed;
+
+        results << std::left << std::setw(24) << testCase.name << std::right << std::setw(8) << testCase.frames
+                << std::fixed << std::setprecision(2) << std::setw(12) << worstSteer << " deg"
+                << std::setw(12) << worstCenter * 100 << " %" << (passed ? "  PASS" : "  FAIL") << std::endl;
+    }
+
+    if (ran == 0)
+        slog::warn << "No case matches \"" << FLAGS_filter << "\"" << slog::endl;
+    else
+        slog::info << ran - failed << " of " << ran << " cases passed" << slog::endl;
+    slog::flush();
+    return ran != 0 && failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+/*
+ * main.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ *
+ * Check of the motion gate, alone and in front of the stage scheduler the way a detector
+ * thread uses them: a frame becomes the reference only when it was inferred, so a change
+ * the scheduler or a failed inference skipped is inferred on a following frame instead of
+ * after the refresh. Exits with 1 if any case fails.
+ */
+#include <functional>
+#include <string>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <samples/check_runner.hpp>
+#include <samples/slog.hpp>
+#include "../autopilot/include/MotionGate.h"
+#include "../autopilot/include/MotionGate.cpp"
+#include "../autopilot/include/StageScheduler.h"
+#include "../autopilot/include/StageScheduler.cpp"
+
+/*
+ * Thumbnail of a gray road, with a pedestrian standing in it when person is set
+ */
+static cv::Mat scene(bool person, int brightness = 100)
+{
+    cv::Mat thumbnail(24, 32, CV_8UC1, cv::Scalar(brightness));
+    if (person)
+        for (int y = 8; y < 22; ++y)
+            for (int x = 14; x < 20; ++x)
+                thumbnail.at<uint8_t>(y, x) = 220;
+    return thumbnail;
+}
+
+static MotionGateParams gateParams()
+{
+    MotionGateParams params;
+    params.threshold = 2;
+    params.refreshFrames = 30;
+    return params;
+}
+
+/*
+ * A detector with the motion gate and the scheduler enabled, the order of runDetector: the
+ * gate is asked, then the scheduler, and the frame is committed once it was inferred
+ */
+struct Detector
+{
+    MotionGate gate;
+    StageScheduler& scheduler;
+    int stage;
+    bool inferenceFails;
+    std::vector<uint64_t> inferred;
+
+    Detector(StageScheduler& scheduler, int stage):
+        gate(gateParams()),
+        scheduler(scheduler),
+        stage(stage),
+        inferenceFails(false)
+    {
+    }
+
+    void frame(uint64_t frameId, const cv::Mat& thumbnail)
+    {
+        if (!gate.changed(thumbnail, frameId) || !scheduler.admit(stage) || inferenceFails)
+            return;
+        gate.commit(thumbnail, frameId);
+        inferred.push_back(frameId);
+    }
+};
+
+static std::string describe(const std::vector<uint64_t>& frameIds)
+{
+    std::string text = "inferred frames";
+    for (uint64_t frameId : frameIds)
+        text += " " + std::to_string(frameId);
+    return text;
+}
+
+/*
+ * Scheduler where cars run on 1 in decimation frames, lanes running over their deadline
+ * decimated them
+ */
+static int decimatedCars(StageScheduler& scheduler, int decimation)
+{
+    const int lanes = scheduler.addStage(StageConfig("lanes", 0, 10));
+    const int cars = scheduler.addStage(StageConfig("cars", 1, 10));
+    for (int i = 1; i < decimation; ++i)
+        scheduler.finish(lanes, 50);
+    return cars;
+}
+
+static std::vector<CheckCase> cases = {
+    {"first_frame", [] {
+        MotionGate gate(gateParams());
+        if (!gate.changed(scene(false), 1) || gate.score(scene(false)) != 255)
+            return std::string("a gate without a reference skips");
+        return std::string();
+    }},
+    {"static_scene", [] {
+        MotionGate gate(gateParams());
+        gate.commit(scene(false), 1);
+        if (gate.changed(scene(false, 101), 2))
+            return "a change of " + std::to_string(gate.score(scene(false, 101))) + " gray levels counts";
+        if (!gate.changed(scene(false, 102), 2))
+            return "a change of " + std::to_string(gate.score(scene(false, 102))) + " gray levels is ignored";
+        for (uint64_t frameId = 2; frameId <= 31; ++frameId)
+            if (gate.changed(scene(false), frameId) != (frameId == 31))
+                return "refresh at frame " + std::to_string(frameId);
+        return std::string();
+    }},
+    {"uncommitted_change", [] {
+        // Asking again gives the same answer until the frame is committed
+        MotionGate gate(gateParams());
+        gate.commit(scene(false), 1);
+        if (!gate.changed(scene(true), 2) || !gate.changed(scene(true), 3))
+            return std::string("the change is gone before the commit");
+        gate.commit(scene(true), 3);
+        if (gate.changed(scene(true), 4))
+            return std::string("the committed frame still counts as a change");
+        return std::string();
+    }},
+    {"scheduler_skips_change", [] {
+        // Cars run on 1 in 3 frames, the pedestrian steps in on frame 11 and stands still
+        StageScheduler scheduler(std::chrono::milliseconds(0));
+        Detector detector(scheduler, decimatedCars(scheduler, 3));
+        if (scheduler.getDecimation(detector.stage) != 3)
+            return "decimation " + std::to_string(scheduler.getDecimation(detector.stage));
+        for (uint64_t frameId = 1; frameId <= 40; ++frameId)
+            detector.frame(frameId, scene(frameId >= 11));
+        if (detector.inferred != std::vector<uint64_t>{3, 13})
+            return describe(detector.inferred);
+        return std::string();
+    }},
+    {"failed_inference", [] {
+        StageScheduler scheduler(std::chrono::milliseconds(0));
+        Detector detector(scheduler, decimatedCars(scheduler, 1));
+        for (uint64_t frameId = 1; frameId <= 20; ++frameId)
+        {
+            detector.inferenceFails = frameId == 11;
+            detector.frame(frameId, scene(frameId >= 11));
+        }
+        if (detector.inferred != std::vector<uint64_t>{1, 12})
+            return describe(detector.inferred);
+        return std::string();
+    }},
+};
+
+int main(int argc, char *argv[])
+{
+    return runChecks(argc, argv, "motion_gate_check", cases);
+}
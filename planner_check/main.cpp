@@ -0,0 +1,131 @@
+/*
+ * main.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ *
+ * Check of the behaviour planner: the lane steering angle mapped to the servo and saturated
+ * to [STEER_MIN, STEER_MAX], a lost lane keeping the last steering command, the Debounce
+ * hysteresis and a pedestrian ahead stopping the car through it. Exits with 1 if any case
+ * fails.
+ */
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+#include <samples/check_runner.hpp>
+#include <samples/slog.hpp>
+#include "../autopilot/include/VehicleProtocol.h"
+#include "../autopilot/include/VehicleProtocol.cpp"
+#include "../autopilot/include/Detection.h"
+#include "../autopilot/include/Detection.cpp"
+#include "../autopilot/include/WorldModel.h"
+#include "../autopilot/include/WorldModel.cpp"
+#include "../autopilot/include/BehaviourPlanner.h"
+#include "../autopilot/include/BehaviourPlanner.cpp"
+
+static const size_t frameWidth = 640, frameHeight = 480;
+
+static WorldSnapshot laneAt(float steeringAngle, bool valid = true)
+{
+    WorldSnapshot world;
+    world.lane.steeringAngle = steeringAngle;
+    world.lane.valid = valid;
+    return world;
+}
+
+/*
+ * Steering value the planner sends for an angle, -1 when it keeps the last command
+ */
+static int steerFor(float steeringAngle, bool valid = true)
+{
+    BehaviourPlanner planner(PlannerParams(), frameWidth, frameHeight);
+    const PlannerDecision decision = planner.step(laneAt(steeringAngle, valid));
+    return decision.steerValid ? decision.steer : -1;
+}
+
+/*
+ * Feeds the observations and returns the debounced state after each, as a string of 0 and 1
+ */
+static std::string debounce(int onFrames, int offFrames, const std::string& observed)
+{
+    Debounce filter(onFrames, offFrames);
+    std::string states;
+    for (char hit : observed)
+        states += filter.update(hit == '1') ? '1' : '0';
+    return states;
+}
+
+static std::vector<CheckCase> cases = {
+    {"steer_neutral", [] {
+        const float angles[] = {0, 10.7f, -10.2f, 49.5f, -49.5f};
+        const int expected[] = {STEER_NEUTRAL, 60, 39, 99, 0};
+        for (size_t i = 0; i < 5; ++i)
+            if (steerFor(angles[i]) != expected[i])
+                return "angle " + std::to_string(angles[i]) + " steers " + std::to_string(steerFor(angles[i]));
+        return std::string();
+    }},
+    {"steer_saturation", [] {
+        // Past +77 degrees the unclamped value wrapped to negative, below -50 it went negative
+        const float angles[] = {50, 77.5f, 78, 120, 180, -50.5f, -51, -120, -180};
+        const int expected[] = {STEER_MAX, STEER_MAX, STEER_MAX, STEER_MAX, STEER_MAX,
+                                STEER_MIN, STEER_MIN, STEER_MIN, STEER_MIN};
+        for (size_t i = 0; i < 9; ++i)
+            if (steerFor(angles[i]) != expected[i])
+                return "angle " + std::to_string(angles[i]) + " steers " + std::to_string(steerFor(angles[i]));
+        return std::string();
+    }},
+    {"steer_invalid", [] {
+        if (steerFor(30, false) != -1)
+            return std::string("a lost lane steers");
+        if (steerFor(std::numeric_limits<float>::quiet_NaN()) != -1 ||
+            steerFor(std::numeric_limits<float>::infinity()) != -1)
+            return std::string("a non finite angle steers");
+        return std::string();
+    }},
+    {"debounce_on", [] {
+        // Three consecutive hits, a miss in between starts the count again
+        const std::string states = debounce(3, 5, "1101110111");
+        if (states != "0000011111")
+            return "states " + states;
+        return std::string();
+    }},
+    {"debounce_off", [] {
+        // Five consecutive misses, a hit in between starts the count again
+        const std::string states = debounce(3, 5, "111" "0000100000" "0");
+        if (states != "001" "1111111110" "0")
+            return "states " + states;
+        return std::string();
+    }},
+    {"pedestrian_stop", [] {
+        // A pedestrian in the corridor, a third of the frame tall
+        PlannerParams params;
+        BehaviourPlanner planner(params, frameWidth, frameHeight);
+        WorldSnapshot world = laneAt(0);
+        world.detections[(size_t)DetectorId::Cars].objects = {
+            Detection{15, ObjectClass::Pedestrian, 0.9f, 300, 200, 340, 360, 0}};
+        for (int frame = 1; frame <= params.onFrames; ++frame)
+        {
+            const PlannerDecision decision = planner.step(world);
+            const bool stopped = decision.state == DriveState::Stop;
+            if (stopped != (frame == params.onFrames) || (decision.speed == 0) != stopped || decision.stopOn != stopped)
+                return "frame " + std::to_string(frame) + ": " + driveStateName(decision.state) +
+                       " at " + std::to_string(decision.speed);
+        }
+
+        world.detections[(size_t)DetectorId::Cars].objects.clear();
+        for (int frame = 1; frame <= params.offFrames; ++frame)
+        {
+            const PlannerDecision decision = planner.step(world);
+            const bool stopped = decision.state == DriveState::Stop;
+            if (stopped != (frame < params.offFrames))
+                return "gone for " + std::to_string(frame) + " frames: " + driveStateName(decision.state);
+        }
+        return std::string();
+    }},
+};
+
+int main(int argc, char *argv[])
+{
+    return runChecks(argc, argv, "planner_check", cases);
+}
@@ -0,0 +1,211 @@
+/*
+ * main.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ *
+ * Check of the vehicle wire protocol: the 6 byte frame the Arduino slave expects, its markers,
+ * the speed byte order and sign, the flag bits, and the rejection of truncated frames and
+ * frames with a wrong marker. The frame carries no CRC, the markers are the only framing
+ * check the slave can make. Exits with 1 if any case fails.
+ */
+#include <cstdio>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <samples/slog.hpp>
+#include "protocol_check.hpp"
+#include "../autopilot/include/VehicleProtocol.h"
+#include "../autopilot/include/VehicleProtocol.cpp"
+#include "../autopilot/include/ActuatorLoop.h"
+#include "../autopilot/include/ActuatorLoop.cpp"
+#include "../autopilot/include/VehicleLink.h"
+#include "../autopilot/include/VehicleLink.cpp"
+
+static VehicleCommand command(int16_t speed, int8_t steer, bool lightsOn, bool stopOn)
+{
+    VehicleCommand result;
+    result.speed = speed;
+    result.steer = steer;
+    result.lightsOn = lightsOn;
+    result.stopOn = stopOn;
+    return result;
+}
+
+static bool operator==(const VehicleCommand& l, const VehicleCommand& r)
+{
+    return l.speed == r.speed && l.steer == r.steer && l.lightsOn == r.lightsOn && l.stopOn == r.stopOn;
+}
+
+static std::string describe(const VehicleCommand& command)
+{
+    std::ostringstream text;
+    text << "{speed " << command.speed << ", steer " << (int)command.steer << ", lights " << command.lightsOn
+         << ", stop " << command.stopOn << "}";
+    return text.str();
+}
+
+static std::string bytes(const uint8_t* frame, size_t size)
+{
+    std::ostringstream text;
+    text << std::hex << std::setfill('0');
+    for (size_t i = 0; i < size; ++i)
+        text << (i == 0 ? "" : " ") << std::setw(2) << (int)frame[i];
+    return text.str();
+}
+
+static std::string expectFrame(const VehicleCommand& command, const std::vector<uint8_t>& expected)
+{
+    uint8_t frame[VehicleProtocol::frameSize];
+    VehicleProtocol::encode(command, frame);
+    if (std::vector<uint8_t>(frame, frame + sizeof(frame)) != expected)
+        return describe(command) + " encoded as " + bytes(frame, sizeof(frame)) + ", expected " +
+               bytes(expected.data(), expected.size());
+    return "";
+}
+
+static const std::vector<VehicleCommand> commands = {
+    command(0, STEER_NEUTRAL, false, false),
+    command(1, 0, true, false),
+    command(-1, 100, false, true),
+    command(255, 49, true, true),
+    command(256, 51, false, false),
+    command(-256, -1, true, false),
+    command(32767, 127, false, true),
+    command(-32768, -128, true, true),
+};
+
+static std::vector<CheckCase> cases = {
+    {"frame_size", [] {
+        return VehicleProtocol::frameSize == 6 ? "" : "frame is " + std::to_string(VehicleProtocol::frameSize) + " bytes";
+    }},
+    {"default_neutral", [] {
+        return expectFrame(VehicleCommand(), {SPEED_VALUE_FLAG, 0x00, 0x00, DIR_VALUE_FLAG, 50, 0x00});
+    }},
+    {"speed_big_endian", [] {
+        return expectFrame(command(0x1234, 50, false, false), {SPEED_VALUE_FLAG, 0x12, 0x34, DIR_VALUE_FLAG, 50, 0x00});
+    }},
+    {"speed_sign", [] {
+        std::string error = expectFrame(command(-1, 50, false, false), {SPEED_VALUE_FLAG, 0xFF, 0xFF, DIR_VALUE_FLAG, 50, 0x00});
+        if (error.empty())
+            error = expectFrame(command(-32768, 50, false, false), {SPEED_VALUE_FLAG, 0x80, 0x00, DIR_VALUE_FLAG, 50, 0x00});
+        return error;
+    }},
+    {"flags", [] {
+        std::string error = expectFrame(command(0, 50, true, false), {SPEED_VALUE_FLAG, 0, 0, DIR_VALUE_FLAG, 50, 1 << LIGHTS_BIT});
+        if (error.empty())
+            error = expectFrame(command(0, 50, false, true), {SPEED_VALUE_FLAG, 0, 0, DIR_VALUE_FLAG, 50, 1 << STOP_BIT});
+        if (error.empty())
+            error = expectFrame(command(0, 50, true, true), {SPEED_VALUE_FLAG, 0, 0, DIR_VALUE_FLAG, 50,
+                                                            (1 << LIGHTS_BIT) | (1 << STOP_BIT)});
+        return error;
+    }},
+    {"round_trip", [] {
+        for (const VehicleCommand& sent : commands)
+        {
+            uint8_t frame[VehicleProtocol::frameSize];
+            VehicleProtocol::encode(sent, frame);
+            VehicleCommand received = command(7, 7, false, false);
+            if (!VehicleProtocol::decode(frame, sizeof(frame), received))
+                return describe(sent) + " rejected";
+            if (!(received == sent))
+                return describe(sent) + " decoded as " + describe(received);
+        }
+        return std::string();
+    }},
+    {"unknown_flag_bits", [] {
+        // Bits the slave does not define do not turn anything on
+        const uint8_t frame[] = {SPEED_VALUE_FLAG, 0, 10, DIR_VALUE_FLAG, 50, 0xFC};
+        VehicleCommand received;
+        if (!VehicleProtocol::decode(frame, sizeof(frame), received))
+            return std::string("frame rejected");
+        return received.lightsOn || received.stopOn ? "flags " + bytes(frame + 5, 1) + " decoded as " + describe(received) : "";
+    }},
+    {"truncated", [] {
+        uint8_t frame[VehicleProtocol::frameSize];
+        VehicleProtocol::encode(command(100, 60, true, true), frame);
+        for (size_t size = 0; size < sizeof(frame); ++size)
+        {
+            VehicleCommand received = command(7, 7, false, false);
+            if (VehicleProtocol::decode(frame, size, received))
+                return std::to_string(size) + " byte frame accepted";
+            if (!(received == command(7, 7, false, false)))
+                return std::to_string(size) + " byte frame changed the command to " + describe(received);
+        }
+        return std::string();
+    }},
+    {"bad_marker", [] {
+        for (size_t marker : {0, 3})
+            for (int value : {0x00, 0xFF, (int)SPEED_VALUE_FLAG, (int)DIR_VALUE_FLAG})
+            {
+                uint8_t frame[VehicleProtocol::frameSize];
+                VehicleProtocol::encode(command(100, 60, true, true), frame);
+                if (frame[marker] == value)
+                    continue;
+                frame[marker] = value;
+                VehicleCommand received = command(7, 7, false, false);
+                if (VehicleProtocol::decode(frame, sizeof(frame), received))
+                    return bytes(frame, sizeof(frame)) + " accepted";
+                if (!(received == command(7, 7, false, false)))
+                    return bytes(frame, sizeof(frame)) + " changed the command to " + describe(received);
+            }
+        return std::string();
+    }},
+    {"shifted_frame", [] {
+        // Read one to five bytes late the markers do not line up, unless the payload holds them
+        uint8_t stream[2 * VehicleProtocol::frameSize];
+        VehicleProtocol::encode(command(0x0A1B, 50, false, true), stream);
+        VehicleProtocol::encode(command(0x0A1B, 50, false, true), stream + VehicleProtocol::frameSize);
+        for (size_t offset = 1; offset < VehicleProtocol::frameSize; ++offset)
+        {
+            VehicleCommand received;
+            if (VehicleProtocol::decode(stream + offset, VehicleProtocol::frameSize, received))
+                return "frame at offset " + std::to_string(offset) + " accepted: " +
+                       bytes(stream + offset, VehicleProtocol::frameSize);
+        }
+        return std::string();
+    }},
+    {"simulated_link", [] {
+        SimulatedLink link(0);
+        if (!link.open())
+            return std::string("cannot open");
+        for (const VehicleCommand& sent : commands)
+            if (!link.send(sent))
+                return describe(sent) + " not sent";
+        for (int i = 0; i < 1000 && link.getReceived() < commands.size(); ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (link.getReceived() != commands.size() || link.getDecodeErrors() != 0)
+            return std::to_string(link.getReceived()) + " of " + std::to_string(commands.size()) + " received, " +
+                   std::to_string(link.getDecodeErrors()) + " decode errors";
+        if (!(link.getLastCommand() == commands.back()))
+            return "last command " + describe(link.getLastCommand());
+        return std::string();
+    }},
+    {"record_link", [] {
+        std::remove(FLAGS_record.c_str());
+        {
+            RecordLink link(FLAGS_record);
+            if (!link.open())
+                return "cannot open " + FLAGS_record;
+            for (const VehicleCommand& sent : commands)
+                if (!link.send(sent))
+                    return describe(sent) + " not written";
+        }
+        std::vector<RecordLink::Record> records = RecordLink::readAll(FLAGS_record);
+        std::remove(FLAGS_record.c_str());
+        if (records.size() != commands.size())
+            return std::to_string(records.size()) + " of " + std::to_string(commands.size()) + " records read";
+        for (size_t i = 0; i < records.size(); ++i)
+            if (!(records[i].command == commands[i]) || (i > 0 && records[i].timestampNs < records[i - 1].timestampNs))
+                return "record " + std::to_string(i) + " is " + describe(records[i].command);
+        return std::string();
+    }},
+};
+
+int main(int argc, char *argv[])
+{
+    return runChecks(argc, argv, "protocol_check", cases, showOptions);
+}
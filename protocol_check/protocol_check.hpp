@@ -0,0 +1,23 @@
+/*
+ * protocol_check.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <iostream>
+#include <samples/check_runner.hpp>
+
+/// @brief message for the record file
+static const char record_message[] = "Optional. File the record link case writes, removed afterwards.";
+
+DEFINE_string(record, "/tmp/protocol_check.bin", record_message);
+
+/**
+* @brief Usage lines of the options next to -h and -filter
+*/
+static void showOptions() {
+    std::cout << "    -record \"<path>\"          " << record_message << std::endl;
+}
@@ -0,0 +1,155 @@
+/*
+ * main.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ *
+ * Output check of the asynchronous slog: every case logs through slog with std::cout
+ * redirected into a buffer and compares the formatted lines with what std::ostream prints
+ * for the same arguments, manipulators included. The last case shuts the logger down while
+ * threads keep logging and counts that no committed line is lost. Exits with 1 on any mismatch.
+ */
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <samples/slog.hpp>
+#include "slog_check.hpp"
+
+struct Point
+{
+    int x, y;
+};
+
+static std::ostream& operator<<(std::ostream& out, const Point& point)
+{
+    return out << "(" << point.x << ", " << point.y << ")";
+}
+
+struct Case
+{
+    std::string name;
+    std::function<void()> log;
+    std::string expected;    // the lines written, prefixes included
+};
+
+static std::stringbuf captured;
+
+static std::vector<Case> cases = {
+    {"plain", [] { slog::info << "frame " << 42 << " of " << 100u << ", " << 1.5 << " ms " << true << 'x' << slog::endl; },
+     "[ INFO ] frame 42 of 100, 1.5 ms 1x\n"},
+    {"fixed", [] { slog::info << std::fixed << std::setprecision(1) << 2.345 << " ms" << slog::endl; },
+     "[ INFO ] 2.3 ms\n"},
+    {"hex", [] { slog::info << "address " << std::hex << 255 << std::dec << " bus " << 10 << slog::endl; },
+     "[ INFO ] address ff bus 10\n"},
+    {"showbase", [] { slog::info << std::showbase << std::hex << (uint8_t)0x12 << ' ' << 0x12u << slog::endl; },
+     "[ INFO ] \x12 0x12\n"},
+    {"width", [] { slog::info << std::setw(5) << std::setfill('0') << 42 << '|' << std::setw(4) << 1 << 2 << slog::endl; },
+     "[ INFO ] 00042|00012\n"},
+    {"left", [] { slog::info << std::left << std::setw(6) << "ab" << "|" << std::setw(3) << std::string("c") << "|" << slog::endl; },
+     "[ INFO ] ab    |c  |\n"},
+    {"boolalpha", [] { slog::info << std::boolalpha << true << ' ' << false << slog::endl; },
+     "[ INFO ] true false\n"},
+    {"per_line", [] {
+        slog::info << std::hex << std::setprecision(2) << 255 << ' ' << 3.14159 << slog::endl;
+        slog::info << 255 << ' ' << 3.14159 << slog::endl;
+     },
+     "[ INFO ] ff 3.1\n[ INFO ] 255 3.14159\n"},
+    {"generic", [] { slog::info << "at " << Point{1, 2} << std::setw(8) << Point{3, 4} << slog::endl; },
+     "[ INFO ] at (1, 2)       (3, 4)\n"},
+    {"level", [] {
+        slog::setLevel(slog::Level::Warning);
+        slog::info << "hidden" << slog::endl;
+        slog::warn << std::hex << 16 << slog::endl;
+        slog::setLevel(slog::Level::Info);
+     },
+     "[ WARNING ] 10\n"},
+};
+
+static std::string take()
+{
+    slog::flush();
+    std::string text = captured.str();
+    captured.str("");
+    return text;
+}
+
+/*
+ * Threads keep committing lines while the logger stops, none of them may be lost
+ */
+static bool checkShutdown(std::ostream& results)
+{
+    const int linesPerThread = 200;
+    std::atomic<int> committed(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < FLAGS_threads; ++t)
+        threads.emplace_back([&, t] {
+            while (!go)
+                std::this_thread::yield();
+            for (int i = 0; i < linesPerThread; ++i)
+            {
+                slog::info << "shutdown " << t << " " << i << slog::endl;
+                committed++;
+            }
+        });
+    go = true;
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+    slog::detail::AsyncLogger::instance().shutdown();
+    for (auto& thread : threads)
+        thread.join();
+
+    const std::string text = captured.str();
+    int written = 0;
+    for (size_t at = text.find("shutdown "); at != std::string::npos; at = text.find("shutdown ", at + 1))
+        ++written;
+    const bool passed = written == committed && text.find("dropped") == std::string::npos;
+    results << std::left << std::setw(24) << "shutdown" << written << " of " << committed << " lines"
+            << (passed ? "  PASS" : "  FAIL") << std::endl;
+    return passed;
+}
+
+int main(int argc, char *argv[])
+{
+    gflags::ParseCommandLineNonHelpFlags(&argc, &argv, true);
+    if (FLAGS_h) {
+        showUsage();
+        return 0;
+    }
+
+    // Results own stdout, the logger writes into the buffer
+    std::ostream results(std::cout.rdbuf());
+    std::cout.rdbuf(&captured);
+
+    int ran = 0, failed = 0;
+    for (const Case& testCase : cases)
+    {
+        if (testCase.name.find(FLAGS_filter) == std::string::npos)
+            continue;
+        ++ran;
+        take();
+        testCase.log();
+        const std::string text = take();
+        const bool passed = text == testCase.expected;
+        if (!passed)
+        {
+            ++failed;
+            results << testCase.name << ": expected \"" << testCase.expected << "\", got \"" << text << "\"" << std::endl;
+        }
+        results << std::left << std::setw(24) << testCase.name << (passed ? "PASS" : "FAIL") << std::endl;
+    }
+
+    // Stops the logger, the last case
+    if (std::string("shutdown").find(FLAGS_filter) != std::string::npos)
+    {
+        ++ran;
+        take();
+        if (!checkShutdown(results))
+            ++failed;
+    }
+
+    results << ran - failed << " of " << ran << " cases passed" << std::endl;
+    return ran != 0 && failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,37 @@
+/*
+ * slog_check.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ */
+
+#pragma once
+
+#include <gflags/gflags.h>
+#include <iostream>
+
+/// @brief message for help argument
+static const char help_message[] = "Print a usage message.";
+
+/// @brief message for the case filter
+static const char filter_message[] = "Optional. Run only cases whose name contains this text.";
+
+/// @brief message for the shutdown threads
+static const char threads_message[] = "Optional. Threads logging while the logger shuts down.";
+
+DEFINE_bool(h, false, help_message);
+DEFINE_string(filter, "", filter_message);
+DEFINE_uint32(threads, 4, threads_message);
+
+/**
+* @brief This function show a help message
+*/
+static void showUsage() {
+    std::cout << std::endl;
+    std::cout << "slog_check [OPTION]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << std::endl;
+    std::cout << "    -h                        " << help_message << std::endl;
+    std::cout << "    -filter \"<text>\"          " << filter_message << std::endl;
+    std::cout << "    -threads                  " << threads_message << std::endl;
+}
@@ -0,0 +1,162 @@
+/*
+ * main.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: andrei
+ *
+ * Check of the object tracker on scripted detector output at 30 fps: track ids across
+ * frames, confirmation after minHits, tracks coasting on their prediction through missed
+ * detections until maxMissed, class separation and the detector interval. Exits with 1 if
+ * any case fails.
+ */
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <samples/check_runner.hpp>
+#include <samples/slog.hpp>
+#include "../autopilot/include/Detection.h"
+#include "../autopilot/include/Detection.cpp"
+#include "../autopilot/include/ObjectTracker.h"
+#include "../autopilot/include/ObjectTracker.cpp"
+
+static const uint64_t frameNs = 33333333;
+
+static Detection box(float x, float y, ObjectClass objectClass = ObjectClass::Vehicle, int label = 7)
+{
+    return Detection{label, objectClass, 0.9f, x, y, x + 40, y + 40, 0};
+}
+
+static std::vector<Detection> objectsOf(const ObjectTracker& tracker)
+{
+    std::vector<Detection> objects;
+    tracker.getObjects(objects);
+    return objects;
+}
+
+static std::string describe(const std::vector<Detection>& objects)
+{
+    std::ostringstream text;
+    text << objects.size() << " objects";
+    for (const Detection& object : objects)
+        text << " {track " << object.trackId << " at " << object.xmin << "," << object.ymin << "}";
+    return text.str();
+}
+
+static std::vector<CheckCase> cases = {
+    {"stable_id", [] {
+        ObjectTracker tracker{TrackerParams()};
+        uint32_t id = 0;
+        for (int frame = 0; frame < 20; ++frame)
+        {
+            tracker.update({box(100 + 2.0f * frame, 50)}, (frame + 1) * frameNs);
+            const std::vector<Detection> objects = objectsOf(tracker);
+            if (objects.size() != 1 || objects[0].trackId == 0 || (id != 0 && objects[0].trackId != id))
+                return "frame " + std::to_string(frame) + ": " + describe(objects);
+            id = objects[0].trackId;
+        }
+        return std::string();
+    }},
+    {"min_hits", [] {
+        TrackerParams params;
+        params.minHits = 3;
+        ObjectTracker tracker(params);
+        for (int frame = 0; frame < 3; ++frame)
+        {
+            tracker.update({box(100, 50)}, (frame + 1) * frameNs);
+            const size_t expected = frame < 2 ? 0 : 1;
+            if (objectsOf(tracker).size() != expected)
+                return "after " + std::to_string(frame + 1) + " hits: " + describe(objectsOf(tracker));
+        }
+        return std::string();
+    }},
+    {"coasting", [] {
+        // Moves 3 px a frame to the right, then the detector loses it
+        TrackerParams params;
+        params.maxMissed = 3;
+        ObjectTracker tracker(params);
+        int frame = 0;
+        for (; frame < 15; ++frame)
+            tracker.update({box(100 + 3.0f * frame, 50)}, (frame + 1) * frameNs);
+        const uint32_t id = objectsOf(tracker).at(0).trackId;
+
+        for (int missed = 1; missed <= params.maxMissed; ++missed, ++frame)
+        {
+            tracker.update({}, (frame + 1) * frameNs);
+            const std::vector<Detection> objects = objectsOf(tracker);
+            if (objects.size() != 1 || objects[0].trackId != id)
+                return "missed " + std::to_string(missed) + ": " + describe(objects);
+            // Keeps moving on its prediction
+            if (std::fabs(objects[0].xmin - (100 + 3.0f * frame)) > 2)
+                return "missed " + std::to_string(missed) + ": at " + std::to_string(objects[0].xmin) +
+                       ", expected " + std::to_string(100 + 3.0f * frame);
+        }
+
+        tracker.update({}, (frame + 1) * frameNs);
+        if (!objectsOf(tracker).empty() || tracker.trackCount() != 0)
+            return "still reported after " + std::to_string(params.maxMissed + 1) + " missed runs: " +
+                   describe(objectsOf(tracker));
+        return std::string();
+    }},
+    {"coasting_recovers", [] {
+        ObjectTracker tracker{TrackerParams()};
+        int frame = 0;
+        for (; frame < 10; ++frame)
+            tracker.update({box(100, 50)}, (frame + 1) * frameNs);
+        const uint32_t id = objectsOf(tracker).at(0).trackId;
+        tracker.update({}, (++frame) * frameNs);
+        tracker.update({}, (++frame) * frameNs);
+        tracker.update({box(101, 50)}, (++frame) * frameNs);
+        const std::vector<Detection> objects = objectsOf(tracker);
+        return objects.size() == 1 && objects[0].trackId == id ? "" : "after the detection came back: " + describe(objects);
+    }},
+    {"skipped_frames", [] {
+        // Between detector runs the track is predicted on every frame
+        ObjectTracker tracker{TrackerParams()};
+        int frame = 0;
+        for (; frame < 12; frame += 2)
+        {
+            tracker.update({box(100 + 4.0f * frame, 50)}, (frame + 1) * frameNs);
+            tracker.predict((frame + 2) * frameNs);
+        }
+        const std::vector<Detection> objects = objectsOf(tracker);
+        if (objects.size() != 1 || std::fabs(objects[0].xmin - (100 + 4.0f * (frame - 1))) > 2)
+            return "predicted " + describe(objects) + ", expected x " + std::to_string(100 + 4.0f * (frame - 1));
+        return std::string();
+    }},
+    {"classes", [] {
+        // The same box of another class or label starts its own track
+        ObjectTracker tracker{TrackerParams()};
+        tracker.update({box(100, 50), box(100, 50, ObjectClass::Pedestrian, 15), box(100, 50, ObjectClass::Vehicle, 6)},
+                       frameNs);
+        tracker.update({box(100, 50), box(100, 50, ObjectClass::Pedestrian, 15), box(100, 50, ObjectClass::Vehicle, 6)},
+                       2 * frameNs);
+        const std::vector<Detection> objects = objectsOf(tracker);
+        if (objects.size() != 3 || tracker.trackCount() != 3)
+            return describe(objects);
+        return objects[0].trackId != objects[1].trackId && objects[1].trackId != objects[2].trackId &&
+               objects[0].trackId != objects[2].trackId ? "" : "shared ids: " + describe(objects);
+    }},
+    {"interval", [] {
+        TrackerParams params;
+        params.maxInterval = 4;
+        ObjectTracker still(params), fast(params);
+        for (int frame = 0; frame < 10; ++frame)
+        {
+            still.update({box(100, 50)}, (frame + 1) * frameNs);
+            fast.update({box(100 + 8.0f * frame, 50)}, (frame + 1) * frameNs);
+        }
+        // 8 px a frame on a 40 px box is 0.2 of its size, above maxShift / 2
+        if (still.detectionInterval() != 4 || fast.detectionInterval() != 1)
+            return "intervals " + std::to_string(still.detectionInterval()) + " still, " +
+                   std::to_string(fast.detectionInterval()) + " fast";
+        return std::string();
+    }},
+};
+
+int main(int argc, char *argv[])
+{
+    return runChecks(argc, argv, "tracker_check", cases);
+}